@@ -0,0 +1,549 @@
+// =============================================================================
+//  lsm_bench.cpp  —  per-stage microbenchmarks for the LSM pricer
+//
+//  Google-Benchmark style harness (no external dependency): each case is
+//  re-run with a growing iteration count until it has run for --min-time
+//  seconds, and reports time per iteration plus throughput counters:
+//    paths/s          simulated (or swept) paths per second
+//    ns/path/date     wall time per path per exercise date
+//
+//  Stages: path generation (GBM, jump-diffusion), basis evaluation
+//  (per-term virtual vs. BasisFamily), OLS accumulate + solve, backward
+//  induction on a cached grid, end-to-end price(), a strike ladder
+//  priced through PortfolioPricer from one simulation, a 5-asset max-call
+//  on the correlated multi-asset engine, a batch of mixed-size pricings on
+//  the work-stealing PricingScheduler, the Richardson-extrapolated American
+//  price, the multilevel MLMCPricer, end-to-end price() through the compile-
+//  time specialised StaticLSMPricer, and DeviceLSMPricer end to end (its
+//  CUDA target when built with LSM_ENABLE_CUDA and a device is present).
+//
+//  Usage: lsm_bench [--filter=substr] [--min-time=sec] [--max-paths=N]
+//                   [--threads=T] [--simd=scalar|avx2|avx512] [--json=file]
+// =============================================================================
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "lsm_types.hpp"
+#include "basis_functions.hpp"
+#include "device_pricer.hpp"
+#include "exercise_policy.hpp"
+#include "lsm_pricer.hpp"
+#include "mlmc_pricer.hpp"
+#include "multi_asset_pricer.hpp"
+#include "ols_regressor.hpp"
+#include "path_cache.hpp"
+#include "payoffs.hpp"
+#include "portfolio_pricer.hpp"
+#include "pricing_scheduler.hpp"
+#include "simd_kernels.hpp"
+#include "static_pricer.hpp"
+#include "stochastic_processes.hpp"
+
+using namespace lsm;
+
+// ---------------------------------------------------------------------------
+//  Harness
+// ---------------------------------------------------------------------------
+template <class T>
+static void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+class State {
+public:
+    explicit State(long iterations) : iterations_(iterations) {}
+
+    // non-trivial so `for (auto _ : state)` does not trip -Wunused-variable
+    struct Tick {
+        ~Tick() {}
+    };
+    struct Iterator {
+        long left;
+        bool operator!=(const Iterator&) const { return left > 0; }
+        void operator++() { --left; }
+        Tick operator*() const { return {}; }
+    };
+    Iterator begin() { return {iterations_}; }
+    Iterator end() { return {0}; }
+
+    long iterations() const { return iterations_; }
+
+    // work done per iteration, used for the throughput counters
+    double pathsPerIteration = 0.0;
+    double datesPerPath = 0.0;
+
+private:
+    long iterations_;
+};
+
+struct Case {
+    std::string name;
+    std::function<void(State&)> body;
+};
+
+struct Measurement {
+    std::string name;
+    long iterations;
+    double nsPerIteration;
+    double pathsPerSecond;
+    double nsPerPathDate;
+};
+
+static Measurement run(const Case& c, double minTime) {
+    using clock = std::chrono::steady_clock;
+    {
+        State warm(1);
+        c.body(warm);
+    }
+    long iters = 1;
+    while (true) {
+        State st(iters);
+        const auto t0 = clock::now();
+        c.body(st);
+        const double secs = std::chrono::duration<double>(clock::now() - t0).count();
+        if (secs >= minTime || iters >= (1L << 30)) {
+            Measurement m{c.name, iters, secs * 1e9 / iters, 0.0, 0.0};
+            if (st.pathsPerIteration > 0.0) {
+                m.pathsPerSecond = st.pathsPerIteration * iters / secs;
+                if (st.datesPerPath > 0.0)
+                    m.nsPerPathDate = m.nsPerIteration / (st.pathsPerIteration * st.datesPerPath);
+            }
+            return m;
+        }
+        // aim a little past the target, as Google Benchmark does
+        const double scale = secs > 0.0 ? 1.4 * minTime / secs : 10.0;
+        iters = std::max(iters + 1, static_cast<long>(iters * std::min(scale, 10.0)));
+    }
+}
+
+static std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char ch : s) {
+        if (ch == '"' || ch == '\\') out += '\\';
+        out += ch;
+    }
+    return out;
+}
+
+static void writeJson(std::ostream& os, const std::vector<Measurement>& results, int threads) {
+    os << "{\n  \"context\": {\"executable\": \"lsm_bench\", \"num_threads\": " << threads
+       << ", \"simd\": \"" << simd::simdLevelName(simd::activeSimdLevel())
+       << "\"},\n  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& m = results[i];
+        os << "    {\"name\": \"" << jsonEscape(m.name) << "\", \"iterations\": " << m.iterations
+           << ", \"real_time\": " << std::setprecision(10) << m.nsPerIteration
+           << ", \"time_unit\": \"ns\", \"paths_per_second\": " << m.pathsPerSecond
+           << ", \"ns_per_path_date\": " << m.nsPerPathDate << "}"
+           << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+// ---------------------------------------------------------------------------
+//  Benchmarks
+// ---------------------------------------------------------------------------
+static LSMConfig benchConfig(int N, int dates, int threads) {
+    LSMConfig cfg;
+    cfg.numPaths = N;
+    cfg.numExerciseDates = dates;
+    cfg.maturity = 1.0;
+    cfg.riskFreeRate = 0.06;
+    cfg.rngSeed = 42;
+    cfg.numThreads = threads;
+    return cfg;
+}
+
+static std::unique_ptr<StochasticProcess> makeProcess(bool jumps) {
+    if (jumps) return std::make_unique<JumpDiffusionProcess>(0.06, 0.20, 0.10);
+    return std::make_unique<GeometricBrownianMotion>(0.06, 0.20);
+}
+
+static LSMPricer makePricer(const LSMConfig& cfg, bool jumps, int M) {
+    return LSMPricer(cfg, makeProcess(jumps), std::make_unique<PutPayoff>(40.0),
+                     BasisFamily(BasisFamilyType::Laguerre, M));
+}
+
+static std::vector<Case> registerCases(long maxPaths, int threads) {
+    std::vector<Case> cases;
+    std::vector<int> pathCounts;
+    for (long N : {1000L, 10000L, 100000L, 1000000L})
+        if (N <= maxPaths) pathCounts.push_back(static_cast<int>(N));
+
+    // path generation
+    for (bool jumps : {false, true}) {
+        for (int N : pathCounts) {
+            for (int D : {25, 50, 100}) {
+                std::ostringstream name;
+                name << "PathGen/" << (jumps ? "JumpDiffusion" : "GBM") << "/N:" << N << "/D:" << D;
+                cases.push_back({name.str(), [=](State& st) {
+                    auto pricer = makePricer(benchConfig(N, D, threads), jumps, 3);
+                    for (auto _ : st) {
+                        auto paths = pricer.simulatePaths(40.0, 42);
+                        doNotOptimize(paths.doubleRow(D)[0]);
+                    }
+                    st.pathsPerIteration = N;
+                    st.datesPerPath = D;
+                }});
+            }
+        }
+    }
+    for (int N : pathCounts) {
+        const int D = 50;
+        cases.push_back({"PathGen/GBM-Sobol/N:" + std::to_string(N) + "/D:" + std::to_string(D),
+                         [=](State& st) {
+            LSMConfig cfg = benchConfig(N, D, threads);
+            cfg.samplingScheme = SamplingScheme::Sobol;
+            auto pricer = makePricer(cfg, false, 3);
+            for (auto _ : st) {
+                auto paths = pricer.simulatePaths(40.0, 42);
+                doNotOptimize(paths.doubleRow(D)[0]);
+            }
+            st.pathsPerIteration = N;
+            st.datesPerPath = D;
+        }});
+    }
+
+    // basis evaluation over one date's in-the-money spots
+    const int basisPoints = 10000;
+    for (int M = 1; M <= 8; ++M) {
+        std::vector<double> x(basisPoints);
+        for (int i = 0; i < basisPoints; ++i) x[i] = 0.5 + i * (0.5 / basisPoints);
+
+        cases.push_back({"Basis/LaguerreSet/M:" + std::to_string(M), [=](State& st) {
+            auto set = makeLaguerreSet(M);
+            std::vector<double> out(basisPoints * set.size());
+            for (auto _ : st) {
+                for (std::size_t j = 0; j < set.size(); ++j)
+                    set[j]->evaluateBatch(x, std::span<double>(out.data() + j * basisPoints, basisPoints));
+                doNotOptimize(out[0]);
+            }
+            st.pathsPerIteration = basisPoints;
+        }});
+        cases.push_back({"Basis/LaguerrePerPoint/M:" + std::to_string(M), [=](State& st) {
+            auto set = makeLaguerreSet(M);
+            std::vector<double> out(basisPoints * set.size());
+            for (auto _ : st) {
+                for (std::size_t j = 0; j < set.size(); ++j)
+                    for (int i = 0; i < basisPoints; ++i)
+                        out[j * basisPoints + i] = set[j]->evaluate(x[i]);
+                doNotOptimize(out[0]);
+            }
+            st.pathsPerIteration = basisPoints;
+        }});
+        for (auto type : {BasisFamilyType::Monomial, BasisFamilyType::Laguerre,
+                          BasisFamilyType::Hermite, BasisFamilyType::Chebyshev}) {
+            BasisFamily fam(type, M);
+            cases.push_back({"Basis/Family/" + fam.name(), [=](State& st) {
+                std::vector<double> out(basisPoints * fam.size());
+                for (auto _ : st) {
+                    fam.evaluateBatch(x, out);
+                    doNotOptimize(out[0]);
+                }
+                st.pathsPerIteration = basisPoints;
+            }});
+        }
+    }
+
+    // OLS: accumulate the normal equations and solve
+    for (int M = 1; M <= 8; ++M) {
+        cases.push_back({"OLS/AccumulateSolve/n:10000/M:" + std::to_string(M), [=](State& st) {
+            const int n = 10000;
+            BasisFamily fam(BasisFamilyType::Laguerre, M);
+            std::vector<double> x(n), y(n), X(n * fam.size());
+            for (int i = 0; i < n; ++i) {
+                x[i] = 0.5 + 0.5 * i / n;
+                y[i] = 1.0 - x[i] + 0.01 * (i % 7);
+            }
+            fam.evaluateBatch(x, X);
+            for (auto _ : st) {
+                auto beta = OLSRegressor::fit(X, y, fam.size());
+                doNotOptimize(beta[0]);
+            }
+            st.pathsPerIteration = n;
+        }});
+    }
+
+    // backward induction alone: the grid is simulated once into a cache
+    for (int N : pathCounts) {
+        for (int D : {25, 50, 100}) {
+            for (int M : {1, 3, 5, 8}) {
+                std::ostringstream name;
+                name << "Backward/GBM/N:" << N << "/D:" << D << "/M:" << M;
+                cases.push_back({name.str(), [=](State& st) {
+                    auto cache = std::make_shared<PathCache>(std::size_t(4) << 30);
+                    auto pricer = makePricer(benchConfig(N, D, threads), false, M);
+                    pricer.setPathCache(cache);
+                    doNotOptimize(pricer.price(40.0).optionValue);    // fills the cache
+                    for (auto _ : st) doNotOptimize(pricer.price(40.0).optionValue);
+                    st.pathsPerIteration = N;
+                    st.datesPerPath = D;
+                }});
+            }
+        }
+    }
+
+    // deep in / at / deep out of the money: the regression only sees the
+    // in-the-money share, so the sweep's cost should follow it
+    for (int N : pathCounts) {
+        for (double S0 : {30.0, 40.0, 52.0}) {
+            const int D = 50;
+            std::ostringstream name;
+            name << "Backward/GBM-Moneyness/N:" << N << "/D:" << D << "/S:" << S0;
+            cases.push_back({name.str(), [=](State& st) {
+                auto cache = std::make_shared<PathCache>(std::size_t(4) << 30);
+                auto pricer = makePricer(benchConfig(N, D, threads), false, 3);
+                pricer.setPathCache(cache);
+                doNotOptimize(pricer.price(S0).optionValue);
+                for (auto _ : st) doNotOptimize(pricer.price(S0).optionValue);
+                st.pathsPerIteration = N;
+                st.datesPerPath = D;
+            }});
+        }
+    }
+
+    // the block sweep on a cached grid, serial against every core, whatever
+    // --threads says: parallel loops reuse a persistent pool, so the threaded
+    // sweep should win even at 10k paths
+    for (int N : {10000, 100000}) {
+        if (N > maxPaths) continue;
+        for (int T : {1, 0}) {
+            const int D = 50;
+            std::ostringstream name;
+            name << "Backward/GBM-Threads:" << (T == 0 ? "all" : "1") << "/N:" << N << "/D:" << D << "/M:3";
+            cases.push_back({name.str(), [=](State& st) {
+                auto cache = std::make_shared<PathCache>(std::size_t(4) << 30);
+                auto pricer = makePricer(benchConfig(N, D, T), false, 3);
+                pricer.setPathCache(cache);
+                doNotOptimize(pricer.price(40.0).optionValue);
+                for (auto _ : st) doNotOptimize(pricer.price(40.0).optionValue);
+                st.pathsPerIteration = N;
+                st.datesPerPath = D;
+            }});
+        }
+    }
+
+    // the same in mixed precision: float paths and design, double sums
+    for (int N : pathCounts) {
+        for (int M : {3, 8}) {
+            const int D = 50;
+            std::ostringstream name;
+            name << "Backward/GBM-Mixed/N:" << N << "/D:" << D << "/M:" << M;
+            cases.push_back({name.str(), [=](State& st) {
+                LSMConfig cfg = benchConfig(N, D, threads);
+                cfg.pathPrecision = cfg.basisPrecision = PathPrecision::Float;
+                auto cache = std::make_shared<PathCache>(std::size_t(4) << 30);
+                auto pricer = makePricer(cfg, false, M);
+                pricer.setPathCache(cache);
+                doNotOptimize(pricer.price(40.0).optionValue);
+                for (auto _ : st) doNotOptimize(pricer.price(40.0).optionValue);
+                st.pathsPerIteration = N;
+                st.datesPerPath = D;
+            }});
+        }
+    }
+
+    // end to end
+    for (bool jumps : {false, true}) {
+        for (int N : pathCounts) {
+            for (int D : {25, 50, 100}) {
+                std::ostringstream name;
+                name << "Price/" << (jumps ? "JumpDiffusion" : "GBM") << "/N:" << N << "/D:" << D << "/M:3";
+                cases.push_back({name.str(), [=](State& st) {
+                    auto pricer = makePricer(benchConfig(N, D, threads), jumps, 3);
+                    for (auto _ : st) doNotOptimize(pricer.price(40.0).optionValue);
+                    st.pathsPerIteration = N;
+                    st.datesPerPath = D;
+                }});
+            }
+        }
+    }
+
+    // the same through the compile-time specialised pricer (GBM only)
+    for (int N : pathCounts) {
+        const int D = 50;
+        cases.push_back({"Price/GBM-Static/N:" + std::to_string(N) + "/D:50/M:3", [=](State& st) {
+            const auto price = makeSpecialisedPricer(benchConfig(N, D, threads), makeProcess(false),
+                                                     std::make_unique<PutPayoff>(40.0),
+                                                     BasisFamily(BasisFamilyType::Laguerre, 3));
+            for (auto _ : st) doNotOptimize(price(40.0).optionValue);
+            st.pathsPerIteration = N;
+            st.datesPerPath = D;
+        }});
+    }
+
+    // the device pricer end to end, on the CUDA target when there is one
+    for (int N : pathCounts) {
+        const int D = 50;
+        const std::string target = DeviceLSMPricer::cudaAvailable() ? "Cuda" : "Host";
+        cases.push_back({"Device/" + target + "/JumpDiffusion/N:" + std::to_string(N) + "/D:50/M:3",
+                         [=](State& st) {
+            const auto process = makeProcess(true);
+            const DeviceLSMPricer pricer(benchConfig(N, D, threads), *process, PutPayoff(40.0),
+                                         BasisFamily(BasisFamilyType::Laguerre, 3));
+            for (auto _ : st) doNotOptimize(pricer.price(40.0).optionValue);
+            st.pathsPerIteration = N;
+            st.datesPerPath = D;
+        }});
+    }
+
+    // the American limit from 25 / 50 / 100 dates on one 100-date path set
+    for (int N : pathCounts) {
+        cases.push_back({"Extrapolated/GBM/N:" + std::to_string(N) + "/D:25-100/M:3", [=](State& st) {
+            auto pricer = makePricer(benchConfig(N, 25, threads), false, 3);
+            for (auto _ : st) doNotOptimize(pricer.priceExtrapolated(40.0, 3).americanValue);
+            st.pathsPerIteration = N;
+            st.datesPerPath = 100;
+        }});
+    }
+
+    // multilevel estimate to an RMSE of 0.02 from 8-date grids upwards,
+    // each level's rule fitted on N paths
+    for (int N : pathCounts) {
+        cases.push_back({"MLMC/GBM/N:" + std::to_string(N) + "/D:8+/M:3", [=](State& st) {
+            MLMCConfig mlmc;
+            mlmc.targetRMSE = 0.02;
+            const MLMCPricer pricer(benchConfig(N, 8, threads), makeProcess(false), std::make_unique<PutPayoff>(40.0),
+                                    BasisFamily(BasisFamilyType::Laguerre, 3), mlmc);
+            for (auto _ : st) doNotOptimize(pricer.price(40.0).optionValue);
+            st.pathsPerIteration = N;
+            st.datesPerPath = 8;
+        }});
+    }
+
+    // a stored exercise rule valued on fresh paths: the forward pass alone
+    for (int N : pathCounts) {
+        const int D = 50;
+        cases.push_back({"PolicyApply/GBM/N:" + std::to_string(N) + "/D:50/M:3", [=](State& st) {
+            auto pricer = makePricer(benchConfig(N, D, threads), false, 3);
+            const ExercisePolicy policy = pricer.fit(40.0);
+            std::uint64_t seed = 1000;
+            for (auto _ : st) doNotOptimize(pricer.applyPolicy(policy, 40.0, seed++).optionValue);
+            st.pathsPerIteration = N;
+            st.datesPerPath = D;
+        }});
+    }
+
+    // Broadie-Glasserman max-call on five assets, total-degree Laguerre(2)
+    // products (21 regressors); simulation and sweep end to end
+    for (int N : pathCounts) {
+        const int D = 9, d = 5;
+        cases.push_back({"MaxCall/d:5/N:" + std::to_string(N) + "/D:9/M:2", [=](State& st) {
+            LSMConfig cfg = benchConfig(N, D, threads);
+            cfg.maturity = 3.0;
+            cfg.riskFreeRate = 0.05;
+            MultiAssetLSMPricer pricer(cfg,
+                                       std::make_unique<CorrelatedGBM>(0.05, std::vector<double>(d, 0.2),
+                                                                       CorrelatedGBM::uniformCorrelation(d, 0.0),
+                                                                       std::vector<double>(d, 0.1)),
+                                       std::make_unique<MaxCallPayoff>(d, 100.0),
+                                       MultivariateBasis(BasisFamily(BasisFamilyType::Laguerre, 2), d));
+            const std::vector<double> S0(d, 100.0);
+            for (auto _ : st) doNotOptimize(pricer.price(S0).optionValue);
+            st.pathsPerIteration = N;
+            st.datesPerPath = D;
+        }});
+    }
+
+    // one simulation shared by a book of strikes; paths/s counts each
+    // contract's paths
+    for (int N : pathCounts) {
+        if (N > 10000) continue;
+        const int D = 50, strikes = 100;
+        cases.push_back({"Portfolio/GBM/N:" + std::to_string(N) + "/D:50/K:" + std::to_string(strikes),
+                         [=](State& st) {
+            PortfolioPricer book(benchConfig(N, D, threads), makeProcess(false),
+                                 BasisFamily(BasisFamilyType::Laguerre, 3));
+            for (int i = 0; i < strikes; ++i) book.addContract(std::make_unique<PutPayoff>(30.0 + 0.2 * i), 1.0);
+            for (auto _ : st) doNotOptimize(book.price(40.0)[0].optionValue);
+            st.pathsPerIteration = static_cast<double>(N) * strikes;
+            st.datesPerPath = D;
+        }});
+    }
+
+    // a batch of 20 mixed-size pricings (10 small, 10 at N) on the work-
+    // stealing scheduler; paths/s counts every task's paths
+    for (int N : pathCounts) {
+        if (N > 100000) continue;
+        const int D = 50, tasks = 20;
+        cases.push_back({"Scheduler/GBM/N:" + std::to_string(N) + "/D:50/tasks:" + std::to_string(tasks),
+                         [=](State& st) {
+            PricingScheduler scheduler(threads);
+            const std::shared_ptr<const StochasticProcess> process = makeProcess(false);
+            for (auto _ : st) {
+                std::vector<PricingTask> batch;
+                for (int i = 0; i < tasks; ++i) {
+                    const int paths = i % 2 == 0 ? N : std::max(N / 10, 100);
+                    batch.push_back({benchConfig(paths, D, 1), process, std::make_unique<PutPayoff>(36.0 + 0.5 * i),
+                                     BasisFamily(BasisFamilyType::Laguerre, 3), 40.0});
+                }
+                doNotOptimize(scheduler.run(std::move(batch)).back().optionValue);
+            }
+            st.pathsPerIteration = (tasks / 2) * (N + std::max(N / 10, 100));
+            st.datesPerPath = D;
+        }});
+    }
+    return cases;
+}
+
+// =============================================================================
+int main(int argc, char** argv)
+{
+    std::map<std::string, std::string> opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            std::cerr << "usage: lsm_bench [--filter=substr] [--min-time=sec] "
+                         "[--max-paths=N] [--threads=T] [--simd=scalar|avx2|avx512] "
+                         "[--json=file]\n";
+            return 1;
+        }
+        opts[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+    }
+    const std::string filter = opts.count("filter") ? opts["filter"] : "";
+    const double minTime = opts.count("min-time") ? std::atof(opts["min-time"].c_str()) : 0.2;
+    const long maxPaths = opts.count("max-paths") ? std::atol(opts["max-paths"].c_str()) : 1000000;
+    const int threads = opts.count("threads") ? std::atoi(opts["threads"].c_str()) : 1;
+    if (opts.count("simd")) {
+        const std::string& level = opts["simd"];
+        simd::setSimdLevel(level == "avx512" ? simd::SimdLevel::AVX512
+                           : level == "avx2" ? simd::SimdLevel::AVX2
+                                             : simd::SimdLevel::Scalar);
+    }
+    std::cout << "SIMD path kernels: " << simd::simdLevelName(simd::activeSimdLevel()) << "\n";
+
+    std::vector<Measurement> results;
+    std::cout << std::left << std::setw(48) << "Benchmark"
+              << std::right << std::setw(14) << "Time(ns)"
+              << std::setw(12) << "Iters"
+              << std::setw(14) << "paths/s"
+              << std::setw(14) << "ns/path/date" << "\n"
+              << std::string(102, '-') << "\n";
+    for (const auto& c : registerCases(maxPaths, threads)) {
+        if (!filter.empty() && c.name.find(filter) == std::string::npos) continue;
+        const auto m = run(c, minTime);
+        results.push_back(m);
+        std::cout << std::left << std::setw(48) << m.name << std::right
+                  << std::fixed << std::setprecision(0) << std::setw(14) << m.nsPerIteration
+                  << std::setw(12) << m.iterations
+                  << std::setprecision(0) << std::setw(14) << m.pathsPerSecond
+                  << std::setprecision(3) << std::setw(14) << m.nsPerPathDate << "\n";
+    }
+
+    if (opts.count("json")) {
+        std::ofstream out(opts["json"]);
+        writeJson(out, results, threads);
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "analytic_prices.hpp"
+#include "payoffs.hpp"
+#include "stochastic_processes.hpp"
+#include <cmath>
+#include <stdexcept>
+
+namespace lsm {
+
+namespace {
+
+double normalCdf(double x) {
+    return 0.5 * std::erfc(-x / std::sqrt(2.0));
+}
+
+std::optional<OptionType> optionType(const Payoff& payoff) {
+    if (dynamic_cast<const PutPayoff*>(&payoff)) return OptionType::Put;
+    if (dynamic_cast<const CallPayoff*>(&payoff)) return OptionType::Call;
+    return std::nullopt;
+}
+
+}
+
+double blackScholesPrice(OptionType type, double S0, double K, double r, double sigma, double T) {
+    if (S0 <= 0.0 || K <= 0.0 || T <= 0.0 || sigma < 0.0) {
+        throw std::invalid_argument("blackScholesPrice: need S0, K, T > 0 and sigma >= 0");
+    }
+    const double discK = K * std::exp(-r * T);
+    if (sigma == 0.0) {
+        return type == OptionType::Call ? std::max(S0 - discK, 0.0) : std::max(discK - S0, 0.0);
+    }
+    const double v = sigma * std::sqrt(T);
+    const double d1 = (std::log(S0 / K) + r * T) / v + 0.5 * v;
+    const double d2 = d1 - v;
+    return type == OptionType::Call ? S0 * normalCdf(d1) - discK * normalCdf(d2)
+                                    : discK * normalCdf(-d2) - S0 * normalCdf(-d1);
+}
+
+double mertonJumpDiffusionPrice(OptionType type, double S0, double K, double r, double sigma,
+                                double lambda, double jumpMean, double jumpVol, double T) {
+    // conditional on n jumps S_T is log-normal with rate r - lambda kappa +
+    // n log(1 + kappa) / T and variance sigma^2 + n jumpVol^2 / T; folding
+    // the rate change into the weights makes them Poisson(lambda (1 + kappa) T)
+    const double kappa = std::exp(jumpMean + 0.5 * jumpVol * jumpVol) - 1.0;
+    const double mean = lambda * (1.0 + kappa) * T;
+    double weight = std::exp(-mean);
+    double price = 0.0;
+    for (int n = 0; n < 1000; ++n) {
+        const double rn = r - lambda * kappa + n * std::log1p(kappa) / T;
+        const double sn = std::sqrt(sigma * sigma + n * jumpVol * jumpVol / T);
+        price += weight * blackScholesPrice(type, S0, K, rn, sn, T);
+        if (n >= mean && weight < 1e-16) break;
+        weight *= mean / (n + 1);
+    }
+    return price;
+}
+
+std::optional<double> europeanClosedForm(const StochasticProcess& process, const Payoff& payoff,
+                                         double S0, double T, double discountRate) {
+    const auto type = optionType(payoff);
+    if (!type) return std::nullopt;
+    const double K = payoff.strike();
+    // the paths drift at the process rate; discounting is at discountRate
+    if (const auto* gbm = dynamic_cast<const GeometricBrownianMotion*>(&process)) {
+        const double r = gbm->rate();
+        return std::exp((r - discountRate) * T) * blackScholesPrice(*type, S0, K, r, gbm->volatility(), T);
+    }
+    if (const auto* jdp = dynamic_cast<const JumpDiffusionProcess*>(&process)) {
+        const double r = jdp->rate();
+        return std::exp((r - discountRate) * T)
+             * mertonJumpDiffusionPrice(*type, S0, K, r, jdp->volatility(), jdp->jumpIntensity(),
+                                        jdp->jumpMean(), jdp->jumpVol(), T);
+    }
+    return std::nullopt;
+}
+
+}
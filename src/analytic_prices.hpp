@@ -0,0 +1,28 @@
+#pragma once
+
+#include "lsm_types.hpp"
+#include <optional>
+
+namespace lsm {
+
+enum class OptionType { Put, Call };
+
+//  Closed-form European prices  
+// - reference values for the control-variate estimator in LSMPricer: the
+//   discounted European payoff on the simulated paths has these exact means.
+
+// Black-Scholes price under GBM with rate r and volatility sigma
+double blackScholesPrice(OptionType type, double S0, double K, double r, double sigma, double T);
+
+// Merton (1976) price under JumpDiffusionProcess dynamics: the Poisson-
+// weighted series of Black-Scholes prices, summed past the Poisson mean
+// until a weight drops below 1e-16
+double mertonJumpDiffusionPrice(OptionType type, double S0, double K, double r, double sigma,
+                                double lambda, double jumpMean, double jumpVol, double T);
+
+// E[exp(-discountRate T) h(S_T)] for a put or call on GBM or
+// JumpDiffusionProcess; empty for any other process / payoff pair
+std::optional<double> europeanClosedForm(const StochasticProcess& process, const Payoff& payoff,
+                                         double S0, double T, double discountRate);
+
+}
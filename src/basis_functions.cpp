@@ -1,40 +1,241 @@
 #include "basis_functions.hpp"
+#include <algorithm>
 #include <cmath>
 
-namespace lms {
+namespace lsm {
+
+namespace {
+
+void checkSpans(std::span<const double> x, std::span<double> out) {
+    if (out.size() < x.size()) {
+        throw std::invalid_argument("evaluateBatch: output span too small");
+    }
+}
+
+}
 
 // ConstantBasis
-class ConstantBasis : public BasisFunction {
-public:
-    double evaluate(double x) const {
-        return 1.0;
+double ConstantBasis::evaluate(double) const {
+    return 1.0;
+}
+
+void ConstantBasis::evaluateBatch(std::span<const double> x, std::span<double> out) const {
+    checkSpans(x, out);
+    std::fill(out.begin(), out.begin() + x.size(), 1.0);
+}
+
+std::string ConstantBasis::name() const {
+    return "Const";
+}
+
+// MonomialBasis
+MonomialBasis::MonomialBasis(int power) {
+    if (power < 0) {
+        throw std::invalid_argument("power must be >= 0");
     }
+    power_ = power;
+}
+
+double MonomialBasis::evaluate(double x) const {
+    return std::pow(x, power_);
+}
 
-    std::string name() const {
-        return "Const";
+void MonomialBasis::evaluateBatch(std::span<const double> x, std::span<double> out) const {
+    checkSpans(x, out);
+    const std::size_t n = x.size();
+    const double* xs = x.data();
+    double* o = out.data();
+
+    // integer power by repeated multiplication; the inner loop runs over
+    // paths so it vectorises
+    for (std::size_t i = 0; i < n; ++i) o[i] = 1.0;
+    for (int p = 0; p < power_; ++p) {
+        for (std::size_t i = 0; i < n; ++i) o[i] *= xs[i];
     }
-};
+}
 
-// MonomialBasis
-class MonomialBasis : public BasisFunction {
-public:
-    MonomialBasis(int power) {
-        if (power < 0) {
-            throw std::invalid_argument("power must be >= 0");
+std::string MonomialBasis::name() const {
+    return "x^" + std::to_string(power_);
+}
+
+// LaguerreBasis
+LaguerreBasis::LaguerreBasis(int order) {
+    if (order < 0) {
+        throw std::invalid_argument("order must be >= 0");
+    }
+    order_ = order;
+
+    // L_n(x) = sum_k (-1)^k C(n,k) x^k / k!
+    coeffs_.resize(order + 1);
+    double binom = 1.0;
+    double fact  = 1.0;
+    for (int k = 0; k <= order; ++k) {
+        if (k > 0) {
+            binom *= static_cast<double>(order - k + 1) / k;
+            fact  *= k;
         }
-        power_ = power;
+        coeffs_[k] = ((k % 2 == 0) ? 1.0 : -1.0) * binom / fact;
+    }
+}
+
+double LaguerreBasis::evaluate(double x) const {
+    double poly = coeffs_[order_];
+    for (int k = order_ - 1; k >= 0; --k) {
+        poly = poly * x + coeffs_[k];
     }
+    return std::exp(-0.5 * x) * poly;
+}
 
-    double evaluate(double x) const {
-        return std::pow(x, power_);
+void LaguerreBasis::evaluateBatch(std::span<const double> x, std::span<double> out) const {
+    checkSpans(x, out);
+    const std::size_t n = x.size();
+    const double* xs = x.data();
+    double* o = out.data();
+
+    // Horner with the coefficient loop outside, so each pass is a
+    // contiguous multiply-add over paths
+    const double top = coeffs_[order_];
+    for (std::size_t i = 0; i < n; ++i) o[i] = top;
+    for (int k = order_ - 1; k >= 0; --k) {
+        const double c = coeffs_[k];
+        for (std::size_t i = 0; i < n; ++i) o[i] = o[i] * xs[i] + c;
+    }
+    for (std::size_t i = 0; i < n; ++i) o[i] *= std::exp(-0.5 * xs[i]);
+}
+
+std::string LaguerreBasis::name() const {
+    return "Lag" + std::to_string(order_);
+}
+
+std::vector<std::unique_ptr<BasisFunction>> makeLaguerreSet(int M) {
+    if (M < 0) {
+        throw std::invalid_argument("M must be >= 0");
+    }
+    std::vector<std::unique_ptr<BasisFunction>> basis;
+    basis.push_back(std::make_unique<ConstantBasis>());
+    for (int n = 0; n < M; ++n) {
+        basis.push_back(std::make_unique<LaguerreBasis>(n));
+    }
+    return basis;
+}
+
+// BasisFamily
+BasisFamily::BasisFamily(BasisFamilyType type, int M) {
+    if (M < 0) {
+        throw std::invalid_argument("M must be >= 0");
+    }
+    type_ = type;
+    M_ = M;
+}
+
+void BasisFamily::evaluate(double x, std::span<double> out) const {
+    evaluateBatch(std::span<const double>(&x, 1), out);
+}
+
+void BasisFamily::evaluateBatch(std::span<const double> x, std::span<double> out) const {
+    const std::size_t n = x.size();
+    if (out.size() < n * static_cast<std::size_t>(size())) {
+        throw std::invalid_argument("evaluateBatch: output span too small");
+    }
+    const double* xs = x.data();
+    auto col = [&](int j) { return out.data() + static_cast<std::size_t>(j) * n; };
+
+    double* c0 = col(0);
+    for (std::size_t i = 0; i < n; ++i) c0[i] = 1.0;
+    if (M_ == 0) return;
+
+    switch (type_) {
+    case BasisFamilyType::Monomial: {
+        // x^k = x * x^(k-1)
+        for (int k = 1; k <= M_; ++k) {
+            const double* prev = col(k - 1);
+            double* cur = col(k);
+            for (std::size_t i = 0; i < n; ++i) cur[i] = xs[i] * prev[i];
+        }
+        break;
+    }
+    case BasisFamilyType::Laguerre: {
+        // column k+1 holds exp(-x/2) L_k(x); the recurrence is linear so the
+        // weight is folded into the two seeds
+        double* l0 = col(1);
+        for (std::size_t i = 0; i < n; ++i) l0[i] = std::exp(-0.5 * xs[i]);
+        if (M_ == 1) break;
+        double* l1 = col(2);
+        for (std::size_t i = 0; i < n; ++i) l1[i] = l0[i] * (1.0 - xs[i]);
+        // (k+1) L_{k+1} = (2k+1-x) L_k - k L_{k-1}
+        for (int k = 1; k + 2 <= M_; ++k) {
+            const double* lm = col(k);
+            const double* lk = col(k + 1);
+            double* lp = col(k + 2);
+            const double a = 2.0 * k + 1.0;
+            const double b = static_cast<double>(k);
+            const double d = static_cast<double>(k + 1);
+            for (std::size_t i = 0; i < n; ++i) lp[i] = ((a - xs[i]) * lk[i] - b * lm[i]) / d;
+        }
+        break;
+    }
+    case BasisFamilyType::Hermite: {
+        // He_{k+1} = x He_k - k He_{k-1},  He_0 = 1 is the constant column
+        double* h1 = col(1);
+        for (std::size_t i = 0; i < n; ++i) h1[i] = xs[i];
+        for (int k = 1; k + 1 <= M_; ++k) {
+            const double* hm = col(k - 1);
+            const double* hk = col(k);
+            double* hp = col(k + 1);
+            const double b = static_cast<double>(k);
+            for (std::size_t i = 0; i < n; ++i) hp[i] = xs[i] * hk[i] - b * hm[i];
+        }
+        break;
+    }
+    case BasisFamilyType::Chebyshev: {
+        // T_{k+1} = 2x T_k - T_{k-1},  T_0 = 1 is the constant column
+        double* t1 = col(1);
+        for (std::size_t i = 0; i < n; ++i) t1[i] = xs[i];
+        for (int k = 1; k + 1 <= M_; ++k) {
+            const double* tm = col(k - 1);
+            const double* tk = col(k);
+            double* tp = col(k + 1);
+            for (std::size_t i = 0; i < n; ++i) tp[i] = 2.0 * xs[i] * tk[i] - tm[i];
+        }
+        break;
+    }
+    }
+}
+
+void BasisFamily::evaluateBatch(std::span<const double> x, std::span<float> out) const {
+    const std::size_t n = x.size();
+    const std::size_t F = size();
+    if (out.size() < n * F) {
+        throw std::invalid_argument("evaluateBatch: output span too small");
+    }
+    // the double columns a chunk of points at a time, each value rounded
+    // once on the way out; the recurrences never see a rounded term
+    constexpr std::size_t kScratch = 2048;
+    double stack[kScratch];
+    std::vector<double> heap(F > kScratch ? F : 0);
+    const std::span<double> scratch = heap.empty() ? std::span<double>(stack) : std::span<double>(heap);
+    const std::size_t chunk = scratch.size() / F;
+    for (std::size_t lo = 0; lo < n; lo += chunk) {
+        const std::size_t m = std::min(chunk, n - lo);
+        evaluateBatch(x.subspan(lo, m), scratch.first(m * F));
+        for (std::size_t j = 0; j < F; ++j) {
+            const double* src = scratch.data() + j * m;
+            float* dst = out.data() + j * n + lo;
+            for (std::size_t i = 0; i < m; ++i) dst[i] = static_cast<float>(src[i]);
+        }
     }
+}
 
-    std::string name() const {
-        return "x^" + std::to_string(power_);
+std::string BasisFamily::name() const {
+    std::string base;
+    switch (type_) {
+    case BasisFamilyType::Monomial:  base = "Monomial";  break;
+    case BasisFamilyType::Laguerre:  base = "Laguerre";  break;
+    case BasisFamilyType::Hermite:   base = "Hermite";   break;
+    case BasisFamilyType::Chebyshev: base = "Chebyshev"; break;
     }
+    return base + "(" + std::to_string(M_) + ")";
+}
 
-private:
-    int power_;
-};
+}
 
-}
\ No newline at end of file
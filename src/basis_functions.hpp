@@ -2,9 +2,12 @@
 
 #include "lsm_types.hpp"
 #include <cmath>
+#include <memory>
 #include <string>
 #include <stdexcept>
+#include <vector>
 
+namespace lsm {
 
 //  ConstantBasis  
 // - intercept term; evaluates to 1.0 for any given values
@@ -12,6 +15,7 @@
 class ConstantBasis : public BasisFunction {
 public:
     double evaluate(double x) const;
+    void evaluateBatch(std::span<const double> x, std::span<double> out) const;
     std::string name() const;
 };
 
@@ -22,8 +26,67 @@ public:
     MonomialBasis(int power);
 
     double evaluate(double x) const;
+    void evaluateBatch(std::span<const double> x, std::span<double> out) const;
     std::string name() const;
 
 private:
     int power_;
-};
\ No newline at end of file
+};
+
+//  LaguerreBasis  
+// - weighted Laguerre polynomial exp(-x/2) * L_n(x), as in L&S (2001);
+//   L_n is stored as its power-series coefficients and evaluated by Horner
+
+class LaguerreBasis : public BasisFunction {
+public:
+    LaguerreBasis(int order);
+
+    double evaluate(double x) const;
+    void evaluateBatch(std::span<const double> x, std::span<double> out) const;
+    std::string name() const;
+
+private:
+    int order_;
+    std::vector<double> coeffs_;   // coeffs_[k] multiplies x^k
+};
+
+// Constant term plus the first M weighted Laguerre polynomials L_0 .. L_{M-1}
+std::vector<std::unique_ptr<BasisFunction>> makeLaguerreSet(int M);
+
+//  BasisFamily  
+// - a whole polynomial family evaluated in one pass: the constant column
+//   followed by M terms built from the three-term recurrence, so each order
+//   reuses the two below it and the Laguerre weight exp(-x/2) is taken once
+//
+//   Monomial  : x, x^2, ..., x^M
+//   Laguerre  : exp(-x/2) L_n(x),  n = 0 .. M-1   (matches makeLaguerreSet)
+//   Hermite   : He_n(x) (probabilists'),  n = 1 .. M
+//   Chebyshev : T_n(x) (first kind),      n = 1 .. M
+
+enum class BasisFamilyType { Monomial, Laguerre, Hermite, Chebyshev };
+
+class BasisFamily {
+public:
+    BasisFamily(BasisFamilyType type, int M);
+
+    BasisFamilyType type() const { return type_; }
+    int numTerms() const { return M_; }
+    int size() const { return M_ + 1; }          // columns incl. constant
+
+    // all size() terms at one point: out[j] = term j at x
+    void evaluate(double x, std::span<double> out) const;
+
+    // column-major block: out[j * x.size() + i] = term j at x[i]
+    void evaluateBatch(std::span<const double> x, std::span<double> out) const;
+    // the same: every term is evaluated in double, as above, and only its
+    // stored value is rounded to float
+    void evaluateBatch(std::span<const double> x, std::span<float> out) const;
+
+    std::string name() const;
+
+private:
+    BasisFamilyType type_;
+    int M_;
+};
+
+}
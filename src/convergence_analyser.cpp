@@ -0,0 +1,168 @@
+#include "convergence_analyzer.hpp"
+#include "basis_functions.hpp"
+#include "lsm_pricer.hpp"
+#include "parallel.hpp"
+#include "path_cache.hpp"
+#include "payoffs.hpp"
+#include "stochastic_processes.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+
+namespace lsm {
+
+namespace {
+
+LSMPricer makePricer(const LSMConfig& cfg, double K, double sigma, int M) {
+    return LSMPricer(cfg,
+                     std::make_unique<GeometricBrownianMotion>(cfg.riskFreeRate, sigma),
+                     std::make_unique<PutPayoff>(K),
+                     BasisFamily(BasisFamilyType::Laguerre, M));
+}
+
+// offset separating out-of-sample seeds from the in-sample ones
+constexpr std::uint64_t kOutOfSampleSeedOffset = 0x9E3779B97F4A7C15ull;
+
+// job(i) for i in [0, n) on pool (or a local one of cfg.numThreads
+// workers), results in index order; the first failure is rethrown
+template <class Job>
+auto runConcurrently(const LSMConfig& cfg, ThreadPool* pool, std::size_t n, Job job) {
+    std::optional<ThreadPool> local;
+    if (!pool) pool = &local.emplace(std::min(resolveThreadCount(cfg.numThreads), static_cast<int>(n)));
+    return runTasks(*pool, n, job);
+}
+
+// the pricings themselves run on one thread each
+LSMConfig serial(const LSMConfig& cfg) {
+    LSMConfig c = cfg;
+    c.numThreads = 1;
+    return c;
+}
+
+}
+
+std::vector<std::tuple<int, double, double>>
+ConvergenceAnalyzer::analyzeByBasisFunctions(const LSMConfig& cfg, double S0, double K,
+                                             double sigma, int maxM, ThreadPool* pool) {
+    // every M regresses on the same paths; the first pricing simulates them
+    // into the cache, on every thread, before the rest share them
+    auto cache = std::make_shared<PathCache>();
+    auto row = [&](const LSMConfig& c, int M) {
+        auto pricer = makePricer(c, K, sigma, M);
+        pricer.setPathCache(cache);
+        const auto res = pricer.price(S0);
+        return std::tuple<int, double, double>(M, res.optionValue, res.standardError);
+    };
+    std::vector<std::tuple<int, double, double>> rows;
+    if (maxM < 1) return rows;
+    rows.push_back(row(cfg, 1));
+    const LSMConfig c = serial(cfg);
+    for (auto& r : runConcurrently(cfg, pool, maxM - 1, [&](std::size_t i) {
+             return row(c, static_cast<int>(i) + 2);
+         })) {
+        rows.push_back(r);
+    }
+    return rows;
+}
+
+std::vector<std::tuple<int, double, double>>
+ConvergenceAnalyzer::analyzeByPathCount(const LSMConfig& cfg, double S0, double K,
+                                        double sigma, const std::vector<int>& pathCounts,
+                                        ThreadPool* pool) {
+    return runConcurrently(cfg, pool, pathCounts.size(), [&](std::size_t i) {
+        LSMConfig c = serial(cfg);
+        c.numPaths = pathCounts[i];
+        const auto res = makePricer(c, K, sigma, 3).price(S0);
+        return std::tuple<int, double, double>(c.numPaths, res.optionValue, res.standardError);
+    });
+}
+
+std::vector<std::pair<SimulationResult, SimulationResult>>
+ConvergenceAnalyzer::outOfSampleTest(const LSMConfig& cfg, double S0, double K,
+                                     double sigma, int numTrials, ThreadPool* pool) {
+    return runConcurrently(cfg, pool, static_cast<std::size_t>(std::max(numTrials, 0)),
+                           [&](std::size_t t) {
+        LSMConfig c = serial(cfg);
+        c.rngSeed = cfg.rngSeed + t;
+        return makePricer(c, K, sigma, 3).priceInAndOutOfSample(S0, c.rngSeed + kOutOfSampleSeedOffset);
+    });
+}
+
+AdaptiveConvergence
+ConvergenceAnalyzer::analyzeAdaptive(const LSMConfig& cfg, double S0, double K, double sigma,
+                                     double targetStdError, double timeBudgetSeconds,
+                                     int maxBatches) {
+    if (maxBatches <= 0) {
+        throw std::invalid_argument("ConvergenceAnalyzer: maxBatches must be > 0");
+    }
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    AdaptiveConvergence run;
+
+    // the batches are independent and equally sized, so the pooled value
+    // is the mean of the batch means and its variance the mean of theirs
+    // over the batch count
+    double sumValue = 0.0, sumVariance = 0.0;
+    auto onBatch = [&](std::size_t b, const SimulationResult& res) {
+        const double n = static_cast<double>(b + 1);
+        sumValue += res.optionValue;
+        sumVariance += res.standardError * res.standardError;
+        ConvergenceCheckpoint cp;
+        cp.numPaths = static_cast<long long>(n) * cfg.numPaths;
+        cp.value = sumValue / n;
+        cp.standardError = std::sqrt(sumVariance) / n;
+        cp.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        run.checkpoints.push_back(cp);
+        run.converged = cp.standardError <= targetStdError;
+        return !run.converged && cp.seconds < timeBudgetSeconds && b + 1 < static_cast<std::size_t>(maxBatches);
+    };
+    run.inSample = makePricer(cfg, K, sigma, 3)
+                       .streamOutOfSample(S0, cfg.rngSeed + kOutOfSampleSeedOffset, std::ref(onBatch));
+    return run;
+}
+
+const std::vector<BenchmarkCase>& ConvergenceAnalyzer::longstaffSchwartzTable1() {
+    static const std::vector<BenchmarkCase> cases = {
+        {36, 0.20, 1.0, 4.478}, {36, 0.20, 2.0, 4.840}, {36, 0.40, 1.0, 7.101}, {36, 0.40, 2.0, 8.508},
+        {38, 0.20, 1.0, 3.250}, {38, 0.20, 2.0, 3.745}, {38, 0.40, 1.0, 6.148}, {38, 0.40, 2.0, 7.670},
+        {40, 0.20, 1.0, 2.314}, {40, 0.20, 2.0, 2.885}, {40, 0.40, 1.0, 5.312}, {40, 0.40, 2.0, 6.920},
+        {42, 0.20, 1.0, 1.617}, {42, 0.20, 2.0, 2.212}, {42, 0.40, 1.0, 4.582}, {42, 0.40, 2.0, 6.248},
+        {44, 0.20, 1.0, 1.110}, {44, 0.20, 2.0, 1.690}, {44, 0.40, 1.0, 3.948}, {44, 0.40, 2.0, 5.647},
+    };
+    return cases;
+}
+
+std::vector<PrecisionCheck>
+ConvergenceAnalyzer::validateMixedPrecision(const LSMConfig& cfg, const std::vector<BenchmarkCase>& cases,
+                                            double toleranceInStdErrors, ThreadPool* pool) {
+    constexpr double K = 40.0;
+    return runConcurrently(cfg, pool, cases.size(), [&](std::size_t i) {
+        const BenchmarkCase& bc = cases[i];
+        LSMConfig c = serial(cfg);
+        c.maturity = bc.maturity;
+        c.numExerciseDates = std::max(1, static_cast<int>(std::lround(50 * bc.maturity)));
+        c.pathPrecision = c.basisPrecision = PathPrecision::Double;
+        const auto full = makePricer(c, K, bc.sigma, 3).price(bc.S0);
+        c.pathPrecision = c.basisPrecision = PathPrecision::Float;
+        const auto mixed = makePricer(c, K, bc.sigma, 3).price(bc.S0);
+
+        PrecisionCheck check;
+        check.benchmark = bc;
+        check.doubleValue = full.optionValue;
+        check.mixedValue = mixed.optionValue;
+        check.standardError = full.standardError;
+        // an exercise-now value has no error, so only an exact match passes
+        const double diff = std::abs(mixed.optionValue - full.optionValue);
+        if (full.standardError > 0.0) check.deviation = diff / full.standardError;
+        else check.deviation = diff == 0.0 ? 0.0 : std::numeric_limits<double>::infinity();
+        check.passed = check.deviation <= toleranceInStdErrors;
+        return check;
+    });
+}
+
+}
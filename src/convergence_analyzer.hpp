@@ -0,0 +1,106 @@
+#pragma once
+
+#include "lsm_types.hpp"
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace lsm {
+
+class ThreadPool;
+
+//  ConvergenceCheckpoint  
+// - the running estimate of an adaptive run after one more batch
+
+struct ConvergenceCheckpoint {
+    long long numPaths = 0;             // out-of-sample paths valued so far
+    double value = 0.0;
+    double standardError = 0.0;
+    double seconds = 0.0;               // since the run started, fit included
+};
+
+struct AdaptiveConvergence {
+    SimulationResult inSample;          // the fit, on cfg.numPaths paths
+    std::vector<ConvergenceCheckpoint> checkpoints;    // one per batch
+    bool converged = false;             // reached the target within budget
+};
+
+//  BenchmarkCase  
+// - an American put from Longstaff & Schwartz (2001) Table 1: K = 40,
+//   r = 6% and 50 exercise dates per year, with the finite-difference value
+
+struct BenchmarkCase {
+    double S0 = 0.0;
+    double sigma = 0.0;
+    double maturity = 0.0;
+    double reference = 0.0;
+};
+
+//  PrecisionCheck  
+// - one case priced all in double and in mixed precision (float paths and
+//   design matrix, double normal equations) on the same paths
+
+struct PrecisionCheck {
+    BenchmarkCase benchmark;
+    double doubleValue = 0.0;
+    double mixedValue = 0.0;
+    double standardError = 0.0;         // of the all-double run
+    double deviation = 0.0;             // |mixed - double| in standard errors (0 or inf for SE 0)
+    bool passed = false;                // deviation within the tolerance
+};
+
+//  ConvergenceAnalyzer  
+// - diagnostics for an American put under GBM: sensitivity of the LSM value
+//   to the basis size and path count, and in- vs out-of-sample stability.
+//   Every run uses the rate, time grid and seed from cfg.
+//
+//   The sweeps are independent pricings and run concurrently on pool, or
+//   on a pool of cfg.numThreads workers when none is given; each pricing
+//   then runs single-threaded. Prices do not depend on thread counts, so
+//   the rows are the same either way.
+
+class ConvergenceAnalyzer {
+public:
+    // (M, value, standard error) for the constant plus M weighted Laguerre
+    // terms, M = 1 .. maxM
+    static std::vector<std::tuple<int, double, double>>
+    analyzeByBasisFunctions(const LSMConfig& cfg, double S0, double K,
+                            double sigma, int maxM, ThreadPool* pool = nullptr);
+
+    // (N, value, standard error) for each path count, Laguerre M = 3
+    static std::vector<std::tuple<int, double, double>>
+    analyzeByPathCount(const LSMConfig& cfg, double S0, double K,
+                       double sigma, const std::vector<int>& pathCounts,
+                       ThreadPool* pool = nullptr);
+
+    // (in-sample, out-of-sample) per trial. Trial t fits on seed
+    // cfg.rngSeed + t and values fresh paths from an unrelated seed.
+    static std::vector<std::pair<SimulationResult, SimulationResult>>
+    outOfSampleTest(const LSMConfig& cfg, double S0, double K,
+                    double sigma, int numTrials, ThreadPool* pool = nullptr);
+
+    // Streaming alternative to analyzeByPathCount: fit once on cfg.numPaths
+    // paths, then value batches of cfg.numPaths fresh paths under that rule
+    // (Laguerre M = 3, cfg.numThreads each), pooling the batch means into
+    // one running estimate. Stops once its standard error is at most
+    // targetStdError, the time budget is spent or maxBatches have run.
+    static AdaptiveConvergence
+    analyzeAdaptive(const LSMConfig& cfg, double S0, double K, double sigma,
+                    double targetStdError, double timeBudgetSeconds,
+                    int maxBatches = 1000);
+
+    // the twenty cases of L&S (2001) Table 1
+    static const std::vector<BenchmarkCase>& longstaffSchwartzTable1();
+
+    // Validation of the mixed-precision mode: each case (K = 40, 50 dates
+    // per year, Laguerre M = 3, path count, rate and seed from cfg) priced
+    // with cfg's precision settings forced to double and to float. A case
+    // passes when the two values differ by at most toleranceInStdErrors
+    // standard errors of the double run; when that run exercises at once
+    // (standard error 0), only an exact match passes.
+    static std::vector<PrecisionCheck>
+    validateMixedPrecision(const LSMConfig& cfg, const std::vector<BenchmarkCase>& cases,
+                           double toleranceInStdErrors = 0.25, ThreadPool* pool = nullptr);
+};
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "simd_math.hpp"
+#include <array>
+#include <cstdint>
+#include <utility>
+
+namespace lsm {
+
+//  Philox4x32  
+// - Philox4x32-10 block function (Salmon et al., "Parallel random numbers:
+//   as easy as 1, 2, 3", SC11). Output is a pure function of (counter, key),
+//   so any draw can be produced independently of every other one.
+
+struct Philox4x32 {
+    using Counter = std::array<std::uint32_t, 4>;
+    using Key     = std::array<std::uint32_t, 2>;
+
+    static Counter generate(Counter ctr, Key key) {
+        for (int round = 0; round < 10; ++round) {
+            if (round > 0) {
+                key[0] += 0x9E3779B9u;
+                key[1] += 0xBB67AE85u;
+            }
+            const std::uint64_t p0 = static_cast<std::uint64_t>(0xD2511F53u) * ctr[0];
+            const std::uint64_t p1 = static_cast<std::uint64_t>(0xCD9E8D57u) * ctr[2];
+            const std::uint32_t hi0 = static_cast<std::uint32_t>(p0 >> 32);
+            const std::uint32_t lo0 = static_cast<std::uint32_t>(p0);
+            const std::uint32_t hi1 = static_cast<std::uint32_t>(p1 >> 32);
+            const std::uint32_t lo1 = static_cast<std::uint32_t>(p1);
+            ctr = {hi1 ^ ctr[1] ^ key[0], lo1, hi0 ^ ctr[3] ^ key[1], lo0};
+        }
+        return ctr;
+    }
+};
+
+//  CounterRNG  
+// - seeded front end to Philox: draws are addressed by (path, step, lane)
+//   rather than pulled from a sequence, which makes simulation results
+//   independent of how paths are split across threads
+
+class CounterRNG {
+public:
+    explicit CounterRNG(std::uint64_t seed)
+        : key_{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)} {}
+
+    Philox4x32::Counter bits(std::uint64_t path, std::uint32_t step, std::uint32_t lane) const {
+        return Philox4x32::generate(
+            {step, lane, static_cast<std::uint32_t>(path), static_cast<std::uint32_t>(path >> 32)},
+            key_);
+    }
+
+    // two uniforms on (0, 1]
+    std::pair<double, double> uniformPair(std::uint64_t path, std::uint32_t step,
+                                          std::uint32_t lane) const {
+        const auto r = bits(path, step, lane);
+        return {toUniform(r[0], r[1]), toUniform(r[2], r[3])};
+    }
+
+    // two independent N(0,1) draws, by the normal quantile of two open
+    // uniforms; simd::normalBlock produces the same values for many paths
+    std::pair<double, double> normalPair(std::uint64_t path, std::uint32_t step,
+                                         std::uint32_t lane) const {
+        using P = simd::ScalarPack;
+        const auto r = bits(path, step, lane);
+        return {simd::normalQuantile(simd::openUniform<P>(r[0], r[1])),
+                simd::normalQuantile(simd::openUniform<P>(r[2], r[3]))};
+    }
+
+    const Philox4x32::Key& key() const { return key_; }
+
+private:
+    static double toUniform(std::uint32_t hi, std::uint32_t lo) {
+        const std::uint64_t m = (static_cast<std::uint64_t>(hi) << 21) | (lo >> 11);
+        return static_cast<double>(m + 1) * 0x1.0p-53;
+    }
+
+    Philox4x32::Key key_;
+};
+
+}
@@ -0,0 +1,197 @@
+#include "device_kernels.hpp"
+#include <cuda_runtime.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// The CUDA backend of DeviceLSMPricer, built with -DLSM_ENABLE_CUDA=ON.
+// One thread per path; each block of kDeviceBlock threads reduces its
+// paths' contributions in shared memory and writes one partial per entry,
+// and a single-block kernel adds the partials in block order, so a run is
+// reproducible on a given device.
+
+namespace lsm::device {
+
+namespace {
+
+void check(cudaError_t status, const char* what) {
+    if (status != cudaSuccess) {
+        throw std::runtime_error(std::string("DeviceLSMPricer: ") + what + ": " + cudaGetErrorString(status));
+    }
+}
+
+// CounterRNG's counters and words; the normal is the device's inverse CDF
+struct DeviceRng {
+    std::uint32_t key0, key1;
+
+    __device__ void normalPair(std::uint64_t path, std::uint32_t step, std::uint32_t lane,
+                               double& z0, double& z1) const {
+        std::uint32_t c[4] = {step, lane, static_cast<std::uint32_t>(path),
+                              static_cast<std::uint32_t>(path >> 32)};
+        philox(c, key0, key1);
+        z0 = normcdfinv(openUniform(c[0], c[1]));
+        z1 = normcdfinv(openUniform(c[2], c[3]));
+    }
+    __device__ double uniform(std::uint64_t path, std::uint32_t step, std::uint32_t lane) const {
+        std::uint32_t c[4] = {step, lane, static_cast<std::uint32_t>(path),
+                              static_cast<std::uint32_t>(path >> 32)};
+        philox(c, key0, key1);
+        return closedUniform(c[0], c[1]);
+    }
+    __device__ double exp(double x) const { return ::exp(x); }
+};
+
+// sum of v over the block, a fixed tree so the order is reproducible
+__device__ double blockSum(double* shared, double v) {
+    shared[threadIdx.x] = v;
+    __syncthreads();
+    for (unsigned w = blockDim.x / 2; w > 0; w /= 2) {
+        if (threadIdx.x < w) shared[threadIdx.x] += shared[threadIdx.x + w];
+        __syncthreads();
+    }
+    const double total = shared[0];
+    __syncthreads();
+    return total;
+}
+
+__device__ std::uint64_t pathIndex() {
+    return static_cast<std::uint64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+}
+
+__global__ void simulateKernel(DeviceModel m, DeviceRng rng, double* paths, double* cash, double* partial) {
+    __shared__ double shared[kDeviceBlock];
+    const std::uint64_t p = pathIndex();
+    double h = 0.0;
+    if (p < m.numPaths) {
+        simulatePath(m, rng, p, paths + p, m.numPaths);
+        h = payoff(m, paths[m.numDates * m.numPaths + p]);
+        cash[p] = h;
+    }
+    const double total = blockSum(shared, h);
+    if (threadIdx.x == 0) partial[blockIdx.x] = total;
+}
+
+__global__ void normalEquationsKernel(DeviceModel m, int k, double df, const double* paths,
+                                      double* cash, double* partial) {
+    __shared__ double shared[kDeviceBlock];
+    const std::uint64_t p = pathIndex();
+    const int E = numEntries(m.numTerms);
+    double v[numEntries(kMaxTerms)] = {};
+    if (p < m.numPaths) {
+        cash[p] *= df;
+        pathEntries(m, paths[k * m.numPaths + p], cash[p], [&](int e, double x) { v[e] += x; });
+    }
+    for (int e = 0; e < E; ++e) {
+        const double total = blockSum(shared, v[e]);
+        if (threadIdx.x == 0) partial[blockIdx.x * E + e] = total;
+    }
+}
+
+__global__ void exerciseKernel(DeviceModel m, int k, const double* beta, const double* paths, double* cash) {
+    const std::uint64_t p = pathIndex();
+    if (p < m.numPaths) cash[p] = exerciseValue(m, beta, paths[k * m.numPaths + p], cash[p]);
+}
+
+__global__ void sampleKernel(DeviceModel m, double scale, bool squares, double mean,
+                             const double* cash, double* partial) {
+    __shared__ double shared[kDeviceBlock];
+    const std::uint64_t i = pathIndex();
+    double v = 0.0;
+    if (i < m.half) {
+        v = m.half < m.numPaths ? 0.5 * (scale * cash[i] + scale * cash[i + m.half]) : scale * cash[i];
+        if (squares) v = (v - mean) * (v - mean);
+    }
+    const double total = blockSum(shared, v);
+    if (threadIdx.x == 0) partial[blockIdx.x] = total;
+}
+
+// out[e] = sum of partial[b * width + e] over b, one thread per entry
+__global__ void reduceKernel(const double* partial, unsigned numBlocks, int width, double* out) {
+    const int e = threadIdx.x;
+    if (e >= width) return;
+    double sum = 0.0;
+    for (unsigned b = 0; b < numBlocks; ++b) sum += partial[static_cast<std::size_t>(b) * width + e];
+    out[e] = sum;
+}
+
+template <class T>
+struct DeviceBuffer {
+    T* data = nullptr;
+
+    DeviceBuffer() = default;
+    DeviceBuffer(const DeviceBuffer&) = delete;
+    DeviceBuffer& operator=(const DeviceBuffer&) = delete;
+    ~DeviceBuffer() { if (data) cudaFree(data); }
+
+    void allocate(std::size_t n) {
+        if (data) cudaFree(data);
+        data = nullptr;
+        check(cudaMalloc(reinterpret_cast<void**>(&data), n * sizeof(T)), "cudaMalloc");
+    }
+};
+
+class CudaBackend : public Backend {
+public:
+    double simulate(const DeviceModel& model) {
+        m_ = model;
+        const std::size_t N = m_.numPaths;
+        numBlocks_ = static_cast<unsigned>((N + kDeviceBlock - 1) / kDeviceBlock);
+        paths_.allocate(N * (m_.numDates + 1));
+        cash_.allocate(N);
+        partial_.allocate(static_cast<std::size_t>(numBlocks_) * numEntries(m_.numTerms));
+        result_.allocate(numEntries(kMaxTerms));
+        beta_.allocate(kMaxTerms);
+
+        simulateKernel<<<numBlocks_, kDeviceBlock>>>(m_, DeviceRng{m_.key0, m_.key1},
+                                                     paths_.data, cash_.data, partial_.data);
+        return reduced(1, nullptr);
+    }
+
+    void normalEquations(int k, double df, double* entries) {
+        normalEquationsKernel<<<numBlocks_, kDeviceBlock>>>(m_, k, df, paths_.data, cash_.data, partial_.data);
+        reduced(numEntries(m_.numTerms), entries);
+    }
+
+    void exercise(int k, const double* beta) {
+        check(cudaMemcpy(beta_.data, beta, m_.numTerms * sizeof(double), cudaMemcpyHostToDevice), "cudaMemcpy");
+        exerciseKernel<<<numBlocks_, kDeviceBlock>>>(m_, k, beta_.data, paths_.data, cash_.data);
+        check(cudaGetLastError(), "exercise kernel");
+    }
+
+    double sampleSum(double scale, bool squares, double mean) {
+        sampleKernel<<<numBlocks_, kDeviceBlock>>>(m_, scale, squares, mean, cash_.data, partial_.data);
+        return reduced(1, nullptr);
+    }
+
+private:
+    // reduce the partials of the kernel just launched and copy the width
+    // sums back; returns the first
+    double reduced(int width, double* out) {
+        check(cudaGetLastError(), "kernel launch");
+        reduceKernel<<<1, numEntries(kMaxTerms)>>>(partial_.data, numBlocks_, width, result_.data);
+        std::vector<double> host(width);
+        check(cudaMemcpy(host.data(), result_.data, width * sizeof(double), cudaMemcpyDeviceToHost),
+              "cudaMemcpy");
+        if (out) std::copy(host.begin(), host.end(), out);
+        return host[0];
+    }
+
+    DeviceModel m_;
+    unsigned numBlocks_ = 0;
+    DeviceBuffer<double> paths_, cash_, partial_, result_, beta_;
+};
+
+}
+
+std::unique_ptr<Backend> makeCudaBackend() {
+    if (!cudaDeviceAvailable()) throw std::runtime_error("DeviceLSMPricer: no CUDA device");
+    return std::make_unique<CudaBackend>();
+}
+
+bool cudaDeviceAvailable() {
+    int count = 0;
+    return cudaGetDeviceCount(&count) == cudaSuccess && count > 0;
+}
+
+}
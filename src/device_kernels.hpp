@@ -0,0 +1,225 @@
+#pragma once
+
+#include "basis_functions.hpp"
+#include <cmath>
+#include <cstdint>
+#include <memory>
+
+// Per-path kernels shared by the host and CUDA backends of DeviceLSMPricer.
+// Everything here compiles both as host C++ and, under nvcc, as
+// __host__ __device__ code, so the two backends run the same arithmetic.
+
+#if defined(__CUDACC__)
+#define LSM_HD __host__ __device__
+#else
+#define LSM_HD
+#endif
+
+namespace lsm::device {
+
+// paths per CUDA block and per host chunk of a reduction
+constexpr unsigned kDeviceBlock = 256;
+
+// basis columns including the constant; kMaxFixedRegressors
+constexpr int kMaxTerms = 9;
+
+// Philox lanes, as JumpDiffusionProcess
+constexpr std::uint32_t kDiffusionLane = 0;
+constexpr std::uint32_t kJumpCountLane = 1;
+constexpr std::uint32_t kJumpSizeLane  = 2;
+
+//  DeviceModel  
+// - everything a kernel needs, passed by value: a Merton jump-diffusion in
+//   log space (GBM is jumpRate = 0), a put or call payoff and a basis
+
+struct DeviceModel {
+    double S0 = 0.0;
+    double drift = 0.0;          // (r - lambda kappa - sigma^2 / 2) dt
+    double diffusion = 0.0;      // sigma sqrt(dt)
+    double jumpRate = 0.0;       // lambda dt
+    double jumpMean = 0.0;
+    double jumpVol = 0.0;
+    double strike = 0.0;
+    double invK = 0.0;
+    int payoffSign = -1;         // +1 call, -1 put
+    int basisType = 0;           // BasisFamilyType
+    int numTerms = 0;            // basis size() incl. the constant
+    int numDates = 0;            // D; dates 0 .. D are stored
+    std::uint64_t numPaths = 0;
+    std::uint64_t half = 0;      // paths >= half mirror path - half; numPaths without antithetics
+    std::uint32_t key0 = 0, key1 = 0;
+};
+
+// normal-equation sums for m columns: the upper triangle of X'X row by row,
+// then X'y, then the number of in-the-money paths
+LSM_HD constexpr int numEntries(int m) {
+    return m * (m + 1) / 2 + m + 1;
+}
+
+// Philox4x32-10 in place, the same rounds as Philox4x32::generate
+LSM_HD inline void philox(std::uint32_t c[4], std::uint32_t k0, std::uint32_t k1) {
+    for (int round = 0; round < 10; ++round) {
+        if (round > 0) {
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        const std::uint64_t p0 = static_cast<std::uint64_t>(0xD2511F53u) * c[0];
+        const std::uint64_t p1 = static_cast<std::uint64_t>(0xCD9E8D57u) * c[2];
+        const std::uint32_t next[4] = {static_cast<std::uint32_t>(p1 >> 32) ^ c[1] ^ k0,
+                                       static_cast<std::uint32_t>(p1),
+                                       static_cast<std::uint32_t>(p0 >> 32) ^ c[3] ^ k1,
+                                       static_cast<std::uint32_t>(p0)};
+        for (int i = 0; i < 4; ++i) c[i] = next[i];
+    }
+}
+
+// (0, 1], as CounterRNG::uniformPair
+LSM_HD inline double closedUniform(std::uint32_t hi, std::uint32_t lo) {
+    const std::uint64_t m = (static_cast<std::uint64_t>(hi) << 21) | (lo >> 11);
+    return static_cast<double>(m + 1) * 0x1.0p-53;
+}
+
+// (0, 1), as simd::openUniform
+LSM_HD inline double openUniform(std::uint32_t hi, std::uint32_t lo) {
+    const double m = static_cast<double>(hi) * 0x1.0p20 + static_cast<double>(lo >> 12);
+    return (m + 0.5) * 0x1.0p-52;
+}
+
+// as poissonInverse()
+LSM_HD inline int poissonCount(double u, double mean) {
+    double p = std::exp(-mean);
+    double cdf = p;
+    int n = 0;
+    while (u > cdf && n < 64) {
+        ++n;
+        p *= mean / n;
+        cdf += p;
+    }
+    return n;
+}
+
+LSM_HD inline double payoff(const DeviceModel& m, double S) {
+    const double v = m.payoffSign * (S - m.strike);
+    return v > 0.0 ? v : 0.0;
+}
+
+// Path p, dates 0 .. D at out[k * stride]. Rng supplies
+// normalPair(path, step, lane, z0, z1), uniform(path, step, lane) (the first
+// of CounterRNG::uniformPair) and exp(x); the draws are JumpDiffusionProcess's
+// so the host backend reproduces its paths exactly.
+template <class Rng>
+LSM_HD void simulatePath(const DeviceModel& m, const Rng& rng, std::uint64_t p,
+                         double* out, std::uint64_t stride) {
+    const bool mirror = p >= m.half;
+    const std::uint64_t id = mirror ? p - m.half : p;
+    const double sign = mirror ? -1.0 : 1.0;
+    const double a = m.diffusion * sign;
+    double X = 0.0, zEven = 0.0, zOdd = 0.0;
+    out[0] = m.S0;
+    for (int j = 0; j < m.numDates; ++j) {
+        const auto step = static_cast<std::uint32_t>(j);
+        if (j % 2 == 0) rng.normalPair(id, step / 2, kDiffusionLane, zEven, zOdd);
+        double inc = m.drift + a * (j % 2 == 0 ? zEven : zOdd);
+        if (m.jumpRate > 0.0) {
+            const int n = poissonCount(rng.uniform(id, step, kJumpCountLane), m.jumpRate);
+            if (n > 0) {
+                double zJ = 0.0, unused = 0.0;
+                rng.normalPair(id, step, kJumpSizeLane, zJ, unused);
+                inc += n * m.jumpMean + std::sqrt(static_cast<double>(n)) * m.jumpVol * sign * zJ;
+            }
+        }
+        X += inc;
+        out[static_cast<std::uint64_t>(j + 1) * stride] = m.S0 * rng.exp(X);
+    }
+}
+
+// the m.numTerms basis columns at x, BasisFamily's recurrences
+LSM_HD inline void basisTerms(const DeviceModel& m, double x, double* out) {
+    const int M = m.numTerms - 1;
+    out[0] = 1.0;
+    if (M == 0) return;
+    switch (static_cast<BasisFamilyType>(m.basisType)) {
+    case BasisFamilyType::Monomial:
+        for (int k = 1; k <= M; ++k) out[k] = x * out[k - 1];
+        break;
+    case BasisFamilyType::Laguerre:
+        out[1] = std::exp(-0.5 * x);
+        if (M == 1) break;
+        out[2] = out[1] * (1.0 - x);
+        for (int k = 1; k + 2 <= M; ++k) {
+            out[k + 2] = ((2.0 * k + 1.0 - x) * out[k + 1] - static_cast<double>(k) * out[k]) /
+                         static_cast<double>(k + 1);
+        }
+        break;
+    case BasisFamilyType::Hermite:
+        out[1] = x;
+        for (int k = 1; k + 1 <= M; ++k) out[k + 1] = x * out[k] - static_cast<double>(k) * out[k - 1];
+        break;
+    case BasisFamilyType::Chebyshev:
+        out[1] = x;
+        for (int k = 1; k + 1 <= M; ++k) out[k + 1] = 2.0 * x * out[k] - out[k - 1];
+        break;
+    }
+}
+
+// path p's contribution to the date's normal equations, in numEntries()
+// order; zero when it is out of the money. entry(e, v) adds v to entry e.
+template <class Add>
+LSM_HD void pathEntries(const DeviceModel& m, double S, double y, Add&& entry) {
+    const int terms = m.numTerms;
+    double X[kMaxTerms] = {};
+    const bool itm = payoff(m, S) > 0.0;
+    if (itm) basisTerms(m, S * m.invK, X);
+    int e = 0;
+    for (int i = 0; i < terms; ++i) {
+        for (int j = i; j < terms; ++j) entry(e++, itm ? X[i] * X[j] : 0.0);
+    }
+    for (int i = 0; i < terms; ++i) entry(e++, itm ? X[i] * y : 0.0);
+    entry(e, itm ? 1.0 : 0.0);
+}
+
+// the exercise test at one path: cash becomes the payoff where it beats
+// the regression beta' X(S / K)
+LSM_HD inline double exerciseValue(const DeviceModel& m, const double* beta, double S, double cash) {
+    const double h = payoff(m, S);
+    if (!(h > 0.0)) return cash;
+    double X[kMaxTerms];
+    basisTerms(m, S * m.invK, X);
+    double fit = 0.0;
+    for (int i = 0; i < m.numTerms; ++i) fit += beta[i] * X[i];
+    return h > fit ? h : cash;
+}
+
+//  Backend  
+// - the device side of DeviceLSMPricer: it owns the N (D + 1) paths and the
+//   N cash flows, and every reduction comes back as a handful of doubles.
+//   Partial sums are taken per kDeviceBlock paths and added in block order,
+//   so a backend's results do not depend on its scheduling.
+
+class Backend {
+public:
+    virtual ~Backend() {}
+
+    // simulate every path; cash = the payoff at date D. Returns its sum.
+    virtual double simulate(const DeviceModel& model) = 0;
+
+    // cash *= df, then the normal-equation sums at date k, numEntries(m)
+    // doubles into entries
+    virtual void normalEquations(int k, double df, double* entries) = 0;
+
+    // replace cash by the payoff where it beats beta' X at date k
+    virtual void exercise(int k, const double* beta) = 0;
+
+    // sum over the samples of (scale * sample) or, when squares, of
+    // (scale * sample - mean)^2; a sample averages an antithetic pair
+    virtual double sampleSum(double scale, bool squares, double mean) = 0;
+};
+
+std::unique_ptr<Backend> makeHostBackend(int numThreads);
+
+// throws std::logic_error in a build without LSM_ENABLE_CUDA and
+// std::runtime_error when no device can be used
+std::unique_ptr<Backend> makeCudaBackend();
+bool cudaDeviceAvailable();
+
+}
@@ -0,0 +1,269 @@
+#include "device_pricer.hpp"
+#include "counter_rng.hpp"
+#include "device_kernels.hpp"
+#include "ols_regressor.hpp"
+#include "parallel.hpp"
+#include "payoffs.hpp"
+#include "simd_math.hpp"
+#include "stochastic_processes.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace lsm {
+
+namespace device {
+
+namespace {
+
+// CounterRNG's draws in the shape simulatePath() wants
+struct HostRng {
+    CounterRNG rng;
+
+    void normalPair(std::uint64_t path, std::uint32_t step, std::uint32_t lane,
+                    double& z0, double& z1) const {
+        const auto z = rng.normalPair(path, step, lane);
+        z0 = z.first;
+        z1 = z.second;
+    }
+    double uniform(std::uint64_t path, std::uint32_t step, std::uint32_t lane) const {
+        return rng.uniformPair(path, step, lane).first;
+    }
+    double exp(double x) const { return simd::exp(x); }
+};
+
+// The kernels over kDeviceBlock-path blocks spread across the CPU threads;
+// each block writes its partial sums and they are added in block order.
+class HostBackend : public Backend {
+public:
+    explicit HostBackend(int numThreads) : numThreads_(numThreads) {}
+
+    double simulate(const DeviceModel& model) {
+        m_ = model;
+        const std::uint64_t N = m_.numPaths;
+        paths_.assign(N * (m_.numDates + 1), 0.0);
+        cash_.assign(N, 0.0);
+        numBlocks_ = (N + kDeviceBlock - 1) / kDeviceBlock;
+        partial_.assign(numBlocks_ * numEntries(m_.numTerms), 0.0);
+
+        const HostRng rng{CounterRNG(m_.key0 | static_cast<std::uint64_t>(m_.key1) << 32)};
+        forBlocks([&](std::size_t b, std::uint64_t begin, std::uint64_t end) {
+            double sum = 0.0;
+            for (std::uint64_t p = begin; p < end; ++p) {
+                simulatePath(m_, rng, p, paths_.data() + p, N);
+                cash_[p] = payoff(m_, paths_[m_.numDates * N + p]);
+                sum += cash_[p];
+            }
+            partial_[b] = sum;
+        });
+        double total = 0.0;
+        reduce(1, &total);
+        return total;
+    }
+
+    void normalEquations(int k, double df, double* entries) {
+        const std::uint64_t N = m_.numPaths;
+        const int E = numEntries(m_.numTerms);
+        forBlocks([&](std::size_t b, std::uint64_t begin, std::uint64_t end) {
+            double* sums = partial_.data() + b * E;
+            std::fill_n(sums, E, 0.0);
+            for (std::uint64_t p = begin; p < end; ++p) {
+                cash_[p] *= df;
+                pathEntries(m_, paths_[k * N + p], cash_[p], [&](int e, double v) { sums[e] += v; });
+            }
+        });
+        reduce(E, entries);
+    }
+
+    void exercise(int k, const double* beta) {
+        const std::uint64_t N = m_.numPaths;
+        forBlocks([&](std::size_t, std::uint64_t begin, std::uint64_t end) {
+            for (std::uint64_t p = begin; p < end; ++p) {
+                cash_[p] = exerciseValue(m_, beta, paths_[k * N + p], cash_[p]);
+            }
+        });
+    }
+
+    double sampleSum(double scale, bool squares, double mean) {
+        const std::uint64_t half = m_.half;
+        const bool paired = half < m_.numPaths;
+        forBlocks([&](std::size_t b, std::uint64_t begin, std::uint64_t end) {
+            double sum = 0.0;
+            for (std::uint64_t i = begin; i < end && i < half; ++i) {
+                double v = paired ? 0.5 * (scale * cash_[i] + scale * cash_[i + half]) : scale * cash_[i];
+                if (squares) v = (v - mean) * (v - mean);
+                sum += v;
+            }
+            partial_[b] = sum;
+        });
+        double total = 0.0;
+        reduce(1, &total);
+        return total;
+    }
+
+private:
+    template <class Fn>
+    void forBlocks(Fn&& fn) {
+        const std::uint64_t N = m_.numPaths;
+        parallelFor(numBlocks_, numThreads_, [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t b = lo; b < hi; ++b) {
+                const std::uint64_t begin = b * kDeviceBlock;
+                fn(b, begin, std::min<std::uint64_t>(N, begin + kDeviceBlock));
+            }
+        });
+    }
+
+    // out[e] = sum over blocks of partial_[b * width + e], in block order
+    void reduce(int width, double* out) const {
+        for (int e = 0; e < width; ++e) out[e] = 0.0;
+        for (std::size_t b = 0; b < numBlocks_; ++b) {
+            for (int e = 0; e < width; ++e) out[e] += partial_[b * width + e];
+        }
+    }
+
+    int numThreads_;
+    DeviceModel m_;
+    std::size_t numBlocks_ = 0;
+    std::vector<double> paths_;         // date-major: paths_[k * N + p]
+    std::vector<double> cash_;
+    std::vector<double> partial_;
+};
+
+}
+
+std::unique_ptr<Backend> makeHostBackend(int numThreads) {
+    return std::make_unique<HostBackend>(numThreads);
+}
+
+#if !defined(LSM_HAVE_CUDA)
+std::unique_ptr<Backend> makeCudaBackend() {
+    throw std::logic_error("DeviceLSMPricer: built without LSM_ENABLE_CUDA");
+}
+
+bool cudaDeviceAvailable() {
+    return false;
+}
+#endif
+
+}
+
+// DeviceLSMPricer
+DeviceLSMPricer::DeviceLSMPricer(const LSMConfig& cfg, const StochasticProcess& process,
+                                 const Payoff& payoff, BasisFamily basis, DeviceTarget target)
+    : cfg_(cfg), basis_(basis), target_(target) {
+    if (cfg_.numPaths <= 0 || cfg_.numExerciseDates <= 0 || cfg_.maturity <= 0.0) {
+        throw std::invalid_argument("LSMConfig: numPaths, numExerciseDates and maturity must be > 0");
+    }
+    if (cfg_.useAntithetic && cfg_.numPaths % 2 != 0) {
+        throw std::invalid_argument("LSMConfig: antithetic sampling needs an even numPaths");
+    }
+    if (cfg_.lowMemory || cfg_.samplingScheme != SamplingScheme::PseudoRandom || cfg_.useControlVariate ||
+        cfg_.computeGreeks || cfg_.pathPrecision != PathPrecision::Double ||
+        cfg_.basisPrecision != PathPrecision::Double) {
+        throw std::logic_error("DeviceLSMPricer: supports neither low-memory mode, Sobol sampling, "
+                               "the control variate, Greeks nor float storage");
+    }
+    if (basis_.size() > device::kMaxTerms) {
+        throw std::invalid_argument("DeviceLSMPricer: at most kMaxFixedRegressors basis columns");
+    }
+    if (const auto* gbm = dynamic_cast<const GeometricBrownianMotion*>(&process)) {
+        sigma_ = gbm->volatility();
+    } else if (const auto* jd = dynamic_cast<const JumpDiffusionProcess*>(&process)) {
+        sigma_ = jd->volatility();
+        lambda_ = jd->jumpIntensity();
+        jumpMean_ = jd->jumpMean();
+        jumpVol_ = jd->jumpVol();
+    } else {
+        throw std::logic_error("DeviceLSMPricer: needs a GeometricBrownianMotion or JumpDiffusionProcess");
+    }
+    if (dynamic_cast<const PutPayoff*>(&payoff)) {
+        payoffSign_ = -1;
+    } else if (dynamic_cast<const CallPayoff*>(&payoff)) {
+        payoffSign_ = 1;
+    } else {
+        throw std::logic_error("DeviceLSMPricer: needs a PutPayoff or CallPayoff");
+    }
+    strike_ = payoff.strike();
+    if (target_ == DeviceTarget::Cuda && !device::cudaDeviceAvailable()) {
+        throw std::logic_error("DeviceLSMPricer: no CUDA backend or device");
+    }
+}
+
+bool DeviceLSMPricer::cudaAvailable() {
+    return device::cudaDeviceAvailable();
+}
+
+DeviceTarget DeviceLSMPricer::defaultTarget() {
+    return cudaAvailable() ? DeviceTarget::Cuda : DeviceTarget::Host;
+}
+
+SimulationResult DeviceLSMPricer::price(double S0) const {
+    const int D = cfg_.numExerciseDates;
+    const std::size_t N = cfg_.numPaths;
+    const int m = basis_.size();
+    const double r = cfg_.riskFreeRate;
+    const double dt = cfg_.maturity / D;
+    const double df = std::exp(-r * dt);
+
+    // JumpDiffusionProcess's drift and diffusion, its compensator included
+    const double kappa = std::exp(jumpMean_ + 0.5 * jumpVol_ * jumpVol_) - 1.0;
+    device::DeviceModel model;
+    model.S0 = S0;
+    model.drift = (r - lambda_ * kappa - 0.5 * sigma_ * sigma_) * dt;
+    model.diffusion = sigma_ * std::sqrt(dt);
+    model.jumpRate = lambda_ * dt;
+    model.jumpMean = jumpMean_;
+    model.jumpVol = jumpVol_;
+    model.strike = strike_;
+    model.invK = 1.0 / strike_;
+    model.payoffSign = payoffSign_;
+    model.basisType = static_cast<int>(basis_.type());
+    model.numTerms = m;
+    model.numDates = D;
+    model.numPaths = N;
+    model.half = cfg_.useAntithetic ? N / 2 : N;
+    model.key0 = static_cast<std::uint32_t>(cfg_.rngSeed);
+    model.key1 = static_cast<std::uint32_t>(cfg_.rngSeed >> 32);
+
+    auto backend = target_ == DeviceTarget::Cuda ? device::makeCudaBackend()
+                                                 : device::makeHostBackend(cfg_.numThreads);
+    double european = backend->simulate(model);
+    european *= std::exp(-r * cfg_.maturity) / N;
+
+    // the triangle of X'X comes back packed; it is mirrored into the full
+    // m x m system for the solver
+    std::vector<double> entries(device::numEntries(m)), XtX(m * m), Xty(m), beta(m);
+    const std::size_t tri = static_cast<std::size_t>(m) * (m + 1) / 2;
+    for (int k = D - 1; k >= 1; --k) {
+        backend->normalEquations(k, df, entries.data());
+        if (entries[tri + m] < m) continue;             // too few points to regress
+        std::size_t e = 0;
+        for (int i = 0; i < m; ++i) {
+            for (int j = i; j < m; ++j, ++e) XtX[i * m + j] = XtX[j * m + i] = entries[e];
+        }
+        std::copy_n(entries.data() + tri, m, Xty.data());
+        OLSRegressor::solve(XtX, Xty, beta);
+        backend->exercise(k, beta.data());
+    }
+
+    // antithetic pairs (p, p + N/2) are averaged before taking the variance
+    const std::size_t samples = model.half;
+    const double mean = backend->sampleSum(df, false, 0.0) / samples;
+    const double sq = backend->sampleSum(df, true, mean);
+
+    SimulationResult res;
+    res.optionValue = mean;
+    res.standardError = samples > 1 ? std::sqrt(sq / (samples - 1) / samples) : 0.0;
+    // exercising at t = 0 is also allowed
+    const double immediate = device::payoff(model, S0);
+    if (immediate > res.optionValue) {
+        res.optionValue = immediate;
+        res.standardError = 0.0;
+    }
+    res.europeanValue = european;
+    res.earlyExercisePremium = res.optionValue - res.europeanValue;
+    return res;
+}
+
+}
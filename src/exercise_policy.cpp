@@ -0,0 +1,268 @@
+#include "exercise_policy.hpp"
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace lsm {
+
+namespace {
+
+constexpr char kMagic[8] = {'L', 'S', 'M', 'P', 'O', 'L', 'C', 'Y'};
+constexpr std::uint32_t kByteOrderMark = 0x01020304u;
+
+// Fixed leading record of the binary form, native byte order. Then one
+// byte per date (1 = fitted) and the fitted dates' coefficients in order.
+struct PolicyHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t basisType;            // BasisFamilyType
+    std::int32_t numTerms;
+    std::int32_t numExerciseDates;
+    std::uint32_t reserved;
+    double scale;
+    double maturity;
+};
+
+constexpr const char* kFamilyNames[] = {"Monomial", "Laguerre", "Hermite", "Chebyshev"};
+
+const char* familyName(BasisFamilyType type) {
+    return kFamilyNames[static_cast<int>(type)];
+}
+
+std::runtime_error fileError(const std::string& filename, const std::string& what) {
+    return std::runtime_error("ExercisePolicy: " + filename + ": " + what);
+}
+
+bool endsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// just enough JSON for toJson()'s output: objects, strings without
+// escapes, numbers and arrays of them
+class JsonReader {
+public:
+    explicit JsonReader(const std::string& text) : s_(text) {}
+
+    void expect(char c) {
+        if (!consume(c)) fail(std::string("expected '") + c + "'");
+    }
+    bool consume(char c) {
+        skipSpace();
+        if (pos_ < s_.size() && s_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+    std::string string() {
+        expect('"');
+        const std::size_t end = s_.find('"', pos_);
+        if (end == std::string::npos) fail("unterminated string");
+        std::string out = s_.substr(pos_, end - pos_);
+        pos_ = end + 1;
+        return out;
+    }
+    double number() {
+        skipSpace();
+        const char* begin = s_.c_str() + pos_;
+        char* end = nullptr;
+        const double v = std::strtod(begin, &end);
+        if (end == begin) fail("expected a number");
+        pos_ += static_cast<std::size_t>(end - begin);
+        return v;
+    }
+    std::vector<double> numbers() {
+        std::vector<double> out;
+        expect('[');
+        if (consume(']')) return out;
+        do out.push_back(number()); while (consume(','));
+        expect(']');
+        return out;
+    }
+    void end() {
+        skipSpace();
+        if (pos_ != s_.size()) fail("trailing characters");
+    }
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error("ExercisePolicy: malformed JSON at offset " + std::to_string(pos_) +
+                                 ": " + what);
+    }
+
+private:
+    void skipSpace() {
+        while (pos_ < s_.size() && std::isspace(static_cast<unsigned char>(s_[pos_]))) ++pos_;
+    }
+
+    const std::string& s_;
+    std::size_t pos_ = 0;
+};
+
+}
+
+// ExercisePolicy
+ExercisePolicy::ExercisePolicy(BasisFamily basis, double scale, double maturity,
+                               std::vector<std::vector<double>> coefficients)
+    : basis_(basis), scale_(scale), maturity_(maturity), coefficients_(std::move(coefficients)) {
+    if (!(scale_ > 0.0) || !std::isfinite(scale_) || !(maturity_ > 0.0) || !std::isfinite(maturity_)) {
+        throw std::invalid_argument("ExercisePolicy: scale and maturity must be finite and > 0");
+    }
+    if (coefficients_.size() < 2) {
+        throw std::invalid_argument("ExercisePolicy: need coefficients for dates 0 .. D, D >= 1");
+    }
+    for (const auto& c : coefficients_) {
+        if (!c.empty() && c.size() != static_cast<std::size_t>(basis_.size())) {
+            throw std::invalid_argument("ExercisePolicy: coefficients do not match the basis size");
+        }
+    }
+}
+
+double ExercisePolicy::continuationValue(int k, double S) const {
+    const auto& beta = coefficients_.at(k);
+    if (beta.empty()) return std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> terms(beta.size());
+    basis_.evaluate(S * scale_, terms);
+    double value = 0.0;
+    for (std::size_t j = 0; j < beta.size(); ++j) value += beta[j] * terms[j];
+    return value;
+}
+
+void ExercisePolicy::save(const std::string& filename) const {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out) throw fileError(filename, "cannot open for writing");
+    if (endsWith(filename, ".json")) {
+        out << toJson() << '\n';
+    } else {
+        PolicyHeader h{};
+        std::memcpy(h.magic, kMagic, sizeof(kMagic));
+        h.version = kVersion;
+        h.byteOrder = kByteOrderMark;
+        h.basisType = static_cast<std::uint32_t>(basis_.type());
+        h.numTerms = basis_.numTerms();
+        h.numExerciseDates = numExerciseDates();
+        h.scale = scale_;
+        h.maturity = maturity_;
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        for (const auto& c : coefficients_) out.put(c.empty() ? 0 : 1);
+        for (const auto& c : coefficients_) {
+            out.write(reinterpret_cast<const char*>(c.data()),
+                      static_cast<std::streamsize>(c.size() * sizeof(double)));
+        }
+    }
+    out.close();
+    if (!out) throw fileError(filename, "write failed");
+}
+
+ExercisePolicy ExercisePolicy::load(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) throw fileError(filename, "cannot open");
+    const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (bytes.size() < sizeof(PolicyHeader) || std::memcmp(bytes.data(), kMagic, sizeof(kMagic)) != 0) {
+        return fromJson(bytes);
+    }
+
+    PolicyHeader h;
+    std::memcpy(&h, bytes.data(), sizeof(h));
+    if (h.byteOrder != kByteOrderMark) throw fileError(filename, "written with another byte order");
+    if (h.version != kVersion) {
+        throw fileError(filename, "format version " + std::to_string(h.version) + ", expected " +
+                                      std::to_string(kVersion));
+    }
+    if (h.basisType > static_cast<std::uint32_t>(BasisFamilyType::Chebyshev) || h.numTerms < 0 ||
+        h.numExerciseDates < 1) {
+        throw fileError(filename, "corrupt header");
+    }
+    const std::size_t numDates = static_cast<std::size_t>(h.numExerciseDates) + 1;
+    const std::size_t m = static_cast<std::size_t>(h.numTerms) + 1;
+    std::size_t offset = sizeof(h) + numDates;
+    if (bytes.size() < offset) throw fileError(filename, "truncated");
+    std::vector<std::vector<double>> coefficients(numDates);
+    std::size_t fitted = 0;
+    for (std::size_t k = 0; k < numDates; ++k) fitted += bytes[sizeof(h) + k] != 0;
+    if (bytes.size() != offset + fitted * m * sizeof(double)) throw fileError(filename, "size does not match the header");
+    for (std::size_t k = 0; k < numDates; ++k) {
+        if (bytes[sizeof(h) + k] == 0) continue;
+        coefficients[k].resize(m);
+        std::memcpy(coefficients[k].data(), bytes.data() + offset, m * sizeof(double));
+        offset += m * sizeof(double);
+    }
+    return ExercisePolicy(BasisFamily(static_cast<BasisFamilyType>(h.basisType), h.numTerms),
+                          h.scale, h.maturity, std::move(coefficients));
+}
+
+std::string ExercisePolicy::toJson() const {
+    std::ostringstream os;
+    os.precision(17);
+    os << "{\"version\":" << kVersion
+       << ",\"basis\":\"" << familyName(basis_.type()) << '"'
+       << ",\"numTerms\":" << basis_.numTerms()
+       << ",\"scale\":" << scale_
+       << ",\"maturity\":" << maturity_
+       << ",\"coefficients\":[";
+    for (std::size_t k = 0; k < coefficients_.size(); ++k) {
+        if (k) os << ',';
+        os << '[';
+        for (std::size_t j = 0; j < coefficients_[k].size(); ++j) {
+            if (j) os << ',';
+            os << coefficients_[k][j];
+        }
+        os << ']';
+    }
+    os << "]}";
+    return os.str();
+}
+
+ExercisePolicy ExercisePolicy::fromJson(const std::string& json) {
+    JsonReader in(json);
+    std::string family;
+    double version = -1.0, numTerms = -1.0, scale = 0.0, maturity = 0.0;
+    std::vector<std::vector<double>> coefficients;
+    in.expect('{');
+    do {
+        const std::string key = in.string();
+        in.expect(':');
+        if (key == "version") version = in.number();
+        else if (key == "basis") family = in.string();
+        else if (key == "numTerms") numTerms = in.number();
+        else if (key == "scale") scale = in.number();
+        else if (key == "maturity") maturity = in.number();
+        else if (key == "coefficients") {
+            in.expect('[');
+            if (!in.consume(']')) {
+                do coefficients.push_back(in.numbers()); while (in.consume(','));
+                in.expect(']');
+            }
+        } else {
+            in.fail("unknown key \"" + key + "\"");
+        }
+    } while (in.consume(','));
+    in.expect('}');
+    in.end();
+
+    if (version != kVersion) in.fail("unsupported version");
+    int type = -1;
+    for (int t = 0; t < static_cast<int>(std::size(kFamilyNames)); ++t) {
+        if (family == kFamilyNames[t]) type = t;
+    }
+    if (type < 0) in.fail("unknown basis family \"" + family + "\"");
+    if (numTerms < 0.0 || numTerms != std::floor(numTerms)) in.fail("numTerms must be a whole number >= 0");
+    try {
+        return ExercisePolicy(BasisFamily(static_cast<BasisFamilyType>(type), static_cast<int>(numTerms)),
+                              scale, maturity, std::move(coefficients));
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error(e.what());
+    }
+}
+
+bool ExercisePolicy::operator==(const ExercisePolicy& other) const {
+    return basis_.type() == other.basis_.type() && basis_.numTerms() == other.basis_.numTerms() &&
+           scale_ == other.scale_ && maturity_ == other.maturity_ && coefficients_ == other.coefficients_;
+}
+
+}
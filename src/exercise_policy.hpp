@@ -0,0 +1,59 @@
+#pragma once
+
+#include "basis_functions.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lsm {
+
+//  ExercisePolicy  
+// - a fitted LSM exercise rule detached from the pricer that fitted it:
+//   for each date k = 0 .. numExerciseDates the coefficients of the
+//   continuation value regressed on basis(spot * scale), empty where no
+//   regression was run. LSMPricer::fit() produces one and
+//   LSMPricer::applyPolicy() values fresh paths under it in one forward
+//   pass with no regressions, so the rule can be refitted off the latency-
+//   critical path and reused for every quote in between.
+//
+//   save() writes a compact binary file, or JSON when the name ends in
+//   ".json"; load() reads either. Coefficients round-trip exactly.
+
+class ExercisePolicy {
+public:
+    static constexpr std::uint32_t kVersion = 1;
+
+    // each coefficients[k] is empty or basis.size() long; throws
+    // std::invalid_argument otherwise
+    ExercisePolicy(BasisFamily basis, double scale, double maturity,
+                   std::vector<std::vector<double>> coefficients);
+
+    const BasisFamily& basis() const { return basis_; }
+    double scale() const { return scale_; }             // regressor = spot * scale
+    double maturity() const { return maturity_; }
+    int numExerciseDates() const { return static_cast<int>(coefficients_.size()) - 1; }
+    const std::vector<std::vector<double>>& coefficients() const { return coefficients_; }
+
+    // fitted continuation value at date k for spot S; NaN where the rule
+    // has no regression
+    double continuationValue(int k, double S) const;
+
+    // Binary, or JSON for a ".json" name; throws std::runtime_error on I/O
+    // failure or, when loading, on a file that is not a policy of this
+    // version and byte order
+    void save(const std::string& filename) const;
+    static ExercisePolicy load(const std::string& filename);
+
+    std::string toJson() const;
+    static ExercisePolicy fromJson(const std::string& json);       // std::runtime_error if malformed
+
+    bool operator==(const ExercisePolicy& other) const;
+
+private:
+    BasisFamily basis_;
+    double scale_;
+    double maturity_;
+    std::vector<std::vector<double>> coefficients_;
+};
+
+}
@@ -0,0 +1,894 @@
+#include "lsm_pricer.hpp"
+#include "analytic_prices.hpp"
+#include "counter_rng.hpp"
+#include "ols_regressor.hpp"
+#include "parallel.hpp"
+#include "path_cache.hpp"
+#include "quasi_random.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+
+namespace lsm {
+
+namespace {
+
+void validate(const LSMConfig& cfg, const StochasticProcess* process, const Payoff* payoff) {
+    if (cfg.numPaths <= 0 || cfg.numExerciseDates <= 0 || cfg.maturity <= 0.0) {
+        throw std::invalid_argument("LSMConfig: numPaths, numExerciseDates and maturity must be > 0");
+    }
+    if (cfg.useAntithetic && cfg.numPaths % 2 != 0) {
+        throw std::invalid_argument("LSMConfig: antithetic sampling needs an even numPaths");
+    }
+    if (!process || !payoff) {
+        throw std::invalid_argument("LSMPricer: process and payoff are required");
+    }
+    if (cfg.samplingScheme == SamplingScheme::Sobol) {
+        if (cfg.qmcReplicates <= 0 || cfg.numPaths % cfg.qmcReplicates != 0) {
+            throw std::invalid_argument("LSMConfig: Sobol sampling needs numPaths to be a multiple of qmcReplicates");
+        }
+        if (cfg.useAntithetic || cfg.lowMemory) {
+            throw std::invalid_argument("LSMConfig: Sobol sampling supports neither antithetic nor low-memory mode");
+        }
+        if (cfg.numExerciseDates > SobolSequence::kMaxDimensions) {
+            throw std::invalid_argument("LSMConfig: too many exercise dates for the Sobol sequence");
+        }
+    }
+}
+
+}
+
+// LSMPricer
+LSMPricer::LSMPricer(const LSMConfig& cfg,
+                     std::unique_ptr<StochasticProcess> process,
+                     std::unique_ptr<Payoff> payoff,
+                     std::vector<std::unique_ptr<BasisFunction>> basis)
+    : cfg_(cfg), process_(std::move(process)), payoff_(std::move(payoff)),
+      basis_(std::move(basis)) {
+    validate(cfg_, process_.get(), payoff_.get());
+    if (basis_.empty()) {
+        throw std::invalid_argument("LSMPricer: basis set is empty");
+    }
+}
+
+LSMPricer::LSMPricer(const LSMConfig& cfg,
+                     std::unique_ptr<StochasticProcess> process,
+                     std::unique_ptr<Payoff> payoff,
+                     BasisFamily basis)
+    : cfg_(cfg), process_(std::move(process)), payoff_(std::move(payoff)),
+      family_(basis) {
+    validate(cfg_, process_.get(), payoff_.get());
+}
+
+LSMPricer::LSMPricer(SharedProcess, const LSMConfig& cfg,
+                     std::shared_ptr<const StochasticProcess> process,
+                     std::unique_ptr<Payoff> payoff, BasisFamily basis)
+    : cfg_(cfg), process_(std::move(process)), payoff_(std::move(payoff)),
+      family_(basis) {
+    validate(cfg_, process_.get(), payoff_.get());
+}
+
+LSMPricer::LSMPricer(const LSMPricer& base, const LSMConfig& cfg)
+    : cfg_(cfg), process_(base.process_), payoff_(base.payoff_), family_(base.family_),
+      cache_(base.cache_) {
+    validate(cfg_, process_.get(), payoff_.get());
+}
+
+int LSMPricer::numBasis() const {
+    return family_ ? family_->size() : static_cast<int>(basis_.size());
+}
+
+PricingWorkspace& LSMPricer::workspace(PricingWorkspace& local) const {
+    PricingWorkspace& ws = workspace_ ? *workspace_ : local;
+    ws.reset();
+    return ws;
+}
+
+SimulationResult LSMPricer::price(double S0) const {
+    PricingWorkspace local;
+    PricingWorkspace& ws = workspace(local);
+    return profiled(ws, [&] { return fitAndPrice(S0, nullptr, ws); });
+}
+
+std::vector<SimulationResult> LSMPricer::priceLadder(const std::vector<double>& spots) const {
+    std::vector<SimulationResult> results;
+    results.reserve(spots.size());
+    if (cfg_.lowMemory || !process_->isScaleInvariant()) {
+        for (double S0 : spots) results.push_back(price(S0));
+        return results;
+    }
+
+    PricingWorkspace local;
+    PricingWorkspace& ws = workspace(local);
+    const auto unit = grid(1.0, cfg_.rngSeed, ws);
+    for (double S0 : spots) {
+        ws.reset();         // the grid is not arena memory
+        auto scaled = [&](int k, std::size_t begin, std::size_t end, std::span<double> scratch) {
+            const auto u = unit->readDate(k, begin, end, scratch);
+            for (std::size_t i = 0; i < u.size(); ++i) scratch[i] = S0 * u[i];
+            return std::span<const double>(scratch.data(), end - begin);
+        };
+        results.push_back(profiled(ws, [&] { return backwardInduction(std::ref(scaled), S0, nullptr, ws); }));
+    }
+    return results;
+}
+
+std::pair<SimulationResult, SimulationResult>
+LSMPricer::priceInAndOutOfSample(double S0, std::uint64_t outOfSampleSeed) const {
+    PricingWorkspace local;
+    PricingWorkspace& ws = workspace(local);
+    Coefficients coeffs;
+    const auto inSample = profiled(ws, [&] { return fitAndPrice(S0, &coeffs, ws); });
+    ws.reset();
+    const auto outOfSample = profiled(ws, [&] { return valueUnderPolicy(S0, outOfSampleSeed, coeffs, ws); });
+    return {inSample, outOfSample};
+}
+
+ExercisePolicy LSMPricer::fit(double S0, SimulationResult* inSample) const {
+    if (!family_) {
+        throw std::logic_error("LSMPricer::fit: an ExercisePolicy needs a BasisFamily basis");
+    }
+    PricingWorkspace local;
+    PricingWorkspace& ws = workspace(local);
+    Coefficients coeffs;
+    const auto res = profiled(ws, [&] { return fitAndPrice(S0, &coeffs, ws); });
+    if (inSample) *inSample = res;
+    return ExercisePolicy(*family_, 1.0 / payoff_->strike(), cfg_.maturity, std::move(coeffs));
+}
+
+SimulationResult LSMPricer::applyPolicy(const ExercisePolicy& policy, double S0,
+                                        std::uint64_t seed) const {
+    if (!family_ || family_->type() != policy.basis().type() ||
+        family_->numTerms() != policy.basis().numTerms()) {
+        throw std::invalid_argument("LSMPricer::applyPolicy: policy basis " + policy.basis().name() +
+                                    " does not match the pricer's");
+    }
+    if (policy.numExerciseDates() != cfg_.numExerciseDates || policy.maturity() != cfg_.maturity ||
+        policy.scale() != 1.0 / payoff_->strike()) {
+        throw std::invalid_argument("LSMPricer::applyPolicy: policy was fitted on another grid or strike");
+    }
+    PricingWorkspace local;
+    PricingWorkspace& ws = workspace(local);
+    return profiled(ws, [&] { return valueUnderPolicy(S0, seed, policy.coefficients(), ws); });
+}
+
+SimulationResult LSMPricer::streamOutOfSample(double S0, std::uint64_t firstSeed,
+                                              const BatchCallback& onBatch) const {
+    PricingWorkspace local;
+    PricingWorkspace& ws = workspace(local);
+    Coefficients coeffs;
+    const auto inSample = profiled(ws, [&] { return fitAndPrice(S0, &coeffs, ws); });
+    for (std::size_t b = 0;; ++b) {
+        ws.reset();
+        if (!onBatch(b, profiled(ws, [&] { return valueUnderPolicy(S0, firstSeed + b, coeffs, ws); }))) break;
+    }
+    return inSample;
+}
+
+template <class Body>
+void LSMPricer::forTiles(std::size_t count, std::size_t numDates, PricingWorkspace& ws,
+                         Body&& body, std::size_t rowsPerTile) const {
+    // tiles of kTilePaths paths spread over the workers; each worker owns a
+    // buffer of rowsPerTile rows of a tile, carved before the workers start
+    if (rowsPerTile == 0) rowsPerTile = numDates;
+    const std::size_t numTiles = (count + kTilePaths - 1) / kTilePaths;
+    const std::size_t workers = std::max<std::size_t>(
+        1, std::min<std::size_t>(static_cast<std::size_t>(effectiveThreadCount(cfg_.numThreads)), numTiles));
+    const std::size_t perWorker = kTilePaths * rowsPerTile;
+    const auto buffers = ws.allocate<double>(workers * perWorker);
+    parallelFor(workers, cfg_.numThreads, [&](std::size_t cBegin, std::size_t cEnd) {
+        for (std::size_t c = cBegin; c < cEnd; ++c) {
+            for (std::size_t t = c * numTiles / workers; t < (c + 1) * numTiles / workers; ++t) {
+                const std::size_t local = t * kTilePaths;
+                body(local, std::min(kTilePaths, count - local), buffers.data() + c * perWorker);
+            }
+        }
+    });
+}
+
+void LSMPricer::simulate(double S0, std::uint64_t seed, std::size_t first, std::size_t count,
+                         PathMatrix& paths, PricingWorkspace& ws) const {
+    if (cfg_.samplingScheme == SamplingScheme::Sobol) {
+        simulateSobol(S0, seed, first, count, paths, ws);
+        return;
+    }
+    const std::size_t N = cfg_.numPaths;
+    const std::size_t numDates = cfg_.numExerciseDates + 1;
+    const double dt = cfg_.maturity / cfg_.numExerciseDates;
+    const std::size_t half = cfg_.useAntithetic ? N / 2 : N;
+    const CounterRNG rng(seed);
+
+    // each tile of paths is simulated as one date-major block, then copied
+    // into the time-major matrix one contiguous row piece per date; a tile
+    // straddling the antithetic midpoint is simulated as two blocks
+    forTiles(count, numDates, ws, [&](std::size_t local, std::size_t n, double* block) {
+        for (std::size_t done = 0; done < n;) {
+            const std::size_t p = first + local + done;
+            const bool mirror = p >= half;
+            const std::size_t run = mirror ? n - done : std::min(n - done, half - p);
+            process_->simulateBlock(S0, dt, rng, mirror ? p - half : p, mirror, run,
+                                    std::span<double>(block, run * numDates));
+            paths.storeBlock(local + done, run, block);
+            done += run;
+        }
+    });
+}
+
+void LSMPricer::simulateSobol(double S0, std::uint64_t seed, std::size_t first, std::size_t count,
+                              PathMatrix& paths, PricingWorkspace& ws) const {
+    const std::size_t D = cfg_.numExerciseDates;
+    const double dt = cfg_.maturity / D;
+    const std::size_t perReplicate = cfg_.numPaths / cfg_.qmcReplicates;
+    const CounterRNG rng(seed);
+
+    // path p is point p % perReplicate of scrambling p / perReplicate;
+    // dimension j of a point drives step j of the Brownian bridge
+    std::vector<SobolSequence> replicates(cfg_.qmcReplicates, SobolSequence(static_cast<int>(D)));
+    for (std::size_t r = 0; r < replicates.size(); ++r) replicates[r].scramble(rng, r);
+    const BrownianBridge bridge(D, dt);
+
+    forTiles(count, D + 1, ws, [&](std::size_t local, std::size_t n, double* block) {
+        double* z = block + kTilePaths * (D + 1);
+        double* W = z + kTilePaths * D;
+        for (std::size_t done = 0; done < n;) {
+            const std::size_t p = first + local + done;
+            const std::size_t r = p / perReplicate, point = p % perReplicate;
+            const std::size_t run = std::min(n - done, perReplicate - point);
+            replicates[r].normals(point, run, std::span<double>(z, run * D));
+            bridge.transform(std::span<const double>(z, run * D), run, std::span<double>(W, run * D));
+            if (!process_->simulateFromBrownian(S0, dt, run, std::span<const double>(W, run * D),
+                                                std::span<double>(block, run * (D + 1)))) {
+                throw std::logic_error(process_->name() + ": Sobol sampling is not supported");
+            }
+            paths.storeBlock(local + done, run, block);
+            done += run;
+        }
+    }, 3 * D + 1);
+}
+
+PathMatrix LSMPricer::simulatePaths(double S0, std::uint64_t seed) const {
+    PricingWorkspace local;
+    PathMatrix paths(cfg_.numPaths, cfg_.numExerciseDates + 1, cfg_.pathPrecision);
+    simulate(S0, seed, 0, cfg_.numPaths, paths, workspace(local));
+    return paths;
+}
+
+std::shared_ptr<const PathMatrix> LSMPricer::grid(double S0, std::uint64_t seed,
+                                                  PricingWorkspace& ws) const {
+    const std::size_t N = cfg_.numPaths;
+    const std::size_t numDates = cfg_.numExerciseDates + 1;
+    PricingProfile* prof = ws.profile();
+    StageTimer timer(prof ? &prof->stageSeconds[PricingProfile::Simulation] : nullptr);
+    if (cache_) {
+        const auto key = PathCache::makeKey(*process_, cfg_, S0, seed);
+        if (!key.empty()) {
+            return cache_->getOrSimulate(key, [&]() {
+                PathMatrix paths(N, numDates, cfg_.pathPrecision);
+                simulate(S0, seed, 0, N, paths, ws);
+                return paths;
+            });
+        }
+    }
+    // uncached grids live in the workspace; the pointer does not own them
+    PathMatrix& paths = ws.gridStorage(N, numDates, cfg_.pathPrecision);
+    simulate(S0, seed, 0, N, paths, ws);
+    return std::shared_ptr<const PathMatrix>(std::shared_ptr<const PathMatrix>(), &paths);
+}
+
+SimulationResult LSMPricer::fitAndPrice(double S0, Coefficients* fitted, PricingWorkspace& ws,
+                                        int horizon) const {
+    // readers go in by std::ref so the DateReader never copies (or
+    // heap-allocates) their captures
+    if (!cfg_.lowMemory) {
+        const auto paths = grid(S0, cfg_.rngSeed, ws);
+        auto stored = [&](int k, std::size_t begin, std::size_t end, std::span<double> scratch) {
+            return paths->readDate(k, begin, end, scratch);
+        };
+        return backwardInduction(std::ref(stored), S0, fitted, ws);
+    }
+
+    // regenerate each date from per-path state: the first request (date D)
+    // starts every path at the horizon and steps it back to D, later ones
+    // step it back one date
+    const std::size_t N = cfg_.numPaths;
+    const std::size_t D = cfg_.numExerciseDates;
+    const std::size_t H = std::max<std::size_t>(D, static_cast<std::size_t>(std::max(horizon, 0)));
+    const double dt = cfg_.maturity / D;
+    const std::size_t half = cfg_.useAntithetic ? N / 2 : N;
+    const std::size_t stateSize = process_->backwardStateSize(H);
+    const CounterRNG rng(cfg_.rngSeed);
+    const auto state = ws.allocate<double>(N * stateSize);
+
+    auto regenerated = [&](int k, std::size_t begin, std::size_t end, std::span<double> scratch) {
+        for (std::size_t p = begin; p < end; ++p) {
+            const bool mirror = p >= half;
+            const std::uint64_t id = mirror ? p - half : p;
+            const auto st = state.subspan(p * stateSize, stateSize);
+            double S;
+            if (static_cast<std::size_t>(k) == D) {
+                S = process_->beginBackward(S0, dt, H, rng, id, mirror, st);
+                for (std::size_t j = H - 1; j >= D; --j) S = process_->stepBackward(dt, j, rng, id, mirror, st);
+            } else {
+                S = process_->stepBackward(dt, k, rng, id, mirror, st);
+            }
+            if (cfg_.pathPrecision == PathPrecision::Float) S = static_cast<float>(S);
+            scratch[p - begin] = S;
+        }
+        return std::span<const double>(scratch.data(), end - begin);
+    };
+    return backwardInduction(std::ref(regenerated), S0, fitted, ws);
+}
+
+SimulationResult LSMPricer::priceOn(const PathMatrix& paths, double S0,
+                                    PricingWorkspace& ws) const {
+    if (paths.numPaths() != static_cast<std::size_t>(cfg_.numPaths) ||
+        paths.numDates() <= static_cast<std::size_t>(cfg_.numExerciseDates)) {
+        throw std::invalid_argument("LSMPricer: grid does not cover the time grid");
+    }
+    auto stored = [&](int k, std::size_t begin, std::size_t end, std::span<double> scratch) {
+        return paths.readDate(k, begin, end, scratch);
+    };
+    return backwardInduction(std::ref(stored), S0, nullptr, ws);
+}
+
+ExtrapolatedResult LSMPricer::priceExtrapolated(double S0, int numGrids) const {
+    if (numGrids < 2 || numGrids > 4) {
+        throw std::invalid_argument("priceExtrapolated: numGrids must be 2, 3 or 4");
+    }
+    if (!family_ || cfg_.lowMemory) {
+        throw std::logic_error("priceExtrapolated: needs a BasisFamily basis and the stored grid");
+    }
+    const std::size_t N = cfg_.numPaths;
+    const int G = numGrids;
+    const int finest = cfg_.numExerciseDates << (G - 1);
+    auto onGrid = [&](int numExerciseDates) {
+        LSMConfig cfg = cfg_;
+        cfg.numExerciseDates = numExerciseDates;
+        return LSMPricer(*this, cfg);
+    };
+    const LSMPricer fine = onGrid(finest);
+
+    PricingWorkspace local;
+    PricingWorkspace& ws = workspace(local);
+    const auto paths = fine.grid(S0, cfg_.rngSeed, ws);
+
+    // grid g reads every 2^(G-1-g)-th date of the finest; grid G - 1 is the
+    // finest itself
+    ExtrapolatedResult res;
+    std::vector<std::vector<double>> discounted(G, std::vector<double>(N));
+    for (int g = 0; g < G; ++g) {
+        const int step = 1 << (G - 1 - g);
+        const LSMPricer level = onGrid(cfg_.numExerciseDates << g);
+        auto coarse = [&](int k, std::size_t begin, std::size_t end, std::span<double> scratch) {
+            return paths->readDate(static_cast<std::size_t>(k) * step, begin, end, scratch);
+        };
+        res.numExerciseDates.push_back(level.cfg_.numExerciseDates);
+        res.grids.push_back(level.profiled(ws, [&] {
+            return level.backwardInduction(std::ref(coarse), S0, nullptr, ws, discounted[g]);
+        }));
+    }
+
+    // Richardson weights on grids first .. G - 1 with an error expansion
+    // c1 dt + c2 dt^2 + ...: halving dt, each round eliminates the next
+    // power, A_j = (2^j A_{j-1}(fine) - A_{j-1}(coarse)) / (2^j - 1)
+    auto weights = [&](int first) {
+        std::vector<std::vector<double>> A;
+        for (int g = first; g < G; ++g) {
+            A.emplace_back(G, 0.0);
+            A.back()[g] = 1.0;
+        }
+        for (int j = 1; A.size() > 1; ++j) {
+            const double f = std::ldexp(1.0, j);
+            for (std::size_t l = 0; l + 1 < A.size(); ++l) {
+                for (int g = 0; g < G; ++g) A[l][g] = (f * A[l + 1][g] - A[l][g]) / (f - 1.0);
+            }
+            A.pop_back();
+        }
+        return A[0];
+    };
+    // the control, when used, is the same European payoff on every grid
+    std::vector<double> control(cfg_.useControlVariate ? N : 0);
+    if (!control.empty()) {
+        std::vector<double> row;
+        const auto S = paths->readDate(finest, 0, N, row);
+        payoff_->evaluateBatch(S, control);
+        const double discT = std::exp(-cfg_.riskFreeRate * cfg_.maturity);
+        for (double& c : control) c *= discT;
+    }
+    auto limit = [&](const std::vector<double>& w) {
+        std::vector<double> combined(N, 0.0);
+        for (int g = 0; g < G; ++g) {
+            if (w[g] == 0.0) continue;
+            for (std::size_t p = 0; p < N; ++p) combined[p] += w[g] * discounted[g][p];
+        }
+        return summarise(combined, control, res.grids.back().europeanValue, S0);
+    };
+    const auto extrapolated = limit(weights(0));
+    const auto fewer = limit(weights(1));
+    res.americanValue = extrapolated.optionValue;
+    res.standardError = extrapolated.standardError;
+    res.discretisationError = std::abs(extrapolated.optionValue - fewer.optionValue);
+    res.totalError = std::hypot(res.standardError, res.discretisationError);
+    return res;
+}
+
+void LSMPricer::fillDesign(std::span<const double> x, std::span<double> X) const {
+    if (family_) {
+        family_->evaluateBatch(x, X);
+        return;
+    }
+    const std::size_t n = x.size();
+    for (std::size_t j = 0; j < basis_.size(); ++j) {
+        basis_[j]->evaluateBatch(x, X.subspan(j * n, n));
+    }
+}
+
+void LSMPricer::fillDesign(std::span<const double> x, std::span<float> X,
+                           std::span<double> scratch) const {
+    if (family_) {
+        family_->evaluateBatch(x, X);
+        return;
+    }
+    const std::size_t n = x.size();
+    for (std::size_t j = 0; j < basis_.size(); ++j) {
+        basis_[j]->evaluateBatch(x, scratch.first(n));
+        std::copy(scratch.begin(), scratch.begin() + n, X.begin() + j * n);
+    }
+}
+
+namespace {
+
+// one work block of the backward sweep
+struct Block {
+    std::size_t begin = 0, end = 0;
+    std::size_t n = 0;                  // in-the-money paths at this date
+    std::span<std::size_t> itm;
+    std::span<double> spot, payoff, itmSpot, x, y, exercise, X, fit;
+    std::span<float> Xf;                // X when the design is stored in float
+    std::span<double> XtX, Xty;
+    double european = 0.0;
+    std::array<double, PricingProfile::kNumStages> seconds{};     // when profiling
+};
+
+}
+
+std::size_t LSMPricer::blockBytes() {
+    return sizeof(Block);
+}
+
+SimulationResult LSMPricer::backwardInduction(const DateReader& spotsAt, double S0,
+                                              Coefficients* fitted, PricingWorkspace& ws,
+                                              std::span<double> discounted) const {
+    const int D = cfg_.numExerciseDates;
+    const std::size_t N = cfg_.numPaths;
+    const std::size_t stride = D + 1;
+    const int m = numBasis();
+    const double df = std::exp(-cfg_.riskFreeRate * cfg_.maturity / D);
+    const double invK = 1.0 / payoff_->strike();
+    const bool greeks = cfg_.computeGreeks;
+    const bool floatDesign = cfg_.basisPrecision == PathPrecision::Float;
+    PricingProfile* prof = ws.profile();
+
+    // Paths are cut into fixed-size blocks independent of the thread count.
+    // Each block gathers its own in-the-money paths and normal-equation
+    // partial sums; blocks are reduced in index order, so the result does
+    // not depend on how blocks were spread over threads. Every buffer is
+    // carved from the workspace at full block size up front.
+    const std::size_t numBlocks = (N + kBlockPaths - 1) / kBlockPaths;
+    const auto blocks = ws.allocate<Block>(numBlocks);
+    for (std::size_t b = 0; b < numBlocks; ++b) {
+        Block& blk = blocks[b];
+        blk.begin = b * kBlockPaths;
+        blk.end = std::min(N, blk.begin + kBlockPaths);
+        const std::size_t size = blk.end - blk.begin;
+        blk.itm = ws.allocate<std::size_t>(size);
+        blk.spot = ws.allocate<double>(size);
+        blk.payoff = ws.allocate<double>(size);
+        blk.itmSpot = ws.allocate<double>(greeks ? size : 0);
+        blk.x = ws.allocate<double>(size);
+        blk.y = ws.allocate<double>(size);
+        blk.exercise = ws.allocate<double>(size);
+        blk.fit = ws.allocate<double>(size);
+        blk.X = ws.allocate<double>(floatDesign ? 0 : size * m);
+        blk.Xf = ws.allocate<float>(floatDesign ? size * m : 0);
+        blk.XtX = ws.allocate<double>(static_cast<std::size_t>(m) * m);
+        blk.Xty = ws.allocate<double>(m);
+    }
+    auto forBlocks = [&](auto&& body) {
+        parallelFor(numBlocks, cfg_.numThreads, [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t b = lo; b < hi; ++b) body(blocks[b]);
+        });
+    };
+    using Stage = PricingProfile::Stage;
+    auto sink = [&](Block& blk, Stage stage) { return prof ? &blk.seconds[stage] : nullptr; };
+    auto spotsOf = [&](Block& blk, int k) {
+        StageTimer timer(sink(blk, PricingProfile::Simulation));
+        return spotsAt(k, blk.begin, blk.end, blk.spot);
+    };
+
+    // cash[p]: path p's realised cash flow, discounted to the current date.
+    // For the Greeks each path also keeps its stopping date, the spot there
+    // and its spot at date 1.
+    const auto cash = ws.allocate<double>(N);
+    const auto tau = ws.allocate<int>(greeks ? N : 0);
+    const auto stopSpot = ws.allocate<double>(greeks ? N : 0);
+    const auto spot1 = ws.allocate<double>(greeks ? N : 0);
+    const auto control = ws.allocate<double>(cfg_.useControlVariate ? N : 0);
+    const double discT = std::exp(-cfg_.riskFreeRate * cfg_.maturity);
+    std::fill(tau.begin(), tau.end(), D);
+    forBlocks([&](Block& blk) {
+        const auto S = spotsOf(blk, D);
+        StageTimer timer(sink(blk, PricingProfile::Exercise));
+        payoff_->evaluateBatch(S, cash.subspan(blk.begin, S.size()));
+        std::size_t n = 0;
+        for (std::size_t p = blk.begin; p < blk.end; ++p) {
+            blk.european += cash[p];
+            n += cash[p] > 0.0;
+        }
+        blk.n = n;
+        if (!control.empty()) {
+            for (std::size_t p = blk.begin; p < blk.end; ++p) control[p] = cash[p] * discT;
+        }
+        if (greeks) {
+            std::copy(S.begin(), S.end(), stopSpot.begin() + blk.begin);
+            if (D == 1) std::copy(S.begin(), S.end(), spot1.begin() + blk.begin);
+        }
+    });
+    double european = 0.0;
+    for (const auto& blk : blocks) {
+        european += blk.european;
+        if (prof) prof->itmPaths[D] += blk.n;
+    }
+    european *= discT / N;
+
+    if (fitted) fitted->assign(stride, {});
+
+    const auto totalXtX = ws.allocate<double>(static_cast<std::size_t>(m) * m);
+    const auto totalXty = ws.allocate<double>(m);
+    const auto beta = ws.allocate<double>(m);
+    for (int k = D - 1; k >= 1; --k) {
+        // discount, compact the in-the-money paths into dense buffers and
+        // accumulate X'X, X'y per block
+        forBlocks([&](Block& blk) {
+            const auto spots = spotsOf(blk, k);
+            const std::size_t size = spots.size();
+            if (greeks && k == 1) std::copy(spots.begin(), spots.end(), spot1.begin() + blk.begin);
+            std::optional<StageTimer> gather(std::in_place, sink(blk, PricingProfile::Exercise));
+            const auto h = blk.payoff.first(size);
+            payoff_->evaluateBatch(spots, h);
+            double* c = cash.data() + blk.begin;
+            for (std::size_t i = 0; i < size; ++i) c[i] *= df;
+            // Branch-free stream compaction: every path writes its slot at
+            // n, the exclusive prefix sum of the in-the-money flags, and
+            // only in-the-money paths advance it, so the slot an OTM path
+            // wrote is overwritten by the next ITM one.
+            std::size_t n = 0;
+            for (std::size_t i = 0; i < size; ++i) {
+                blk.itm[n] = blk.begin + i;
+                blk.x[n] = spots[i] * invK;
+                blk.y[n] = c[i];
+                blk.exercise[n] = h[i];
+                n += h[i] > 0.0;
+            }
+            if (greeks) {
+                for (std::size_t j = 0; j < n; ++j) blk.itmSpot[j] = spots[blk.itm[j] - blk.begin];
+            }
+            blk.n = n;
+            gather.reset();
+            std::fill(blk.XtX.begin(), blk.XtX.end(), 0.0);
+            std::fill(blk.Xty.begin(), blk.Xty.end(), 0.0);
+            if (n == 0) return;
+            {
+                StageTimer timer(sink(blk, PricingProfile::Basis));
+                if (floatDesign) fillDesign(blk.x.first(n), blk.Xf.first(n * m), blk.fit);
+                else fillDesign(blk.x.first(n), blk.X.first(n * m));
+            }
+            StageTimer timer(sink(blk, PricingProfile::Regression));
+            if (floatDesign) OLSRegressor::accumulate(blk.Xf.first(n * m), blk.y.first(n), blk.XtX, blk.Xty);
+            else OLSRegressor::accumulate(blk.X.first(n * m), blk.y.first(n), blk.XtX, blk.Xty);
+        });
+
+        std::optional<StageTimer> reduce(std::in_place,
+                                         prof ? &prof->stageSeconds[PricingProfile::Regression] : nullptr);
+        std::fill(totalXtX.begin(), totalXtX.end(), 0.0);
+        std::fill(totalXty.begin(), totalXty.end(), 0.0);
+        std::size_t count = 0;
+        for (const auto& blk : blocks) {
+            for (std::size_t i = 0; i < totalXtX.size(); ++i) totalXtX[i] += blk.XtX[i];
+            for (std::size_t i = 0; i < totalXty.size(); ++i) totalXty[i] += blk.Xty[i];
+            count += blk.n;
+        }
+        if (prof) prof->itmPaths[k] = count;
+        if (count < static_cast<std::size_t>(m)) continue;   // too few points to regress
+
+        OLSRegressor::solve(totalXtX, totalXty, beta);
+        reduce.reset();
+        if (prof) {
+            ++prof->regressions;
+            prof->conditionNumbers[k] = OLSRegressor::conditionNumber(totalXtX);
+        }
+
+        // exercise where the immediate payoff beats the fitted continuation
+        forBlocks([&](Block& blk) {
+            const std::size_t n = blk.n;
+            if (n == 0) return;
+            StageTimer timer(sink(blk, PricingProfile::Exercise));
+            if (floatDesign) OLSRegressor::predict(blk.Xf.first(n * m), beta, blk.fit.first(n));
+            else OLSRegressor::predict(blk.X.first(n * m), beta, blk.fit.first(n));
+            // one scatter pass back to the paths, as selects
+            for (std::size_t i = 0; i < n; ++i) {
+                const std::size_t p = blk.itm[i];
+                const bool stop = blk.exercise[i] > blk.fit[i];
+                cash[p] = stop ? blk.exercise[i] : cash[p];
+            }
+            if (greeks) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    const std::size_t p = blk.itm[i];
+                    const bool stop = blk.exercise[i] > blk.fit[i];
+                    tau[p] = stop ? k : tau[p];
+                    stopSpot[p] = stop ? blk.itmSpot[i] : stopSpot[p];
+                }
+            }
+        });
+        if (fitted) (*fitted)[k].assign(beta.begin(), beta.end());
+    }
+    forBlocks([&](Block& blk) {
+        for (std::size_t p = blk.begin; p < blk.end; ++p) cash[p] *= df;
+    });
+    if (prof) {
+        for (const auto& blk : blocks)
+            for (int s = 0; s < PricingProfile::kNumStages; ++s) prof->stageSeconds[s] += blk.seconds[s];
+    }
+
+    if (!discounted.empty()) std::copy(cash.begin(), cash.end(), discounted.begin());
+
+    auto res = summarise(cash, control, european, S0);
+    if (greeks) addGreeks(S0, tau, stopSpot, spot1, res, ws);
+    return res;
+}
+
+void LSMPricer::addGreeks(double S0, std::span<const int> tau,
+                          std::span<const double> stopSpot, std::span<const double> spot1,
+                          SimulationResult& res, PricingWorkspace& ws) const {
+    // Exercise at t = 0 beat continuation: the value is the payoff itself
+    if (res.standardError == 0.0 && res.optionValue == payoff_->evaluate(S0)) {
+        res.delta = payoff_->derivative(S0);
+        return;
+    }
+
+    // With the fitted stopping times held fixed, each path contributes
+    //   delta  e^{-r tau} h'(S_tau) dS_tau/dS0
+    //   vega   e^{-r tau} h'(S_tau) dS_tau/dsigma
+    //   gamma  e^{-r tau} h'(S_tau) dS_tau/dS0 (score - 1/S0)
+    // where the last differentiates the pathwise delta through the density
+    // of the first step, since h'' is a point mass.
+    const std::size_t N = cfg_.numPaths;
+    const std::size_t half = cfg_.useAntithetic ? N / 2 : N;
+    const double dt = cfg_.maturity / cfg_.numExerciseDates;
+    const CounterRNG rng(cfg_.rngSeed);
+    const auto d = ws.allocate<double>(N);
+    const auto g = ws.allocate<double>(N);
+    const auto v = ws.allocate<double>(N);
+    parallelFor(N, cfg_.numThreads, [&](std::size_t begin, std::size_t end) {
+        PathSensitivity sens;
+        for (std::size_t p = begin; p < end; ++p) {
+            const bool mirror = p >= half;
+            const std::uint64_t id = mirror ? p - half : p;
+            if (!process_->sensitivities(S0, dt, tau[p], stopSpot[p], spot1[p],
+                                         rng, id, mirror, sens)) {
+                throw std::logic_error(process_->name() + ": Greeks are not supported");
+            }
+            const double w = std::exp(-cfg_.riskFreeRate * tau[p] * dt)
+                           * payoff_->derivative(stopSpot[p]);
+            d[p] = w * sens.dS_dS0;
+            v[p] = w * sens.dS_dSigma;
+            g[p] = w * sens.dS_dS0 * (sens.score - 1.0 / S0);
+        }
+    });
+    std::tie(res.delta, res.deltaStdError) = meanAndStdError(d);
+    std::tie(res.gamma, res.gammaStdError) = meanAndStdError(g);
+    std::tie(res.vega, res.vegaStdError) = meanAndStdError(v);
+}
+
+SimulationResult LSMPricer::valueUnderPolicy(double S0, std::uint64_t seed,
+                                             const Coefficients& coeffs,
+                                             PricingWorkspace& ws) const {
+    // low-memory mode streams the paths through in blocks instead of
+    // simulating the whole grid at once
+    const std::size_t N = cfg_.numPaths;
+    const std::size_t chunk = cfg_.lowMemory ? kBlockPaths : N;
+    const auto discounted = ws.allocate<double>(N);
+    const auto control = ws.allocate<double>(cfg_.useControlVariate ? N : 0);
+    PricingProfile* prof = ws.profile();
+    double european = 0.0;
+    if (chunk == N) {
+        european = applyPolicy(*grid(S0, seed, ws), coeffs, discounted, control, ws);
+    } else {
+        for (std::size_t first = 0; first < N; first += chunk) {
+            const std::size_t count = std::min(chunk, N - first);
+            PathMatrix& paths = ws.gridStorage(count, cfg_.numExerciseDates + 1, cfg_.pathPrecision);
+            {
+                StageTimer timer(prof ? &prof->stageSeconds[PricingProfile::Simulation] : nullptr);
+                simulate(S0, seed, first, count, paths, ws);
+            }
+            european += applyPolicy(paths, coeffs, discounted.subspan(first, count),
+                                    control.empty() ? control : control.subspan(first, count), ws);
+        }
+    }
+    european *= std::exp(-cfg_.riskFreeRate * cfg_.maturity) / N;
+    return summarise(discounted, control, european, S0);
+}
+
+double LSMPricer::applyPolicy(const PathMatrix& paths, const Coefficients& coeffs,
+                              std::span<double> discounted, std::span<double> control,
+                              PricingWorkspace& ws, int firstDate) const {
+    const int D = cfg_.numExerciseDates;
+    const std::size_t N = paths.numPaths();
+    const int m = numBasis();
+    const double dt = cfg_.maturity / D;
+    const double invK = 1.0 / payoff_->strike();
+    PricingProfile* prof = ws.profile();
+    auto sink = [&](PricingProfile::Stage stage) { return prof ? &prof->stageSeconds[stage] : nullptr; };
+    StageTimer timer(sink(PricingProfile::Exercise));
+
+    // walk forward one date row at a time; a path leaves the live set the
+    // first time its payoff beats the fitted continuation value
+    const auto alive = ws.allocate<char>(N);
+    const auto spot = ws.allocate<double>(N);
+    const auto h = ws.allocate<double>(N);
+    const auto x = ws.allocate<double>(N);
+    const auto exercise = ws.allocate<double>(N);
+    const bool floatDesign = cfg_.basisPrecision == PathPrecision::Float;
+    const auto X = ws.allocate<double>(floatDesign ? 0 : N * m);
+    const auto Xf = ws.allocate<float>(floatDesign ? N * m : 0);
+    const auto cont = ws.allocate<double>(N);
+    const auto idx = ws.allocate<std::size_t>(N);
+    std::fill(alive.begin(), alive.end(), 1);
+    for (int k = std::max(firstDate + 1, 1); k < D; ++k) {
+        if (coeffs[k].empty()) continue;
+        const auto S = paths.readDate(k - firstDate, 0, N, spot);
+        payoff_->evaluateBatch(S, h);
+        // live in-the-money paths, compacted as in backwardInduction
+        std::size_t n = 0;
+        for (std::size_t p = 0; p < N; ++p) {
+            idx[n] = p;
+            x[n] = S[p] * invK;
+            exercise[n] = h[p];
+            n += (alive[p] != 0) & (h[p] > 0.0);
+        }
+        if (prof) prof->itmPaths[k] += n;
+        if (n == 0) continue;
+        {
+            // counted under Basis, so taken back out of the enclosing Exercise
+            double basis = 0.0;
+            {
+                StageTimer t(prof ? &basis : nullptr);
+                if (floatDesign) fillDesign(x.first(n), Xf.first(n * m), cont);
+                else fillDesign(x.first(n), X.first(n * m));
+            }
+            if (prof) {
+                prof->stageSeconds[PricingProfile::Basis] += basis;
+                prof->stageSeconds[PricingProfile::Exercise] -= basis;
+            }
+        }
+        if (floatDesign) OLSRegressor::predict(Xf.first(n * m), coeffs[k], cont.first(n));
+        else OLSRegressor::predict(X.first(n * m), coeffs[k], cont.first(n));
+        const double disc = std::exp(-cfg_.riskFreeRate * k * dt);
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t p = idx[i];
+            const bool stop = exercise[i] > cont[i];
+            discounted[p] = stop ? exercise[i] * disc : discounted[p];
+            alive[p] = stop ? 0 : alive[p];
+        }
+    }
+
+    // undiscounted sum of terminal payoffs, for the European estimate
+    const auto ST = paths.readDate(D - firstDate, 0, N, spot);
+    payoff_->evaluateBatch(ST, h);
+    const double discT = std::exp(-cfg_.riskFreeRate * cfg_.maturity);
+    double terminal = 0.0;
+    std::size_t itm = 0;
+    for (std::size_t p = 0; p < N; ++p) {
+        terminal += h[p];
+        itm += h[p] > 0.0;
+        if (alive[p]) discounted[p] = h[p] * discT;
+        if (!control.empty()) control[p] = h[p] * discT;
+    }
+    if (prof) prof->itmPaths[D] += itm;
+    return terminal;
+}
+
+std::size_t LSMPricer::numSamples(std::size_t N) const {
+    if (cfg_.samplingScheme == SamplingScheme::Sobol) return cfg_.qmcReplicates;
+    return cfg_.useAntithetic ? N / 2 : N;
+}
+
+double LSMPricer::sample(std::span<const double> values, std::size_t i) const {
+    // antithetic pairs (p, p + N/2) are averaged before taking the variance;
+    // under Sobol sampling the samples are the per-replicate means, the
+    // only independent quantities
+    const std::size_t N = values.size();
+    const std::size_t samples = numSamples(N);
+    if (cfg_.samplingScheme == SamplingScheme::Sobol) {
+        const std::size_t per = N / samples;
+        double s = 0.0;
+        for (std::size_t p = i * per; p < (i + 1) * per; ++p) s += values[p];
+        return s / per;
+    }
+    return cfg_.useAntithetic ? 0.5 * (values[i] + values[i + samples]) : values[i];
+}
+
+std::pair<double, double> LSMPricer::meanAndStdError(std::span<const double> values) const {
+    const std::size_t samples = numSamples(values.size());
+    double sum = 0.0;
+    for (std::size_t i = 0; i < samples; ++i) sum += sample(values, i);
+    const double mean = sum / samples;
+    double ss = 0.0;
+    for (std::size_t i = 0; i < samples; ++i) {
+        const double d = sample(values, i) - mean;
+        ss += d * d;
+    }
+    const double var = samples > 1 ? ss / (samples - 1) : 0.0;
+    return {mean, std::sqrt(var / samples)};
+}
+
+double LSMPricer::europeanControl(double S0) const {
+    if (control_) return control_(S0);
+    const auto price = europeanClosedForm(*process_, *payoff_, S0, cfg_.maturity, cfg_.riskFreeRate);
+    if (!price) {
+        throw std::logic_error("LSMPricer: no closed-form European price for " + process_->name() +
+                               " / " + payoff_->name() + "; supply one with setControlVariate()");
+    }
+    return *price;
+}
+
+SimulationResult LSMPricer::summarise(std::span<const double> discounted,
+                                      std::span<const double> control,
+                                      double europeanValue, double S0) const {
+    SimulationResult res;
+    if (control.empty()) {
+        std::tie(res.optionValue, res.standardError) = meanAndStdError(discounted);
+    } else {
+        // Y - b (C - E[C]) with the variance-minimising b = Cov(Y, C) / Var(C)
+        // estimated on the same samples; the European value is then exact
+        const std::size_t samples = numSamples(discounted.size());
+        const double mu = europeanControl(S0);
+        double sy = 0.0, sc = 0.0;
+        for (std::size_t i = 0; i < samples; ++i) {
+            sy += sample(discounted, i);
+            sc += sample(control, i);
+        }
+        const double my = sy / samples, mc = sc / samples;
+        double cov = 0.0, varC = 0.0;
+        for (std::size_t i = 0; i < samples; ++i) {
+            const double dy = sample(discounted, i) - my, dc = sample(control, i) - mc;
+            cov += dy * dc;
+            varC += dc * dc;
+        }
+        const double b = varC > 0.0 ? cov / varC : 0.0;
+        double ss = 0.0;
+        for (std::size_t i = 0; i < samples; ++i) {
+            const double r = (sample(discounted, i) - my) - b * (sample(control, i) - mc);
+            ss += r * r;
+        }
+        res.optionValue = my - b * (mc - mu);
+        res.standardError = samples > 2 ? std::sqrt(ss / (samples - 2) / samples) : 0.0;
+        res.controlCoefficient = b;
+        europeanValue = mu;
+    }
+
+    // exercising at t = 0 is also allowed
+    const double immediate = payoff_->evaluate(S0);
+    if (immediate > res.optionValue) {
+        res.optionValue = immediate;
+        res.standardError = 0.0;
+    }
+    res.europeanValue = europeanValue;
+    res.earlyExercisePremium = res.optionValue - res.europeanValue;
+    return res;
+}
+
+}
@@ -0,0 +1,299 @@
+#pragma once
+
+#include "lsm_types.hpp"
+#include "basis_functions.hpp"
+#include "exercise_policy.hpp"
+#include "parallel.hpp"
+#include "pricing_workspace.hpp"
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace lsm {
+
+class PathCache;
+class PortfolioPricer;
+class UpperBoundEstimator;
+class PricingScheduler;
+class MLMCPricer;
+
+//  ExtrapolatedResult  
+// - LSMPricer::priceExtrapolated(): the Bermudan prices on nested date
+//   grids and their Richardson limit, the American price
+
+struct ExtrapolatedResult {
+    std::vector<int> numExerciseDates;      // per grid, coarsest first
+    std::vector<SimulationResult> grids;    // the Bermudan price on each
+    double americanValue = 0.0;             // Richardson limit
+    double standardError = 0.0;             // Monte Carlo error of the limit
+    double discretisationError = 0.0;       // limit minus the limit of one grid fewer
+    double totalError = 0.0;                // the two in quadrature
+};
+
+//  LSMPricer  
+// - Longstaff-Schwartz (2001) least-squares Monte Carlo for Bermudan /
+//   American options: simulate paths, then step backward through the
+//   exercise dates regressing discounted cash flows on the basis over the
+//   in-the-money paths. Regressors are spot / strike.
+//
+//   Paths are generated across cfg.numThreads threads. Each path draws from
+//   its own counter-based Philox substream (seed, pathId), so every result
+//   is bit-identical for any thread count. The backward sweep runs on the
+//   same threads over fixed blocks of paths: per-block X'X / X'y partial
+//   sums are reduced in block order, then exercise decisions are applied
+//   block by block.
+//
+//   cfg.lowMemory skips the stored grid: the process regenerates each date
+//   backward from a few doubles of per-path state while the sweep runs, so
+//   memory is O(N) and the price equals the stored-grid price bit for bit.
+//
+//   SamplingScheme::Sobol draws each path's normals from one point of a
+//   scrambled Sobol sequence, one dimension per date through a Brownian
+//   bridge; the numPaths are split over cfg.qmcReplicates independent
+//   scramblings, which are pooled for the regression, and the standard
+//   error comes from the spread of the replicate means.
+//
+//   cfg.useControlVariate uses each path's discounted European payoff as a
+//   control: the reported value is the sample mean minus b times the
+//   control's error against its exact price, with the fitted optimal b.
+//   The exact price is Black-Scholes (GBM) or Merton's series (jump-
+//   diffusion) for puts and calls, or whatever setControlVariate() gives.
+//
+//   cfg.profile attaches a PricingProfile to each result: stage times,
+//   regression count, in-the-money counts and condition numbers per date,
+//   arena use. Off, or built without LSM_PROFILING, it costs a branch.
+//
+//   cfg.computeGreeks adds delta, gamma and vega with their standard errors,
+//   estimated on the same paths under the fitted stopping times.
+//
+//   With a PathCache attached, stored grids are looked up before being
+//   simulated, so pricers that differ only in basis or payoff share paths.
+//
+//   priceExtrapolated() prices on numExerciseDates and 2x, 4x ... as many
+//   dates, every grid read from one set of paths on the finest, and
+//   Richardson-extrapolates the O(dt) Bermudan error away.
+//
+//   fit() hands the fitted rule out as an ExercisePolicy, which can be
+//   saved, reloaded and applied to fresh paths by applyPolicy() without
+//   any regression.
+//
+//   Scratch buffers come from a PricingWorkspace arena. Attach one with
+//   setWorkspace() to keep it across calls: once warm, a single-threaded
+//   price() with at most kMaxFixedRegressors basis functions and no cache
+//   performs no heap allocation. Otherwise each call uses a fresh one.
+
+class LSMPricer {
+public:
+    LSMPricer(const LSMConfig& cfg,
+              std::unique_ptr<StochasticProcess> process,
+              std::unique_ptr<Payoff> payoff,
+              std::vector<std::unique_ptr<BasisFunction>> basis);
+
+    LSMPricer(const LSMConfig& cfg,
+              std::unique_ptr<StochasticProcess> process,
+              std::unique_ptr<Payoff> payoff,
+              BasisFamily basis);
+
+    SimulationResult price(double S0) const;
+
+    // One result per spot from a single path set. For scale-invariant
+    // processes the unit-spot grid is simulated once and each spot reads it
+    // scaled, so with double storage every entry equals price(spot) exactly.
+    // Other processes, and low-memory mode, fall back to one price() each.
+    std::vector<SimulationResult> priceLadder(const std::vector<double>& spots) const;
+
+    // Bermudan prices on numGrids nested grids of cfg.numExerciseDates x
+    // 1, 2, 4 ... dates (2 to 4 grids) and their Richardson limit. Only the
+    // finest grid is simulated: a coarser one is its every second, fourth
+    // ... date, the same Brownian path the finer grid refines by bridging,
+    // so the grids' errors are strongly correlated and the limit's standard
+    // error comes from per-path combinations of their cash flows. The
+    // finest grid's result equals price() with that many dates; the
+    // extrapolation assumes the Bermudan error expands in powers of dt.
+    // Needs a BasisFamily basis and the stored grid (std::logic_error).
+    ExtrapolatedResult priceExtrapolated(double S0, int numGrids = 3) const;
+
+    // Fit the exercise rule on paths from cfg.rngSeed, then value an
+    // independent path set drawn with outOfSampleSeed under that fixed rule.
+    std::pair<SimulationResult, SimulationResult>
+    priceInAndOutOfSample(double S0, std::uint64_t outOfSampleSeed) const;
+
+    // Fit the exercise rule on paths from cfg.rngSeed, then value batch b =
+    // 0, 1, ... of numPaths fresh paths drawn with seed firstSeed + b under
+    // that fixed rule, passing each batch's result to onBatch until it
+    // returns false. Returns the in-sample result.
+    using BatchCallback = std::function<bool(std::size_t batch, const SimulationResult&)>;
+    SimulationResult streamOutOfSample(double S0, std::uint64_t firstSeed,
+                                       const BatchCallback& onBatch) const;
+
+    // Fit the exercise rule on the cfg.rngSeed paths, as price() does, and
+    // hand it out; inSample gets the in-sample result when given. Needs a
+    // BasisFamily basis (std::logic_error otherwise), as a set of
+    // BasisFunction objects cannot be stored.
+    ExercisePolicy fit(double S0, SimulationResult* inSample = nullptr) const;
+
+    // Value numPaths paths drawn with seed under a fitted rule: one forward
+    // pass, no regressions. The policy must match this pricer's exercise
+    // dates, maturity, basis and strike scaling (std::invalid_argument).
+    SimulationResult applyPolicy(const ExercisePolicy& policy, double S0, std::uint64_t seed) const;
+
+    // the stored grid price() would use for S0 and seed (simulation only)
+    PathMatrix simulatePaths(double S0, std::uint64_t seed) const;
+
+    // share simulated grids through cache (nullptr detaches); not used in
+    // low-memory mode, which never holds a full grid
+    void setPathCache(std::shared_ptr<PathCache> cache) { cache_ = std::move(cache); }
+
+    // reuse ws for every call's scratch memory (nullptr detaches); calls
+    // through pricers sharing one workspace must not overlap
+    void setWorkspace(std::shared_ptr<PricingWorkspace> ws) { workspace_ = std::move(ws); }
+
+    // Exact European price as a function of spot, for cfg.useControlVariate
+    // (an empty function restores the default): needed for processes or
+    // payoffs without a built-in closed form. See analytic_prices.hpp.
+    using EuropeanPrice = std::function<double(double S0)>;
+    void setControlVariate(EuropeanPrice price) { control_ = std::move(price); }
+
+    const LSMConfig& config() const { return cfg_; }
+    int numBasis() const;
+
+    // bytes of one backward-sweep block record, as the workspace carves it
+    static std::size_t blockBytes();
+
+private:
+    // PortfolioPricer builds one pricer per contract around a process they
+    // all share, and prices each on a prefix of one grid
+    friend class PortfolioPricer;
+    // UpperBoundEstimator tests the fitted rule on nested inner paths
+    friend class UpperBoundEstimator;
+    // PricingScheduler builds one pricer per task around a shared process
+    friend class PricingScheduler;
+    // MLMCPricer fits a rule per date grid and values coupled path batches
+    friend class MLMCPricer;
+    struct SharedProcess {};
+    LSMPricer(SharedProcess, const LSMConfig& cfg,
+              std::shared_ptr<const StochasticProcess> process,
+              std::unique_ptr<Payoff> payoff, BasisFamily basis);
+    // base's contract, process, payoff and basis under another cfg: other
+    // date grids for priceExtrapolated() and MLMCPricer
+    LSMPricer(const LSMPricer& base, const LSMConfig& cfg);
+
+    // fit and value on dates 0 .. numExerciseDates of paths, which may run
+    // past this pricer's maturity on the same time step
+    SimulationResult priceOn(const PathMatrix& paths, double S0, PricingWorkspace& ws) const;
+
+    // per-date regression coefficients; empty where no regression was run
+    using Coefficients = std::vector<std::vector<double>>;
+
+    // Spots of paths [begin, end) at date k, as a view or copied into the
+    // scratch span (end - begin long). The sweep asks for dates D, D-1,
+    // ..., 1 in that order.
+    using DateReader = std::function<std::span<const double>(
+        int k, std::size_t begin, std::size_t end, std::span<double> scratch)>;
+
+    // the attached workspace, or local when there is none; reset either way
+    PricingWorkspace& workspace(PricingWorkspace& local) const;
+
+    // body(), with a PricingProfile of the call attached when cfg.profile
+    template <class Body>
+    SimulationResult profiled(PricingWorkspace& ws, Body&& body) const;
+
+    // Fill paths (count x (D + 1), time-major) with paths [first, first +
+    // count) at dates 0 .. D
+    void simulate(double S0, std::uint64_t seed, std::size_t first, std::size_t count,
+                  PathMatrix& paths, PricingWorkspace& ws) const;
+    void simulateSobol(double S0, std::uint64_t seed, std::size_t first, std::size_t count,
+                       PathMatrix& paths, PricingWorkspace& ws) const;
+
+    // body(local, n, buffer) for each tile of paths [local, local + n) of
+    // [0, count), with a per-worker buffer of rowsPerTile (default
+    // numDates) rows of kTilePaths
+    template <class Body>
+    void forTiles(std::size_t count, std::size_t numDates, PricingWorkspace& ws,
+                  Body&& body, std::size_t rowsPerTile = 0) const;
+
+    // the full grid for (S0, seed): from the cache when one is attached,
+    // else simulated into the workspace's grid storage
+    std::shared_ptr<const PathMatrix> grid(double S0, std::uint64_t seed,
+                                           PricingWorkspace& ws) const;
+
+    void fillDesign(std::span<const double> x, std::span<double> X) const;
+    // the same rounded to float; scratch holds x.size() doubles
+    void fillDesign(std::span<const double> x, std::span<float> X, std::span<double> scratch) const;
+
+    // Fit and value on the cfg.rngSeed paths, stored or regenerated. A
+    // horizon past numExerciseDates regenerates the first dates of paths
+    // simulated that many steps out, as priceOn() would see them.
+    SimulationResult fitAndPrice(double S0, Coefficients* fitted, PricingWorkspace& ws,
+                                 int horizon = 0) const;
+    // discounted, when not empty, gets each path's cash flow discounted to
+    // t = 0
+    SimulationResult backwardInduction(const DateReader& spotsAt, double S0,
+                                       Coefficients* fitted, PricingWorkspace& ws,
+                                       std::span<double> discounted = {}) const;
+
+    // value paths from seed under fixed coefficients, forward in time
+    SimulationResult valueUnderPolicy(double S0, std::uint64_t seed,
+                                      const Coefficients& coeffs, PricingWorkspace& ws) const;
+    // Rows of paths are dates firstDate .. D, and exercise is considered
+    // after firstDate; discounted gets each path's payoff discounted to
+    // t = 0. Returns the undiscounted sum of terminal payoffs.
+    double applyPolicy(const PathMatrix& paths, const Coefficients& coeffs,
+                       std::span<double> discounted, std::span<double> control,
+                       PricingWorkspace& ws, int firstDate = 0) const;
+
+    // Estimates from per-path discounted values; control (empty unless
+    // cfg.useControlVariate) holds each path's discounted European payoff
+    SimulationResult summarise(std::span<const double> discounted,
+                               std::span<const double> control,
+                               double europeanValue, double S0) const;
+    std::pair<double, double> meanAndStdError(std::span<const double> values) const;
+
+    // independent samples behind N per-path values, and the i-th of them
+    std::size_t numSamples(std::size_t N) const;
+    double sample(std::span<const double> values, std::size_t i) const;
+
+    // exact mean of the control: the supplied function, else the closed form
+    double europeanControl(double S0) const;
+    void addGreeks(double S0, std::span<const int> tau, std::span<const double> stopSpot,
+                   std::span<const double> spot1, SimulationResult& res,
+                   PricingWorkspace& ws) const;
+
+    LSMConfig cfg_;
+    std::shared_ptr<const StochasticProcess> process_;
+    std::shared_ptr<const Payoff> payoff_;
+    std::vector<std::unique_ptr<BasisFunction>> basis_;
+    std::optional<BasisFamily> family_;
+    std::shared_ptr<PathCache> cache_;
+    std::shared_ptr<PricingWorkspace> workspace_;
+    EuropeanPrice control_;
+};
+
+template <class Body>
+inline SimulationResult LSMPricer::profiled(PricingWorkspace& ws, Body&& body) const {
+    if (!LSM_PROFILING || !cfg_.profile) return body();
+
+    PricingProfile profile;
+    profile.numThreads = resolveThreadCount(cfg_.numThreads);
+    profile.itmPaths.assign(cfg_.numExerciseDates + 1, 0);
+    profile.conditionNumbers.assign(cfg_.numExerciseDates + 1, 0.0);
+    const std::size_t allocations = ws.heapAllocations();
+    struct Detach {
+        PricingWorkspace& ws;
+        ~Detach() { ws.setProfile(nullptr); }
+    } detach{ws};
+    ws.setProfile(&profile);
+    SimulationResult res;
+    {
+        StageTimer total(&profile.totalSeconds);
+        res = body();
+    }
+    profile.workspaceBytes = ws.bytesInUse();
+    profile.heapAllocations = ws.heapAllocations() - allocations;
+    res.profile = std::move(profile);
+    return res;
+}
+
+}
@@ -0,0 +1,161 @@
+#include "lsm_types.hpp"
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace lsm {
+
+// StochasticProcess
+void StochasticProcess::simulateBlock(double S0, double dt, const CounterRNG& rng,
+                                      std::uint64_t firstPathId, bool antithetic,
+                                      std::size_t count, std::span<double> out) const {
+    const std::size_t numDates = out.size() / count;
+    std::vector<double> path(numDates);
+    for (std::size_t i = 0; i < count; ++i) {
+        simulatePath(S0, dt, rng, firstPathId + i, antithetic, path);
+        for (std::size_t k = 0; k < numDates; ++k) out[k * count + i] = path[k];
+    }
+}
+
+bool StochasticProcess::simulateFromBrownian(double, double, std::size_t,
+                                             std::span<const double>, std::span<double>) const {
+    return false;
+}
+
+std::size_t StochasticProcess::backwardStateSize(std::size_t) const {
+    throw std::logic_error(name() + ": low-memory mode is not supported");
+}
+
+double StochasticProcess::beginBackward(double, double, std::size_t, const CounterRNG&,
+                                        std::uint64_t, bool, std::span<double>) const {
+    throw std::logic_error(name() + ": low-memory mode is not supported");
+}
+
+double StochasticProcess::stepBackward(double, std::size_t, const CounterRNG&,
+                                       std::uint64_t, bool, std::span<double>) const {
+    throw std::logic_error(name() + ": low-memory mode is not supported");
+}
+
+bool StochasticProcess::sensitivities(double, double, std::size_t, double, double,
+                                      const CounterRNG&, std::uint64_t, bool,
+                                      PathSensitivity&) const {
+    return false;
+}
+
+// Payoff
+void Payoff::evaluateBatch(std::span<const double> spots, std::span<double> out) const {
+    for (std::size_t i = 0; i < spots.size(); ++i) out[i] = evaluate(spots[i]);
+}
+
+double Payoff::derivative(double) const {
+    throw std::logic_error(name() + ": payoff derivative is not available");
+}
+
+// PathMatrix
+PathMatrix::PathMatrix()
+    : numPaths_(0), numDates_(0), rowStride_(0), precision_(PathPrecision::Double) {}
+
+PathMatrix::PathMatrix(std::size_t numPaths, std::size_t numDates, PathPrecision precision)
+    : numPaths_(numPaths), numDates_(numDates), rowStride_(0), precision_(precision) {
+    allocate();
+}
+
+PathMatrix::PathMatrix(const PathMatrix& other)
+    : numPaths_(other.numPaths_), numDates_(other.numDates_), rowStride_(0),
+      precision_(other.precision_) {
+    allocate();
+    // row by row: a view's stride may be wider than the one allocate() picks
+    const std::size_t rowBytes = numPaths_ * elementSize();
+    if (rowBytes == 0) return;
+    const std::size_t strideBytes = rowStride_ * elementSize();
+    for (std::size_t k = 0; k < numDates_; ++k) {
+        std::byte* row = data_.get() + k * strideBytes;
+        std::memcpy(row, other.data_.get() + k * other.rowStride_ * elementSize(), rowBytes);
+        std::memset(row + rowBytes, 0, strideBytes - rowBytes);
+    }
+}
+
+PathMatrix& PathMatrix::operator=(const PathMatrix& other) {
+    if (this != &other) {
+        PathMatrix copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+void PathMatrix::allocate() {
+    // pad each row to a whole number of cache lines
+    const std::size_t perLine = kAlignment / elementSize();
+    rowStride_ = (numPaths_ + perLine - 1) / perLine * perLine;
+    if (bytes() == 0) {
+        data_.reset();
+        return;
+    }
+    auto* raw = static_cast<std::byte*>(::operator new(bytes(), std::align_val_t{kAlignment}));
+    data_.reset(raw, AlignedDelete{});
+}
+
+PathMatrix PathMatrix::view(std::size_t numPaths, std::size_t numDates, std::size_t rowStride,
+                            PathPrecision precision, const std::byte* data,
+                            std::shared_ptr<const void> owner) {
+    PathMatrix m;
+    m.numPaths_ = numPaths;
+    m.numDates_ = numDates;
+    m.precision_ = precision;
+    m.rowStride_ = rowStride;
+    if (rowStride < numPaths || rowStride * m.elementSize() % kAlignment != 0 ||
+        reinterpret_cast<std::uintptr_t>(data) % kAlignment != 0) {
+        throw std::invalid_argument("PathMatrix::view: rows must be aligned whole cache lines");
+    }
+    // the view is never written through: spots are only read from it
+    m.data_ = std::shared_ptr<std::byte>(std::const_pointer_cast<void>(std::move(owner)),
+                                         const_cast<std::byte*>(data));
+    return m;
+}
+
+void PathMatrix::AlignedDelete::operator()(std::byte* p) const {
+    ::operator delete(p, std::align_val_t{kAlignment});
+}
+
+std::span<const double> PathMatrix::readDate(std::size_t date, std::size_t begin, std::size_t end,
+                                             std::vector<double>& scratch) const {
+    if (precision_ == PathPrecision::Double) {
+        return {doubleRow(date) + begin, end - begin};
+    }
+    scratch.resize(end - begin);
+    return readDate(date, begin, end, std::span<double>(scratch));
+}
+
+std::span<const double> PathMatrix::readDate(std::size_t date, std::size_t begin, std::size_t end,
+                                             std::span<double> scratch) const {
+    if (precision_ == PathPrecision::Double) {
+        return {doubleRow(date) + begin, end - begin};
+    }
+    const float* row = floatRow(date) + begin;
+    for (std::size_t i = 0; i < end - begin; ++i) scratch[i] = row[i];
+    return {scratch.data(), end - begin};
+}
+
+void PathMatrix::storeBlock(std::size_t first, std::size_t count, const double* block) {
+    for (std::size_t k = 0; k < numDates_; ++k) {
+        const double* src = block + k * count;
+        if (precision_ == PathPrecision::Double) {
+            std::memcpy(doubleRow(k) + first, src, count * sizeof(double));
+        } else {
+            float* row = floatRow(k) + first;
+            for (std::size_t i = 0; i < count; ++i) row[i] = static_cast<float>(src[i]);
+        }
+    }
+}
+
+// BasisFunction
+void BasisFunction::evaluateBatch(std::span<const double> x, std::span<double> out) const {
+    if (out.size() < x.size()) {
+        throw std::invalid_argument("evaluateBatch: output span too small");
+    }
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        out[i] = evaluate(x[i]);
+    }
+}
+
+}
@@ -1,5 +1,241 @@
+#pragma once
 
+#include "pricing_profile.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
 
+namespace lsm {
+
+class CounterRNG;
+
+// storage type for simulated spots
+enum class PathPrecision { Double, Float };
+
+// how the driving normals are drawn: Philox streams, or scrambled Sobol
+// points through a Brownian bridge (randomised QMC, GBM-type processes)
+enum class SamplingScheme { PseudoRandom, Sobol };
+
+//  LSMConfig  
+// - simulation / time-grid settings shared by every pricer
+
+struct LSMConfig {
+    int numPaths = 10000;
+    int numExerciseDates = 50;      // equally spaced on (0, T]
+    double maturity = 1.0;
+    double riskFreeRate = 0.06;
+    bool useAntithetic = false;     // second half of the paths mirrors the first
+    std::uint64_t rngSeed = 42;
+    int numThreads = 1;             // 0 = use every hardware thread
+    PathPrecision pathPrecision = PathPrecision::Double;   // Float halves path memory
+    PathPrecision basisPrecision = PathPrecision::Double;  // Float: design matrix in float, sums in double
+    bool lowMemory = false;         // regenerate paths backward, O(N) memory
+    bool computeGreeks = false;     // delta, gamma, vega in the same pass
+    SamplingScheme samplingScheme = SamplingScheme::PseudoRandom;
+    int qmcReplicates = 8;          // Sobol: independent scramblings, numPaths / replicates each
+    bool useControlVariate = false; // regress on the discounted European payoff
+    bool profile = false;           // attach a PricingProfile (needs LSM_PROFILING)
+};
+
+//  SimulationResult  
+// - what a single pricing run reports
+
+struct SimulationResult {
+    double optionValue = 0.0;
+    double europeanValue = 0.0;
+    double earlyExercisePremium = 0.0;
+    double standardError = 0.0;
+    double controlCoefficient = 0.0;    // fitted b, when LSMConfig::useControlVariate
+
+    // filled when LSMConfig::computeGreeks is set (in-sample estimates):
+    // pathwise delta and vega, likelihood-ratio / pathwise gamma
+    double delta = 0.0;
+    double gamma = 0.0;
+    double vega = 0.0;
+    double deltaStdError = 0.0;
+    double gammaStdError = 0.0;
+    double vegaStdError = 0.0;
+
+    // when LSMConfig::profile is set and profiling is compiled in
+    std::optional<PricingProfile> profile;
+};
+
+//  PathSensitivity  
+// - derivatives of one simulated spot S_k with respect to the model inputs,
+//   used for pathwise / likelihood-ratio Greeks
+
+struct PathSensitivity {
+    double dS_dS0 = 0.0;        // dS_k / dS0
+    double dS_dSigma = 0.0;     // dS_k / dsigma
+    double score = 0.0;         // d log p(S_1 | S0) / dS0, first-step LR weight
+};
+
+//  PathMatrix  
+// - simulated spots stored time-major: the values of every path at one date
+//   are contiguous, and each date row starts on a 64-byte boundary, so the
+//   backward sweep reads a date as one streaming access. Rows hold doubles
+//   or floats; the normal equations are always accumulated in double.
+
+class PathMatrix {
+public:
+    static constexpr std::size_t kAlignment = 64;
+
+    PathMatrix();
+    PathMatrix(std::size_t numPaths, std::size_t numDates,
+               PathPrecision precision = PathPrecision::Double);
+    PathMatrix(const PathMatrix& other);
+    PathMatrix& operator=(const PathMatrix& other);
+    PathMatrix(PathMatrix&&) noexcept = default;
+    PathMatrix& operator=(PathMatrix&&) noexcept = default;
+
+    // Read-only view of numDates rows of rowStride elements at data, which
+    // owner keeps alive (a mapped PathFile, say): data must be kAlignment-
+    // aligned and rows a whole number of cache lines. Copies are owned.
+    static PathMatrix view(std::size_t numPaths, std::size_t numDates, std::size_t rowStride,
+                           PathPrecision precision, const std::byte* data,
+                           std::shared_ptr<const void> owner);
+
+    std::size_t numPaths() const { return numPaths_; }
+    std::size_t numDates() const { return numDates_; }          // including t = 0
+    PathPrecision precision() const { return precision_; }
+    std::size_t rowStride() const { return rowStride_; }        // elements, >= numPaths
+    std::size_t bytes() const { return numDates_ * rowStride_ * elementSize(); }
+
+    double get(std::size_t date, std::size_t path) const {
+        return precision_ == PathPrecision::Double
+                   ? doubleRow(date)[path]
+                   : static_cast<double>(floatRow(date)[path]);
+    }
+    void set(std::size_t date, std::size_t path, double S) {
+        if (precision_ == PathPrecision::Double) doubleRow(date)[path] = S;
+        else floatRow(date)[path] = static_cast<float>(S);
+    }
+
+    // raw rows; only valid for the matching precision
+    double* doubleRow(std::size_t date) {
+        return reinterpret_cast<double*>(data_.get()) + date * rowStride_;
+    }
+    const double* doubleRow(std::size_t date) const {
+        return reinterpret_cast<const double*>(data_.get()) + date * rowStride_;
+    }
+    float* floatRow(std::size_t date) {
+        return reinterpret_cast<float*>(data_.get()) + date * rowStride_;
+    }
+    const float* floatRow(std::size_t date) const {
+        return reinterpret_cast<const float*>(data_.get()) + date * rowStride_;
+    }
+
+    // Spots of paths [begin, end) at one date as doubles: a view straight
+    // into the row for double storage, widened into scratch for float.
+    std::span<const double> readDate(std::size_t date, std::size_t begin, std::size_t end,
+                                     std::vector<double>& scratch) const;
+    // same with caller-owned scratch of at least end - begin elements
+    std::span<const double> readDate(std::size_t date, std::size_t begin, std::size_t end,
+                                     std::span<double> scratch) const;
+
+    // Write a date-major block: block[k * count + i] is path (first + i)
+    // at date k, for count paths.
+    void storeBlock(std::size_t first, std::size_t count, const double* block);
+
+private:
+    struct AlignedDelete {
+        void operator()(std::byte* p) const;
+    };
+
+    std::size_t elementSize() const {
+        return precision_ == PathPrecision::Double ? sizeof(double) : sizeof(float);
+    }
+    void allocate();
+
+    std::size_t numPaths_;
+    std::size_t numDates_;
+    std::size_t rowStride_;
+    PathPrecision precision_;
+    std::shared_ptr<std::byte> data_;       // owned, or aliasing a view's owner
+};
+
+//  StochasticProcess  
+// — Abstract: strategy for simulating the underlying
+
+class StochasticProcess {
+public:
+    virtual ~StochasticProcess() {}
+
+    // Fill out[k] = S(k * dt) for k = 0 .. out.size()-1, with out[0] = S0.
+    // Every random draw is taken from rng at (pathId, step), so a path is a
+    // pure function of (seed, pathId) and can be generated on any thread.
+    // antithetic = true negates the Gaussian draws of the same pathId.
+    virtual void simulatePath(double S0, double dt, const CounterRNG& rng,
+                              std::uint64_t pathId, bool antithetic,
+                              std::span<double> out) const = 0;
+
+    // Simulate `count` consecutive paths firstPathId, firstPathId+1, ...
+    // (all with the same antithetic flag) into a date-major block:
+    // out[k * count + i] is date k of path firstPathId + i, and out.size()
+    // is count * numDates. Must match simulatePath bit for bit. The default
+    // runs simulatePath per path; GBM and jump-diffusion step the whole
+    // block one date at a time through the SIMD kernels.
+    virtual void simulateBlock(double S0, double dt, const CounterRNG& rng,
+                               std::uint64_t firstPathId, bool antithetic,
+                               std::size_t count, std::span<double> out) const;
+
+    // The same block driven by a given Brownian motion, for quasi-Monte
+    // Carlo input: W[(k - 1) * count + i] is W at date k for path i. Returns
+    // false when the process needs randomness beyond one Brownian motion,
+    // which is the default.
+    virtual bool simulateFromBrownian(double S0, double dt, std::size_t count,
+                                      std::span<const double> W, std::span<double> out) const;
+
+    // Low-memory mode: regenerate one path's spots backward in time from a
+    // small per-path state instead of storing the grid. beginBackward sets
+    // the state up and returns S at date numSteps; each stepBackward(k), for
+    // k = numSteps-1 down to 1 in turn, returns S at date k. The values must
+    // match simulatePath bit for bit. The defaults throw std::logic_error.
+    virtual std::size_t backwardStateSize(std::size_t numSteps) const;
+    virtual double beginBackward(double S0, double dt, std::size_t numSteps,
+                                 const CounterRNG& rng, std::uint64_t pathId,
+                                 bool antithetic, std::span<double> state) const;
+    virtual double stepBackward(double dt, std::size_t k, const CounterRNG& rng,
+                                std::uint64_t pathId, bool antithetic,
+                                std::span<double> state) const;
+
+    // Sensitivities of spot Sk at date k of path pathId, where S1 is the
+    // same path at date 1. Returns false when the process cannot supply them.
+    virtual bool sensitivities(double S0, double dt, std::size_t k, double Sk, double S1,
+                               const CounterRNG& rng, std::uint64_t pathId, bool antithetic,
+                               PathSensitivity& out) const;
+
+    // true when a path started at S0 is exactly S0 times the same path
+    // started at 1, so one unit grid serves every spot
+    virtual bool isScaleInvariant() const { return false; }
+
+    // Every parameter the paths depend on, encoded exactly; two processes
+    // with equal keys must simulate identical paths. Empty = do not cache.
+    virtual std::string cacheKey() const { return {}; }
+
+    virtual std::string name() const = 0;
+};
+
+//  Payoff  
+// — Abstract: strategy for the exercise value
+
+class Payoff {
+public:
+    virtual ~Payoff() {}
+    virtual double evaluate(double spot) const = 0;
+    // out[i] = evaluate(spots[i]); must match it bit for bit. The default
+    // loops over evaluate(); puts and calls run one branch-free pass.
+    virtual void evaluateBatch(std::span<const double> spots, std::span<double> out) const;
+    virtual double strike() const = 0;          // also used to scale regressors
+    virtual std::string name() const = 0;
+
+    // dh/dS, for pathwise Greeks; the default reports unsupported
+    virtual double derivative(double spot) const;
+};
 
 //  BasisFunction  
 // — Abstract: strategy for regression basis
@@ -9,4 +245,10 @@ public:
     virtual ~BasisFunction() {}
     virtual double evaluate(double x) const = 0;
     virtual std::string name() const = 0;
-};
\ No newline at end of file
+
+    // Batch form: out[i] = evaluate(x[i]) for every i. Fills one design-matrix
+    // column per call; the default falls back to per-point evaluate().
+    virtual void evaluateBatch(std::span<const double> x, std::span<double> out) const;
+};
+
+}
@@ -22,7 +22,10 @@
 #include "payoffs.hpp"
 #include "basis_functions.hpp"
 #include "lsm_pricer.hpp"
+#include "multi_asset_pricer.hpp"
+#include "pricing_scheduler.hpp"
 #include "convergence_analyzer.hpp"
+#include "upper_bound_estimator.hpp"
 
 using namespace lsm;
 
@@ -49,7 +52,8 @@ static void printResult(const std::string& label, double spot,
 //  Build a standard put pricer
 // ---------------------------------------------------------------------------
 static LSMPricer makePutPricer(double K, double r, double sigma,
-                                double T, int N, int dates, int seed = 42)
+                                double T, int N, int dates, int seed = 42,
+                                int threads = 1)
 {
     LSMConfig cfg;
     cfg.numPaths         = N;
@@ -58,6 +62,7 @@ static LSMPricer makePutPricer(double K, double r, double sigma,
     cfg.maturity         = T;
     cfg.riskFreeRate     = r;
     cfg.rngSeed          = seed;
+    cfg.numThreads       = threads;
 
     return LSMPricer(cfg,
                      std::make_unique<GeometricBrownianMotion>(r, sigma),
@@ -82,9 +87,13 @@ int main()
               << std::setw(30) << "Case"
               << "  Spot    Am       Eu       EEP      SE\n";
     separator();
-    for (double S : {36.0, 38.0, 40.0, 42.0, 44.0}) {
-        auto p = makePutPricer(40, 0.06, 0.20, 1.0, 10000, 50);
-        printResult("AmericanPut", S, p.price(S));
+    {
+        // one path set shared by every spot
+        std::vector<double> spots = {36.0, 38.0, 40.0, 42.0, 44.0};
+        auto p      = makePutPricer(40, 0.06, 0.20, 1.0, 10000, 50);
+        auto ladder = p.priceLadder(spots);
+        for (std::size_t i = 0; i < spots.size(); ++i)
+            printResult("AmericanPut", spots[i], ladder[i]);
     }
 
     // =========================================================================
@@ -169,6 +178,18 @@ int main()
                       << std::setw(12) << val
                       << std::setw(12) << se << "\n";
         }
+
+        // how loose the bound is: Andersen-Broadie dual for the M=3 rule,
+        // its nested simulation on every core
+        auto pricer = makePutPricer(40.0, 0.06, 0.20, 1.0, 10000, 50, 42, 0);
+        UpperBoundConfig ub;
+        ub.numOuterPaths = 500;
+        ub.numInnerPaths = 200;
+        auto bound = UpperBoundEstimator(pricer, ub).estimate(40.0);
+        std::cout << "  M=3 rule: lower " << bound.lowerBound << " (" << bound.lowerStdError << ")"
+                  << "  upper " << bound.upperBound << " (" << bound.upperStdError << ")\n"
+                  << "  duality gap " << bound.dualityGap << " (" << bound.gapStdError << ")"
+                  << "  95% CI [" << bound.confidenceLow << ", " << bound.confidenceHigh << "]\n";
     }
 
     // =========================================================================
@@ -198,6 +219,65 @@ int main()
                       << std::setw(14) << se * std::sqrt(static_cast<double>(N)) << "\n";
         }
     }
+    std::cout << "\n    Sobol + Brownian bridge, 8 scrambled replicates\n";
+    std::cout << "    (SE * sqrt(N) well below the pseudo-random column, i.e. fewer paths per error)\n";
+    separator();
+    {
+        LSMConfig cfg;
+        cfg.numExerciseDates = 50; cfg.maturity = 1.0;
+        cfg.riskFreeRate = 0.06;   cfg.rngSeed = 42;
+        cfg.samplingScheme = SamplingScheme::Sobol;
+        cfg.qmcReplicates = 8;
+
+        std::vector<int> Ns = {512, 1024, 2048, 4096, 8192, 16384};
+        auto rows = ConvergenceAnalyzer::analyzeByPathCount(cfg, 40.0, 40.0, 0.20, Ns);
+        for (auto& [N, val, se] : rows) {
+            std::cout << std::fixed << std::setprecision(4)
+                      << std::setw(10) << N
+                      << std::setw(12) << val
+                      << std::setw(12) << se
+                      << std::setw(14) << se * std::sqrt(static_cast<double>(N)) << "\n";
+        }
+    }
+    std::cout << "\n    European control variate (Black-Scholes mean), pseudo-random paths\n";
+    separator();
+    {
+        LSMConfig cfg;
+        cfg.numExerciseDates = 50; cfg.maturity = 1.0;
+        cfg.riskFreeRate = 0.06;   cfg.rngSeed = 42;
+        cfg.useControlVariate = true;
+
+        std::vector<int> Ns = {500, 1000, 2000, 5000, 10000, 20000};
+        auto rows = ConvergenceAnalyzer::analyzeByPathCount(cfg, 40.0, 40.0, 0.20, Ns);
+        for (auto& [N, val, se] : rows) {
+            std::cout << std::fixed << std::setprecision(4)
+                      << std::setw(10) << N
+                      << std::setw(12) << val
+                      << std::setw(12) << se
+                      << std::setw(14) << se * std::sqrt(static_cast<double>(N)) << "\n";
+        }
+    }
+    std::cout << "\n    Adaptive: one fitted rule, batches of 2,000 fresh paths until SE <= 0.005\n";
+    separator();
+    {
+        LSMConfig cfg;
+        cfg.numPaths = 2000;       cfg.numExerciseDates = 50;
+        cfg.maturity = 1.0;        cfg.riskFreeRate = 0.06;   cfg.rngSeed = 42;
+
+        auto run = ConvergenceAnalyzer::analyzeAdaptive(cfg, 40.0, 40.0, 0.20, 0.005, 30.0);
+        for (std::size_t i = 0; i < run.checkpoints.size(); ++i) {
+            // checkpoints 1, 2, 4, 8, ... and the last
+            if ((i + 1) & i && i + 1 != run.checkpoints.size()) continue;
+            const auto& cp = run.checkpoints[i];
+            std::cout << std::fixed << std::setprecision(4)
+                      << std::setw(10) << cp.numPaths
+                      << std::setw(12) << cp.value
+                      << std::setw(12) << cp.standardError
+                      << std::setw(14) << cp.standardError * std::sqrt(static_cast<double>(cp.numPaths)) << "\n";
+        }
+        std::cout << "    " << (run.converged ? "reached" : "missed") << " the target after "
+                  << run.checkpoints.size() << " batches\n";
+    }
 
     // =========================================================================
     //  8. Out-of-sample stability
@@ -245,47 +325,153 @@ int main()
               << std::setw(10) << "SE" << "\n";
     separator();
 
-    // {spot, sigma, T, finite-difference reference value}
-    struct BenchCase { double S, sigma, T, fdRef; };
-    std::vector<BenchCase> cases = {
-        {36, 0.20, 1.0, 4.478},
-        {36, 0.20, 2.0, 4.840},
-        {36, 0.40, 1.0, 7.101},
-        {36, 0.40, 2.0, 8.508},
-        {38, 0.20, 1.0, 3.250},
-        {38, 0.20, 2.0, 3.745},
-        {38, 0.40, 1.0, 6.148},
-        {38, 0.40, 2.0, 7.670},
-        {40, 0.20, 1.0, 2.314},
-        {40, 0.20, 2.0, 2.885},
-        {40, 0.40, 1.0, 5.312},
-        {40, 0.40, 2.0, 6.920},
-        {42, 0.20, 1.0, 1.617},
-        {42, 0.20, 2.0, 2.212},
-        {42, 0.40, 1.0, 4.582},
-        {42, 0.40, 2.0, 6.248},
-        {44, 0.20, 1.0, 1.110},
-        {44, 0.20, 2.0, 1.690},
-        {44, 0.40, 1.0, 3.948},
-        {44, 0.40, 2.0, 5.647},
-    };
-
+    // the 20 cases are independent: price them together on the scheduler
+    const auto& cases = ConvergenceAnalyzer::longstaffSchwartzTable1();
+    std::vector<PricingTask> tasks;
     for (auto& c : cases) {
-        int dates = static_cast<int>(50 * c.T);
-        auto p    = makePutPricer(40.0, 0.06, c.sigma, c.T, 20000, dates);
-        auto res  = p.price(c.S);
-        double diff = res.optionValue - c.fdRef;
+        LSMConfig cfg;
+        cfg.numPaths         = 20000;
+        cfg.numExerciseDates = static_cast<int>(50 * c.maturity);
+        cfg.maturity         = c.maturity;
+        cfg.riskFreeRate     = 0.06;
+        tasks.push_back({cfg, std::make_shared<const GeometricBrownianMotion>(0.06, c.sigma),
+                         std::make_unique<PutPayoff>(40.0), BasisFamily(BasisFamilyType::Laguerre, 3), c.S0});
+    }
+    const auto table = PricingScheduler().run(std::move(tasks));
+    for (std::size_t i = 0; i < cases.size(); ++i) {
+        const auto& c   = cases[i];
+        const auto& res = table[i];
+        double diff = res.optionValue - c.reference;
 
         std::cout << std::fixed << std::setprecision(3)
-                  << std::setw(6)  << c.S
+                  << std::setw(6)  << c.S0
                   << std::setw(7)  << c.sigma
-                  << std::setw(6)  << c.T
+                  << std::setw(6)  << c.maturity
                   << std::setw(10) << res.optionValue
-                  << std::setw(10) << c.fdRef
+                  << std::setw(10) << c.reference
                   << std::setw(10) << diff
                   << std::setw(10) << res.standardError << "\n";
     }
 
+    // =========================================================================
+    // 10. Mixed precision — float paths and design matrix, double sums
+    //     The Table 1 cases again, each priced all-double and mixed on the
+    //     same paths; a case passes within 0.25 standard errors
+    // =========================================================================
+    std::cout << "\n[10] Mixed Precision Validation  (L&S 2001 Table 1 cases)\n";
+    std::cout << "     K=40  r=6%  N=20,000  tolerance 0.25 SE\n";
+    separator();
+    std::cout << std::setw(6)  << "S"
+              << std::setw(7)  << "sigma"
+              << std::setw(6)  << "T"
+              << std::setw(10) << "Double"
+              << std::setw(10) << "Mixed"
+              << std::setw(10) << "|d|/SE"
+              << std::setw(8)  << "Pass" << "\n";
+    separator();
+    {
+        LSMConfig cfg;
+        cfg.numPaths     = 20000;
+        cfg.riskFreeRate = 0.06;
+        cfg.numThreads   = 0;
+        int passed = 0;
+        for (const auto& check : ConvergenceAnalyzer::validateMixedPrecision(cfg, cases)) {
+            passed += check.passed;
+            std::cout << std::fixed << std::setprecision(3)
+                      << std::setw(6)  << check.benchmark.S0
+                      << std::setw(7)  << check.benchmark.sigma
+                      << std::setw(6)  << check.benchmark.maturity
+                      << std::setw(10) << check.doubleValue
+                      << std::setw(10) << check.mixedValue
+                      << std::setw(10) << check.deviation
+                      << std::setw(8)  << (check.passed ? "yes" : "NO") << "\n";
+        }
+        std::cout << "  " << passed << " / " << cases.size() << " within tolerance\n";
+    }
+
+    // =========================================================================
+    // 11. Multi-asset max-call — Broadie & Glasserman (1997) / Andersen &
+    //     Broadie (2004): d independent GBMs, sigma=20%, q=10%, r=5%, K=100,
+    //     T=3, 9 exercise dates; total-degree Laguerre(3) products of S_a/K
+    // =========================================================================
+    std::cout << "\n[11] Max-Call on d Assets  (Broadie-Glasserman, Andersen-Broadie 2004)\n";
+    std::cout << "     K=100  r=5%  q=10%  sigma=20%  rho=0  T=3  9 dates  N=100,000\n";
+    separator();
+    std::cout << std::setw(4)  << "d"
+              << std::setw(8)  << "S"
+              << std::setw(10) << "LSM"
+              << std::setw(10) << "Ref."
+              << std::setw(10) << "Diff"
+              << std::setw(10) << "Std.Err" << "\n";
+    separator();
+    {
+        struct MaxCallCase { int d; double S0, reference; };
+        const MaxCallCase maxCalls[] = {{2, 90.0, 8.08}, {2, 100.0, 13.90}, {2, 110.0, 21.34},
+                                        {5, 90.0, 16.64}, {5, 100.0, 26.16}, {5, 110.0, 36.78}};
+        LSMConfig cfg;
+        cfg.numPaths         = 100000;
+        cfg.numExerciseDates = 9;
+        cfg.maturity         = 3.0;
+        cfg.riskFreeRate     = 0.05;
+        cfg.numThreads       = 0;
+        for (const auto& c : maxCalls) {
+            MultiAssetLSMPricer p(cfg,
+                                  std::make_unique<CorrelatedGBM>(0.05, std::vector<double>(c.d, 0.2),
+                                                                  CorrelatedGBM::uniformCorrelation(c.d, 0.0),
+                                                                  std::vector<double>(c.d, 0.1)),
+                                  std::make_unique<MaxCallPayoff>(c.d, 100.0),
+                                  MultivariateBasis(BasisFamily(BasisFamilyType::Laguerre, 3), c.d));
+            const auto res = p.price(std::vector<double>(c.d, c.S0));
+            std::cout << std::fixed << std::setprecision(4)
+                      << std::setw(4)  << c.d
+                      << std::setw(8)  << std::setprecision(1) << c.S0 << std::setprecision(4)
+                      << std::setw(10) << res.optionValue
+                      << std::setw(10) << c.reference
+                      << std::setw(10) << res.optionValue - c.reference
+                      << std::setw(10) << res.standardError << "\n";
+        }
+    }
+
+    // =========================================================================
+    // 12. American limit — Bermudan prices on 25, 50 and 100 dates per year
+    //     read from one set of 100-date paths, Richardson-extrapolated to
+    //     continuous exercise; Err combines Monte Carlo and the remaining
+    //     discretisation error
+    // =========================================================================
+    std::cout << "\n[12] American Limit by Richardson Extrapolation  (sigma=20%, T=1)\n";
+    std::cout << "     K=40  r=6%  N=100,000 antithetic  25 / 50 / 100 dates\n";
+    separator();
+    std::cout << std::right
+              << std::setw(6)  << "S"
+              << std::setw(9)  << "D=25"
+              << std::setw(9)  << "D=50"
+              << std::setw(9)  << "D=100"
+              << std::setw(9)  << "Limit"
+              << std::setw(9)  << "FD Ref"
+              << std::setw(9)  << "Diff"
+              << std::setw(9)  << "Err" << "\n";
+    separator();
+    {
+        LSMConfig cfg;
+        cfg.numPaths         = 100000;
+        cfg.numExerciseDates = 25;
+        cfg.riskFreeRate     = 0.06;
+        cfg.useAntithetic    = true;
+        cfg.numThreads       = 0;
+        for (const auto& c : cases) {
+            if (c.sigma != 0.2 || c.maturity != 1.0) continue;
+            LSMPricer p(cfg, std::make_unique<GeometricBrownianMotion>(0.06, c.sigma),
+                        std::make_unique<PutPayoff>(40.0), BasisFamily(BasisFamilyType::Laguerre, 3));
+            const auto res = p.priceExtrapolated(c.S0, 3);
+            std::cout << std::fixed << std::setprecision(3) << std::setw(6) << c.S0;
+            for (const auto& g : res.grids) std::cout << std::setw(9) << g.optionValue;
+            std::cout << std::setw(9) << res.americanValue
+                      << std::setw(9) << c.reference
+                      << std::setw(9) << res.americanValue - c.reference
+                      << std::setw(9) << res.totalError << "\n";
+        }
+    }
+
     separator('=');
     std::cout << "Done.\n\n";
     return 0;
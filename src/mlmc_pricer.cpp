@@ -0,0 +1,188 @@
+#include "mlmc_pricer.hpp"
+#include "parallel.hpp"
+#include "pricing_workspace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace lsm {
+
+namespace {
+
+// separates the batch streams of consecutive levels
+constexpr std::uint64_t kLevelSeedStride = 0x9E3779B97F4A7C15ull;
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+// MLMCPricer
+MLMCPricer::MLMCPricer(const LSMConfig& cfg,
+                       std::unique_ptr<StochasticProcess> process,
+                       std::unique_ptr<Payoff> payoff,
+                       BasisFamily basis,
+                       MLMCConfig mlmc)
+    : base_(cfg, std::move(process), std::move(payoff), basis), mlmc_(mlmc) {
+    if (!(mlmc_.targetRMSE > 0.0) || mlmc_.minLevels < 1 || mlmc_.maxLevels < mlmc_.minLevels ||
+        mlmc_.initialSamples < 2) {
+        throw std::invalid_argument("MLMCConfig: need targetRMSE > 0, 1 <= minLevels <= maxLevels "
+                                    "and initialSamples >= 2");
+    }
+    if (cfg.numExerciseDates > (1 << 20) >> (mlmc_.maxLevels - 1)) {
+        throw std::invalid_argument("MLMCConfig: too many exercise dates on the finest level");
+    }
+    if (cfg.lowMemory || cfg.samplingScheme != SamplingScheme::PseudoRandom || cfg.useControlVariate ||
+        cfg.computeGreeks) {
+        throw std::logic_error("MLMCPricer: supports neither low-memory mode, Sobol sampling, "
+                               "the control variate nor Greeks");
+    }
+}
+
+MLMCResult MLMCPricer::price(double S0) const {
+    const LSMConfig& cfg = base_.config();
+    const std::size_t B = kBlockPaths;
+    const std::size_t perBatch = cfg.useAntithetic ? B / 2 : B;
+
+    // per level: rule l on D_l dates, a batch pricer on that grid and the
+    // running sums of its samples
+    struct Level {
+        LSMPricer batch;
+        LSMPricer::Coefficients coeffs;
+        std::size_t batches = 0;
+        double sum = 0.0, sumSq = 0.0;
+        MLMCLevel stats;
+    };
+    std::vector<Level> levels;
+    auto addLevel = [&]() {
+        const int l = static_cast<int>(levels.size());
+        LSMConfig grid = cfg;
+        grid.numExerciseDates = cfg.numExerciseDates << l;
+        grid.profile = false;
+        const auto start = std::chrono::steady_clock::now();
+        LSMPricer::Coefficients coeffs;
+        {
+            PricingWorkspace ws;
+            LSMPricer(base_, grid).fitAndPrice(S0, &coeffs, ws);
+        }
+        LSMConfig batchCfg = grid;
+        batchCfg.numPaths = static_cast<int>(B);
+        batchCfg.numThreads = 1;
+        levels.push_back({LSMPricer(base_, batchCfg), std::move(coeffs), 0, 0.0, 0.0, MLMCLevel{}});
+        MLMCLevel& stats = levels.back().stats;
+        stats.numExerciseDates = grid.numExerciseDates;
+        stats.costPerPath = grid.numExerciseDates + (l > 0 ? grid.numExerciseDates / 2 : 0);
+        stats.fitSeconds = secondsSince(start);
+    };
+
+    // batches [first, first + count) of level l, spread over the threads and
+    // added in batch order
+    auto sampleLevel = [&](std::size_t l, std::size_t count) {
+        Level& lv = levels[l];
+        const std::size_t first = lv.batches;
+        const std::uint64_t seed = mlmc_.seed + kLevelSeedStride * l;
+        const int D = lv.stats.numExerciseDates;
+        std::vector<double> sums(count), sumSqs(count);
+        const auto start = std::chrono::steady_clock::now();
+        parallelFor(count, cfg.numThreads, [&](std::size_t lo, std::size_t hi) {
+            PricingWorkspace ws;
+            for (std::size_t c = lo; c < hi; ++c) {
+                ws.reset();
+                PathMatrix& paths = ws.gridStorage(B, D + 1, cfg.pathPrecision);
+                lv.batch.simulate(S0, seed + first + c, 0, B, paths, ws);
+                const auto y = ws.allocate<double>(B);
+                lv.batch.applyPolicy(paths, lv.coeffs, y, {}, ws);
+                if (l > 0) {
+                    // the coarse grid: every second row of the same paths
+                    const Level& coarse = levels[l - 1];
+                    const auto* rows = cfg.pathPrecision == PathPrecision::Double
+                                           ? reinterpret_cast<const std::byte*>(paths.doubleRow(0))
+                                           : reinterpret_cast<const std::byte*>(paths.floatRow(0));
+                    const auto view = PathMatrix::view(B, D / 2 + 1, 2 * paths.rowStride(),
+                                                       cfg.pathPrecision, rows, nullptr);
+                    const auto yc = ws.allocate<double>(B);
+                    coarse.batch.applyPolicy(view, coarse.coeffs, yc, {}, ws);
+                    for (std::size_t p = 0; p < B; ++p) y[p] -= yc[p];
+                }
+                double s = 0.0, ss = 0.0;
+                for (std::size_t i = 0; i < perBatch; ++i) {
+                    const double v = lv.batch.sample(y, i);
+                    s += v;
+                    ss += v * v;
+                }
+                sums[c] = s;
+                sumSqs[c] = ss;
+            }
+        });
+        for (std::size_t c = 0; c < count; ++c) {
+            lv.sum += sums[c];
+            lv.sumSq += sumSqs[c];
+        }
+        lv.batches += count;
+        lv.stats.samples = lv.batches * perBatch;
+        lv.stats.sampleSeconds += secondsSince(start);
+        const double n = static_cast<double>(lv.stats.samples);
+        lv.stats.mean = lv.sum / n;
+        lv.stats.variance = std::max(0.0, (lv.sumSq - n * lv.stats.mean * lv.stats.mean) / (n - 1.0));
+    };
+    auto batchesFor = [&](double samples) {
+        return static_cast<std::size_t>(std::ceil(samples / static_cast<double>(perBatch)));
+    };
+
+    const double eps2 = mlmc_.targetRMSE * mlmc_.targetRMSE;
+    std::vector<std::size_t> extra;
+    for (int l = 0; l < mlmc_.minLevels; ++l) {
+        addLevel();
+        extra.push_back(batchesFor(static_cast<double>(mlmc_.initialSamples)));
+    }
+    MLMCResult res;
+    for (;;) {
+        for (std::size_t l = 0; l < levels.size(); ++l) {
+            if (extra[l] > 0) sampleLevel(l, extra[l]);
+        }
+
+        // N_l = 2 / eps^2 sqrt(V_l / C_l) sum_k sqrt(V_k C_k)
+        double budget = 0.0;
+        for (const auto& lv : levels) budget += std::sqrt(lv.stats.variance * lv.stats.costPerPath);
+        bool more = false;
+        for (std::size_t l = 0; l < levels.size(); ++l) {
+            const MLMCLevel& st = levels[l].stats;
+            const double optimal = 2.0 / eps2 * std::sqrt(st.variance / st.costPerPath) * budget;
+            const std::size_t want = batchesFor(optimal);
+            extra[l] = want > levels[l].batches ? want - levels[l].batches : 0;
+            more = more || extra[l] > 0;
+        }
+        if (more) continue;
+
+        // first-order weak error: Y_L ~ c 2^-L, so the bias left after
+        // level L is about |Y_L|
+        const std::size_t L = levels.size() - 1;
+        res.biasEstimate = std::max(std::abs(levels[L].stats.mean),
+                                    L > 0 ? 0.5 * std::abs(levels[L - 1].stats.mean) : 0.0);
+        res.converged = res.biasEstimate <= mlmc_.targetRMSE / std::sqrt(2.0);
+        if (res.converged || static_cast<int>(levels.size()) == mlmc_.maxLevels) break;
+        addLevel();
+        extra.push_back(batchesFor(static_cast<double>(mlmc_.initialSamples)));
+    }
+
+    double variance = 0.0;
+    for (const auto& lv : levels) {
+        res.optionValue += lv.stats.mean;
+        variance += lv.stats.variance / static_cast<double>(lv.stats.samples);
+        res.totalCost += lv.stats.costPerPath * static_cast<double>(lv.batches * B);
+        res.levels.push_back(lv.stats);
+    }
+    res.standardError = std::sqrt(variance);
+    // exercising at t = 0 is also allowed
+    const double immediate = base_.payoff_->evaluate(S0);
+    if (immediate > res.optionValue) {
+        res.optionValue = immediate;
+        res.standardError = 0.0;
+    }
+    res.rmse = std::hypot(res.standardError, res.biasEstimate);
+    return res;
+}
+
+}
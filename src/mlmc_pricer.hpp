@@ -0,0 +1,82 @@
+#pragma once
+
+#include "lsm_pricer.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace lsm {
+
+//  MLMCConfig  
+// - the multilevel estimator's accuracy target and level bounds
+
+struct MLMCConfig {
+    double targetRMSE = 0.01;           // root-mean-square error to reach
+    int minLevels = 3;                  // levels started with
+    int maxLevels = 8;                  // levels never exceed this
+    std::size_t initialSamples = 2048;  // per new level, before adapting
+    std::uint64_t seed = 1;             // sample paths; rules are fitted on cfg.rngSeed
+};
+
+//  MLMCLevel / MLMCResult  
+// - per-level statistics of MLMCPricer::price() and the combined estimate
+
+struct MLMCLevel {
+    int numExerciseDates = 0;
+    std::size_t samples = 0;            // independent samples (antithetic pairs count once)
+    double mean = 0.0;                  // E[P_l - P_{l-1}], E[P_0] on level 0
+    double variance = 0.0;              // per sample
+    double costPerPath = 0.0;           // path-dates: D_l + D_{l-1}
+    double sampleSeconds = 0.0;         // wall time spent sampling the level
+    double fitSeconds = 0.0;            // wall time fitting the level's rule
+};
+
+struct MLMCResult {
+    double optionValue = 0.0;
+    double standardError = 0.0;         // Monte Carlo part
+    double biasEstimate = 0.0;          // remaining time-discretisation bias
+    double rmse = 0.0;                  // the two in quadrature
+    bool converged = false;             // rmse within targetRMSE before maxLevels
+    double totalCost = 0.0;             // path-dates sampled over all levels
+    std::vector<MLMCLevel> levels;
+};
+
+//  MLMCPricer  
+// - multilevel Monte Carlo (Giles 2008) over LSM exercise-date grids. Level
+//   l has D_l = cfg.numExerciseDates 2^l dates and an exercise rule fitted
+//   by LSMPricer on cfg.numPaths paths of that grid. A level-l sample is
+//   one path on D_l dates, valued forward under rule l, minus the same
+//   Brownian path read at every second date, valued under rule l - 1; the
+//   differences telescope to the value of rule L on D_L dates, and as the
+//   coupled paths mostly stop alike their variance falls with l.
+//
+//   Samples come in fixed batches of kBlockPaths paths, batch b of level l
+//   from its own Philox stream, so results are bit-identical for any
+//   cfg.numThreads. Starting from minLevels levels of initialSamples, the
+//   sample counts follow the optimal N_l ~ sqrt(V_l / C_l) for a Monte
+//   Carlo variance of targetRMSE^2 / 2, and levels are added while the
+//   first-order bias estimate max(|Y_L|, |Y_{L-1}| / 2) exceeds
+//   targetRMSE / sqrt(2).
+//
+//   Supports antithetic paths and float storage; low-memory mode, Sobol
+//   sampling, the control variate and Greeks throw std::logic_error.
+
+class MLMCPricer {
+public:
+    MLMCPricer(const LSMConfig& cfg,
+               std::unique_ptr<StochasticProcess> process,
+               std::unique_ptr<Payoff> payoff,
+               BasisFamily basis,
+               MLMCConfig mlmc = {});
+
+    MLMCResult price(double S0) const;
+
+    const LSMConfig& config() const { return base_.config(); }
+    const MLMCConfig& mlmcConfig() const { return mlmc_; }
+
+private:
+    LSMPricer base_;
+    MLMCConfig mlmc_;
+};
+
+}
@@ -0,0 +1,313 @@
+#include "multi_asset.hpp"
+#include "simd_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace lsm {
+
+namespace {
+
+// Philox lanes of the asset normals: assets 2j and 2j + 1 share lane j
+constexpr std::uint32_t kAssetLane = 0;
+
+// paths stepped together: the correlation product and the per-asset rows
+// of a step stay in L1
+constexpr std::size_t kBlockLanes = 64;
+
+// beyond this many columns the normal equations are neither cheap nor well
+// conditioned
+constexpr std::size_t kMaxColumns = 4096;
+
+std::size_t checkedAssets(int numAssets, const char* who) {
+    if (numAssets < 1) throw std::invalid_argument(std::string(who) + ": need at least one asset");
+    return static_cast<std::size_t>(numAssets);
+}
+
+// the regressors are scaled by the strike, so it must be a positive number
+double checkedStrike(double K) {
+    if (!(K > 0.0)) throw std::invalid_argument("strike must be > 0");
+    return K;
+}
+
+}
+
+// CorrelatedGBM
+CorrelatedGBM::CorrelatedGBM(double r, std::vector<double> volatilities,
+                             std::vector<double> correlation, std::vector<double> dividendYields)
+    : r_(r), sigma_(std::move(volatilities)), q_(std::move(dividendYields)) {
+    const std::size_t d = checkedAssets(static_cast<int>(sigma_.size()), "CorrelatedGBM");
+    if (q_.empty()) q_.assign(d, 0.0);
+    if (q_.size() != d || correlation.size() != d * d) {
+        throw std::invalid_argument("CorrelatedGBM: need d dividend yields and a d x d correlation");
+    }
+    for (std::size_t a = 0; a < d; ++a) {
+        if (!(sigma_[a] > 0.0) || !std::isfinite(sigma_[a]) || !std::isfinite(q_[a])) {
+            throw std::invalid_argument("CorrelatedGBM: volatilities must be finite and > 0");
+        }
+        if (correlation[a * d + a] != 1.0) {
+            throw std::invalid_argument("CorrelatedGBM: correlation must have a unit diagonal");
+        }
+        for (std::size_t b = 0; b < a; ++b) {
+            if (correlation[a * d + b] != correlation[b * d + a] || std::abs(correlation[a * d + b]) > 1.0) {
+                throw std::invalid_argument("CorrelatedGBM: correlation must be symmetric with entries in [-1, 1]");
+            }
+        }
+    }
+
+    // rho = L L', column by column
+    chol_.assign(d * d, 0.0);
+    for (std::size_t j = 0; j < d; ++j) {
+        double s = correlation[j * d + j];
+        for (std::size_t b = 0; b < j; ++b) s -= chol_[j * d + b] * chol_[j * d + b];
+        if (!(s > 1e-12)) throw std::invalid_argument("CorrelatedGBM: correlation is not positive definite");
+        const double pivot = std::sqrt(s);
+        chol_[j * d + j] = pivot;
+        for (std::size_t a = j + 1; a < d; ++a) {
+            double t = correlation[a * d + j];
+            for (std::size_t b = 0; b < j; ++b) t -= chol_[a * d + b] * chol_[j * d + b];
+            chol_[a * d + j] = t / pivot;
+        }
+    }
+}
+
+std::vector<double> CorrelatedGBM::uniformCorrelation(int numAssets, double rho) {
+    const std::size_t d = checkedAssets(numAssets, "CorrelatedGBM");
+    std::vector<double> c(d * d, rho);
+    for (std::size_t a = 0; a < d; ++a) c[a * d + a] = 1.0;
+    return c;
+}
+
+int CorrelatedGBM::numAssets() const {
+    return static_cast<int>(sigma_.size());
+}
+
+void CorrelatedGBM::simulateBlock(std::span<const double> S0, double dt, const CounterRNG& rng,
+                                  std::uint64_t firstPathId, bool antithetic,
+                                  std::size_t count, std::span<double> out) const {
+    const std::size_t d = sigma_.size();
+    const std::size_t D = out.size() / (d * count) - 1;
+    for (std::size_t a = 0; a < d; ++a) std::fill_n(out.data() + a * count, count, S0[a]);
+    if (D == 0) return;
+
+    const double sign = antithetic ? -1.0 : 1.0;
+    std::vector<double> drift(d), vol(d);
+    for (std::size_t a = 0; a < d; ++a) {
+        drift[a] = (r_ - q_[a] - 0.5 * sigma_[a] * sigma_[a]) * dt;
+        vol[a] = sign * sigma_[a] * std::sqrt(dt);
+    }
+
+    // logS: log(S / S0) per asset; Z the independent normals of a step,
+    // padded to an even number of rows; Y = L Z the correlated ones
+    const std::size_t zRows = (d + 1) / 2 * 2;
+    std::vector<double> buffer((2 * d + zRows) * kBlockLanes);
+    double* logS = buffer.data();
+    double* Y = logS + d * kBlockLanes;
+    double* Z = Y + d * kBlockLanes;
+    for (std::size_t c = 0; c < count; c += kBlockLanes) {
+        const std::size_t n = std::min(kBlockLanes, count - c);
+        std::fill_n(logS, d * kBlockLanes, 0.0);
+        for (std::size_t j = 0; j < D; ++j) {
+            for (std::size_t a = 0; a < d; a += 2) {
+                simd::normalBlock(rng, firstPathId + c, n, static_cast<std::uint32_t>(j),
+                                  kAssetLane + static_cast<std::uint32_t>(a / 2),
+                                  Z + a * kBlockLanes, Z + (a + 1) * kBlockLanes);
+            }
+            // L is lower triangular: row a of Y needs rows 0 .. a of Z
+            for (std::size_t a = 0; a < d; ++a) {
+                double* y = Y + a * kBlockLanes;
+                const double* l = chol_.data() + a * d;
+                for (std::size_t i = 0; i < n; ++i) y[i] = l[0] * Z[i];
+                for (std::size_t b = 1; b <= a; ++b) {
+                    const double* z = Z + b * kBlockLanes;
+                    for (std::size_t i = 0; i < n; ++i) y[i] += l[b] * z[i];
+                }
+            }
+            for (std::size_t a = 0; a < d; ++a) {
+                double* x = logS + a * kBlockLanes;
+                const double* y = Y + a * kBlockLanes;
+                for (std::size_t i = 0; i < n; ++i) x[i] += drift[a] + vol[a] * y[i];
+                simd::scaledExpBlock(x, S0[a], n, out.data() + ((j + 1) * d + a) * count + c);
+            }
+        }
+    }
+}
+
+std::string CorrelatedGBM::name() const {
+    return "CorrelatedGBM(d=" + std::to_string(sigma_.size()) + ")";
+}
+
+// BasketPutPayoff
+BasketPutPayoff::BasketPutPayoff(std::vector<double> weights, double K)
+    : w_(std::move(weights)), K_(checkedStrike(K)) {
+    checkedAssets(static_cast<int>(w_.size()), "BasketPutPayoff");
+    for (double w : w_) {
+        if (!std::isfinite(w)) throw std::invalid_argument("BasketPutPayoff: weights must be finite");
+    }
+}
+
+int BasketPutPayoff::numAssets() const {
+    return static_cast<int>(w_.size());
+}
+
+double BasketPutPayoff::evaluate(std::span<const double> spots) const {
+    double basket = 0.0;
+    for (std::size_t a = 0; a < w_.size(); ++a) basket += w_[a] * spots[a];
+    return std::max(K_ - basket, 0.0);
+}
+
+void BasketPutPayoff::evaluateBatch(std::span<const double> S, std::span<double> out) const {
+    const std::size_t n = out.size();
+    for (std::size_t i = 0; i < n; ++i) out[i] = w_[0] * S[i];
+    for (std::size_t a = 1; a < w_.size(); ++a) {
+        const double* s = S.data() + a * n;
+        for (std::size_t i = 0; i < n; ++i) out[i] += w_[a] * s[i];
+    }
+    for (std::size_t i = 0; i < n; ++i) out[i] = std::max(K_ - out[i], 0.0);
+}
+
+double BasketPutPayoff::strike() const {
+    return K_;
+}
+
+std::string BasketPutPayoff::name() const {
+    return "BasketPut(d=" + std::to_string(w_.size()) + ", K=" + std::to_string(K_) + ")";
+}
+
+// MaxCallPayoff
+MaxCallPayoff::MaxCallPayoff(int numAssets, double K)
+    : d_(static_cast<int>(checkedAssets(numAssets, "MaxCallPayoff"))), K_(checkedStrike(K)) {}
+
+int MaxCallPayoff::numAssets() const {
+    return d_;
+}
+
+double MaxCallPayoff::evaluate(std::span<const double> spots) const {
+    double best = spots[0];
+    for (int a = 1; a < d_; ++a) best = std::max(best, spots[a]);
+    return std::max(best - K_, 0.0);
+}
+
+void MaxCallPayoff::evaluateBatch(std::span<const double> S, std::span<double> out) const {
+    const std::size_t n = out.size();
+    std::copy_n(S.data(), n, out.data());
+    for (int a = 1; a < d_; ++a) {
+        const double* s = S.data() + a * n;
+        for (std::size_t i = 0; i < n; ++i) out[i] = std::max(out[i], s[i]);
+    }
+    for (std::size_t i = 0; i < n; ++i) out[i] = std::max(out[i] - K_, 0.0);
+}
+
+double MaxCallPayoff::strike() const {
+    return K_;
+}
+
+std::string MaxCallPayoff::name() const {
+    return "MaxCall(d=" + std::to_string(d_) + ", K=" + std::to_string(K_) + ")";
+}
+
+// MultivariateBasis
+MultivariateBasis::MultivariateBasis(BasisFamily family, int numAssets, MultiIndexSet set)
+    : family_(family), d_(static_cast<int>(checkedAssets(numAssets, "MultivariateBasis"))), set_(set) {
+    const std::size_t d = d_;
+    const int M = family_.numTerms();
+    if (set_ == MultiIndexSet::TensorProduct &&
+        std::pow(static_cast<double>(M + 1), static_cast<double>(d)) > static_cast<double>(kMaxColumns)) {
+        throw std::invalid_argument("MultivariateBasis: too many tensor-product columns");
+    }
+
+    if (set_ == MultiIndexSet::TotalDegree) {
+        // C(M + d, d) = prod_k (d + k) / k, checked before any index is built
+        std::size_t columns = 1;
+        for (int k = 1; k <= M; ++k) {
+            columns = columns * (d + k) / k;
+            if (columns > kMaxColumns) {
+                throw std::invalid_argument("MultivariateBasis: too many total-degree columns");
+            }
+        }
+        indices_.reserve(columns * d);
+
+        // degree by degree, each degree's alphas in odometer order (alpha_0
+        // fastest): alpha_{d-1} down to alpha_1 take every split of the
+        // remaining degree and alpha_0 the rest
+        std::vector<int> alpha(d, 0);
+        auto fill = [&](auto& self, std::size_t a, int rest) -> void {
+            if (a == 0) {
+                alpha[0] = rest;
+                indices_.insert(indices_.end(), alpha.begin(), alpha.end());
+                return;
+            }
+            for (int v = 0; v <= rest; ++v) {
+                alpha[a] = v;
+                self(self, a - 1, rest - v);
+            }
+            alpha[a] = 0;
+        };
+        for (int degree = 0; degree <= M; ++degree) fill(fill, d - 1, degree);
+        return;
+    }
+
+    // every alpha with entries <= M, odometer order, then stably sorted by
+    // total degree
+    std::vector<std::vector<int>> alphas;
+    std::vector<int> alpha(d, 0);
+    for (;;) {
+        alphas.push_back(alpha);
+        std::size_t a = 0;
+        while (a < d && alpha[a] == M) alpha[a++] = 0;
+        if (a == d) break;
+        ++alpha[a];
+    }
+    auto degreeOf = [](const std::vector<int>& v) {
+        int s = 0;
+        for (int x : v) s += x;
+        return s;
+    };
+    std::stable_sort(alphas.begin(), alphas.end(),
+                     [&](const auto& l, const auto& r) { return degreeOf(l) < degreeOf(r); });
+    indices_.reserve(alphas.size() * d);
+    for (const auto& v : alphas) indices_.insert(indices_.end(), v.begin(), v.end());
+}
+
+void MultivariateBasis::evaluate(std::span<const double> x, std::span<double> out) const {
+    std::vector<double> scratch(scratchSize(1));
+    evaluateBatch(x.first(d_), out.first(size()), scratch);
+}
+
+std::size_t MultivariateBasis::scratchSize(std::size_t n) const {
+    return static_cast<std::size_t>(d_) * family_.size() * n;
+}
+
+void MultivariateBasis::evaluateBatch(std::span<const double> x, std::span<double> out,
+                                      std::span<double> scratch) const {
+    const std::size_t d = d_;
+    const std::size_t n = x.size() / d;
+    const std::size_t F = family_.size();
+
+    // univariate columns: scratch[(a * F + j) * n + i] is column j at x_a
+    for (std::size_t a = 0; a < d; ++a) {
+        family_.evaluateBatch(x.subspan(a * n, n), scratch.subspan(a * F * n, F * n));
+    }
+    // each product column starts from its first non-constant factor;
+    // constant factors are skipped
+    for (std::size_t j = 0; j < indices_.size() / d; ++j) {
+        double* col = out.data() + j * n;
+        const int* alpha = indices_.data() + j * d;
+        bool started = false;
+        for (std::size_t a = 0; a < d; ++a) {
+            if (alpha[a] == 0) continue;
+            const double* u = scratch.data() + (a * F + alpha[a]) * n;
+            if (!started) std::copy_n(u, n, col);
+            else for (std::size_t i = 0; i < n; ++i) col[i] *= u[i];
+            started = true;
+        }
+        if (!started) std::fill_n(col, n, 1.0);
+    }
+}
+
+std::string MultivariateBasis::name() const {
+    return family_.name() + "^" + std::to_string(d_) +
+           (set_ == MultiIndexSet::TensorProduct ? " tensor" : " total-degree");
+}
+
+}
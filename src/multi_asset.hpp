@@ -0,0 +1,174 @@
+#pragma once
+
+#include "basis_functions.hpp"
+#include "counter_rng.hpp"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace lsm {
+
+//  MultiAssetProcess  
+// - d assets driven by correlated Brownian motions. Blocks are stored
+//   structure-of-arrays: out[(k * d + a) * count + i] is asset a at date k
+//   of path firstPathId + i, so one date of one asset is a contiguous row
+//   and a PathMatrix with (D + 1) d rows holds the whole simulation.
+
+class MultiAssetProcess {
+public:
+    virtual ~MultiAssetProcess() {}
+
+    virtual int numAssets() const = 0;
+
+    // Simulate `count` consecutive paths from spots S0[a] (numAssets()
+    // long); the number of dates is out.size() / (numAssets() * count) and
+    // date 0 holds S0. As for StochasticProcess, every draw is addressed by
+    // (pathId, step, lane), so a path does not depend on the block it is in,
+    // and antithetic = true negates the Gaussian draws of the same pathId.
+    virtual void simulateBlock(std::span<const double> S0, double dt, const CounterRNG& rng,
+                               std::uint64_t firstPathId, bool antithetic,
+                               std::size_t count, std::span<double> out) const = 0;
+
+    virtual std::string name() const = 0;
+};
+
+//  CorrelatedGBM  
+// - d risk-neutral GBMs with dividend yields q_a,
+//   dS_a = (r - q_a) S_a dt + sigma_a S_a dW_a,  d<W_a, W_b> = rho_ab dt,
+//   exact in log space. The correlation is Cholesky-factorised once, L L' =
+//   rho. A block is stepped 64 paths at a time: the d independent normals of
+//   a step are drawn two assets per Philox call, turned into correlated
+//   increments as the d x d by d x 64 product L Z, and exponentiated through
+//   the SIMD kernels one asset row at a time.
+
+class CorrelatedGBM : public MultiAssetProcess {
+public:
+    // correlation is d x d row-major, symmetric with a unit diagonal and
+    // positive definite; dividendYields empty means zero. Throws
+    // std::invalid_argument otherwise.
+    CorrelatedGBM(double r, std::vector<double> volatilities, std::vector<double> correlation,
+                  std::vector<double> dividendYields = {});
+
+    // d x d correlation matrix with rho off the diagonal
+    static std::vector<double> uniformCorrelation(int numAssets, double rho);
+
+    int numAssets() const;
+    void simulateBlock(std::span<const double> S0, double dt, const CounterRNG& rng,
+                       std::uint64_t firstPathId, bool antithetic,
+                       std::size_t count, std::span<double> out) const;
+    std::string name() const;
+
+    double rate() const { return r_; }
+    const std::vector<double>& volatilities() const { return sigma_; }
+    const std::vector<double>& dividendYields() const { return q_; }
+    const std::vector<double>& choleskyFactor() const { return chol_; }  // lower, row-major
+
+private:
+    double r_;
+    std::vector<double> sigma_;
+    std::vector<double> q_;
+    std::vector<double> chol_;
+};
+
+//  MultiAssetPayoff  
+// - an exercise value of the d spots at one date
+
+class MultiAssetPayoff {
+public:
+    virtual ~MultiAssetPayoff() {}
+
+    virtual int numAssets() const = 0;
+
+    // spots[a] is asset a
+    virtual double evaluate(std::span<const double> spots) const = 0;
+
+    // out[i] = payoff at the spots S[a * out.size() + i], the layout of one
+    // date of a MultiAssetProcess block
+    virtual void evaluateBatch(std::span<const double> S, std::span<double> out) const = 0;
+
+    // scale of the regressors: the basis sees S_a / strike()
+    virtual double strike() const = 0;
+    virtual std::string name() const = 0;
+};
+
+//  BasketPutPayoff  
+// - max(K - sum_a w_a S_a, 0); std::invalid_argument unless K > 0 and
+//   every weight is finite
+
+class BasketPutPayoff : public MultiAssetPayoff {
+public:
+    BasketPutPayoff(std::vector<double> weights, double K);
+
+    int numAssets() const;
+    double evaluate(std::span<const double> spots) const;
+    void evaluateBatch(std::span<const double> S, std::span<double> out) const;
+    double strike() const;
+    std::string name() const;
+
+private:
+    std::vector<double> w_;
+    double K_;
+};
+
+//  MaxCallPayoff  
+// - max(max_a S_a - K, 0); std::invalid_argument unless K > 0
+
+class MaxCallPayoff : public MultiAssetPayoff {
+public:
+    MaxCallPayoff(int numAssets, double K);
+
+    int numAssets() const;
+    double evaluate(std::span<const double> spots) const;
+    void evaluateBatch(std::span<const double> S, std::span<double> out) const;
+    double strike() const;
+    std::string name() const;
+
+private:
+    int d_;
+    double K_;
+};
+
+//  MultivariateBasis  
+// - products of one BasisFamily's columns across d regressors: column
+//   alpha = (alpha_1 .. alpha_d) is prod_a column alpha_a of the family at
+//   x_a, with alpha_a = 0 the constant. TensorProduct keeps every alpha_a
+//   <= M, (M + 1)^d columns; TotalDegree keeps sum_a alpha_a <= M,
+//   C(M + d, d) columns, which grows polynomially in d and is the usual
+//   choice past two or three assets. Columns are ordered by total degree,
+//   so column 0 is the constant.
+
+enum class MultiIndexSet { TensorProduct, TotalDegree };
+
+class MultivariateBasis {
+public:
+    MultivariateBasis(BasisFamily family, int numAssets,
+                      MultiIndexSet set = MultiIndexSet::TotalDegree);
+
+    const BasisFamily& family() const { return family_; }
+    int numAssets() const { return d_; }
+    MultiIndexSet indexSet() const { return set_; }
+    int size() const { return static_cast<int>(indices_.size()) / d_; }
+    // indices()[j * numAssets() + a] is alpha_a of column j
+    const std::vector<int>& indices() const { return indices_; }
+
+    // all size() columns at one point x[a]
+    void evaluate(std::span<const double> x, std::span<double> out) const;
+
+    // column-major block for n = x.size() / numAssets() points:
+    // out[j * n + i] is column j at the point x[a * n + i]. scratch holds
+    // the univariate columns, scratchSize(n) elements.
+    void evaluateBatch(std::span<const double> x, std::span<double> out,
+                       std::span<double> scratch) const;
+    std::size_t scratchSize(std::size_t n) const;
+
+    std::string name() const;
+
+private:
+    BasisFamily family_;
+    int d_;
+    MultiIndexSet set_;
+    std::vector<int> indices_;
+};
+
+}
@@ -0,0 +1,241 @@
+#include "multi_asset_pricer.hpp"
+#include "ols_regressor.hpp"
+#include "parallel.hpp"
+#include "pricing_workspace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace lsm {
+
+// MultiAssetLSMPricer
+MultiAssetLSMPricer::MultiAssetLSMPricer(const LSMConfig& cfg,
+                                         std::unique_ptr<MultiAssetProcess> process,
+                                         std::unique_ptr<MultiAssetPayoff> payoff,
+                                         MultivariateBasis basis)
+    : cfg_(cfg), process_(std::move(process)), payoff_(std::move(payoff)), basis_(std::move(basis)) {
+    if (cfg_.numPaths <= 0 || cfg_.numExerciseDates <= 0 || cfg_.maturity <= 0.0) {
+        throw std::invalid_argument("LSMConfig: numPaths, numExerciseDates and maturity must be > 0");
+    }
+    if (cfg_.useAntithetic && cfg_.numPaths % 2 != 0) {
+        throw std::invalid_argument("LSMConfig: antithetic sampling needs an even numPaths");
+    }
+    if (!process_ || !payoff_) {
+        throw std::invalid_argument("MultiAssetLSMPricer: process and payoff are required");
+    }
+    if (payoff_->numAssets() != process_->numAssets() || basis_.numAssets() != process_->numAssets()) {
+        throw std::invalid_argument("MultiAssetLSMPricer: process, payoff and basis disagree on the number of assets");
+    }
+    if (cfg_.lowMemory || cfg_.samplingScheme != SamplingScheme::PseudoRandom || cfg_.useControlVariate ||
+        cfg_.computeGreeks || cfg_.basisPrecision != PathPrecision::Double) {
+        throw std::logic_error("MultiAssetLSMPricer: supports neither low-memory mode, Sobol sampling, "
+                               "the control variate, Greeks nor a float design matrix");
+    }
+}
+
+SimulationResult MultiAssetLSMPricer::price(std::span<const double> S0) const {
+    PricingWorkspace ws;
+    const PathMatrix paths = simulatePaths(S0);
+    return backwardInduction(paths, S0, ws);
+}
+
+PathMatrix MultiAssetLSMPricer::simulatePaths(std::span<const double> S0) const {
+    if (S0.size() != static_cast<std::size_t>(numAssets())) {
+        throw std::invalid_argument("MultiAssetLSMPricer: need one spot per asset");
+    }
+    const std::size_t rows = (static_cast<std::size_t>(cfg_.numExerciseDates) + 1) * numAssets();
+    PathMatrix paths(cfg_.numPaths, rows, cfg_.pathPrecision);
+    PricingWorkspace ws;
+    simulate(S0, paths, ws);
+    return paths;
+}
+
+void MultiAssetLSMPricer::simulate(std::span<const double> S0, PathMatrix& paths,
+                                   PricingWorkspace& ws) const {
+    const std::size_t N = cfg_.numPaths;
+    const std::size_t rows = paths.numDates();
+    const double dt = cfg_.maturity / cfg_.numExerciseDates;
+    const std::size_t half = cfg_.useAntithetic ? N / 2 : N;
+    const CounterRNG rng(cfg_.rngSeed);
+
+    // tiles of kTilePaths paths spread over the workers, each simulated as
+    // one SoA block and stored one row piece per (date, asset); a tile
+    // straddling the antithetic midpoint is simulated as two blocks
+    const std::size_t numTiles = (N + kTilePaths - 1) / kTilePaths;
+    const std::size_t workers = std::max<std::size_t>(
+        1, std::min<std::size_t>(static_cast<std::size_t>(effectiveThreadCount(cfg_.numThreads)), numTiles));
+    const std::size_t perWorker = kTilePaths * rows;
+    const auto buffers = ws.allocate<double>(workers * perWorker);
+    parallelFor(workers, cfg_.numThreads, [&](std::size_t cBegin, std::size_t cEnd) {
+        for (std::size_t c = cBegin; c < cEnd; ++c) {
+            double* block = buffers.data() + c * perWorker;
+            for (std::size_t t = c * numTiles / workers; t < (c + 1) * numTiles / workers; ++t) {
+                const std::size_t first = t * kTilePaths;
+                const std::size_t n = std::min(kTilePaths, N - first);
+                for (std::size_t done = 0; done < n;) {
+                    const std::size_t p = first + done;
+                    const bool mirror = p >= half;
+                    const std::size_t run = mirror ? n - done : std::min(n - done, half - p);
+                    process_->simulateBlock(S0, dt, rng, mirror ? p - half : p, mirror, run,
+                                            std::span<double>(block, run * rows));
+                    paths.storeBlock(p, run, block);
+                    done += run;
+                }
+            }
+        }
+    });
+}
+
+SimulationResult MultiAssetLSMPricer::backwardInduction(const PathMatrix& paths,
+                                                        std::span<const double> S0,
+                                                        PricingWorkspace& ws) const {
+    const int D = cfg_.numExerciseDates;
+    const std::size_t N = cfg_.numPaths;
+    const std::size_t d = numAssets();
+    const std::size_t m = basis_.size();
+    const double df = std::exp(-cfg_.riskFreeRate * cfg_.maturity / D);
+    const double invK = 1.0 / payoff_->strike();
+
+    // as in LSMPricer::backwardInduction: fixed blocks, each with its own
+    // in-the-money gather and normal-equation sums, reduced in block order
+    struct Block {
+        std::size_t begin = 0, end = 0;
+        std::size_t n = 0;                  // in-the-money paths at this date
+        std::span<std::size_t> itm;
+        std::span<double> spots, row, payoff, x, y, exercise, X, fit, basisScratch;
+        std::span<double> XtX, Xty;
+        double european = 0.0;
+    };
+    const std::size_t numBlocks = (N + kBlockPaths - 1) / kBlockPaths;
+    const auto blocks = ws.allocate<Block>(numBlocks);
+    for (std::size_t b = 0; b < numBlocks; ++b) {
+        Block& blk = blocks[b];
+        blk.begin = b * kBlockPaths;
+        blk.end = std::min(N, blk.begin + kBlockPaths);
+        const std::size_t size = blk.end - blk.begin;
+        blk.itm = ws.allocate<std::size_t>(size);
+        blk.spots = ws.allocate<double>(d * size);
+        blk.row = ws.allocate<double>(size);
+        blk.payoff = ws.allocate<double>(size);
+        blk.x = ws.allocate<double>(d * size);
+        blk.y = ws.allocate<double>(size);
+        blk.exercise = ws.allocate<double>(size);
+        blk.fit = ws.allocate<double>(size);
+        blk.X = ws.allocate<double>(m * size);
+        blk.basisScratch = ws.allocate<double>(basis_.scratchSize(size));
+        blk.XtX = ws.allocate<double>(m * m);
+        blk.Xty = ws.allocate<double>(m);
+    }
+    auto forBlocks = [&](auto&& body) {
+        parallelFor(numBlocks, cfg_.numThreads, [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t b = lo; b < hi; ++b) body(blocks[b]);
+        });
+    };
+    // the block's spots at date k, asset-major: spots[a * size + i]
+    auto payoffAt = [&](Block& blk, int k) {
+        const std::size_t size = blk.end - blk.begin;
+        for (std::size_t a = 0; a < d; ++a) {
+            const auto S = paths.readDate(k * d + a, blk.begin, blk.end, blk.row);
+            std::copy(S.begin(), S.end(), blk.spots.begin() + a * size);
+        }
+        payoff_->evaluateBatch(blk.spots, blk.payoff.first(size));
+        return blk.payoff.first(size);
+    };
+
+    const auto cash = ws.allocate<double>(N);
+    const double discT = std::exp(-cfg_.riskFreeRate * cfg_.maturity);
+    forBlocks([&](Block& blk) {
+        const auto h = payoffAt(blk, D);
+        for (std::size_t p = blk.begin; p < blk.end; ++p) {
+            cash[p] = h[p - blk.begin];
+            blk.european += cash[p];
+        }
+    });
+    double european = 0.0;
+    for (const auto& blk : blocks) european += blk.european;
+    european *= discT / N;
+
+    const auto totalXtX = ws.allocate<double>(m * m);
+    const auto totalXty = ws.allocate<double>(m);
+    const auto beta = ws.allocate<double>(m);
+    for (int k = D - 1; k >= 1; --k) {
+        forBlocks([&](Block& blk) {
+            const std::size_t size = blk.end - blk.begin;
+            const auto h = payoffAt(blk, k);
+            double* c = cash.data() + blk.begin;
+            for (std::size_t i = 0; i < size; ++i) c[i] *= df;
+            // branch-free compaction, as in LSMPricer::backwardInduction
+            std::size_t n = 0;
+            for (std::size_t i = 0; i < size; ++i) {
+                blk.itm[n] = blk.begin + i;
+                n += h[i] > 0.0;
+            }
+            blk.n = n;
+            std::fill(blk.XtX.begin(), blk.XtX.end(), 0.0);
+            std::fill(blk.Xty.begin(), blk.Xty.end(), 0.0);
+            if (n == 0) return;
+            for (std::size_t c = 0; c < n; ++c) {
+                const std::size_t i = blk.itm[c] - blk.begin;
+                blk.y[c] = cash[blk.itm[c]];
+                blk.exercise[c] = h[i];
+            }
+            for (std::size_t a = 0; a < d; ++a) {
+                const double* S = blk.spots.data() + a * size;
+                double* x = blk.x.data() + a * n;
+                for (std::size_t c = 0; c < n; ++c) x[c] = S[blk.itm[c] - blk.begin] * invK;
+            }
+            basis_.evaluateBatch(blk.x.first(d * n), blk.X.first(m * n), blk.basisScratch);
+            OLSRegressor::accumulate(blk.X.first(m * n), blk.y.first(n), blk.XtX, blk.Xty);
+        });
+
+        std::fill(totalXtX.begin(), totalXtX.end(), 0.0);
+        std::fill(totalXty.begin(), totalXty.end(), 0.0);
+        std::size_t count = 0;
+        for (const auto& blk : blocks) {
+            for (std::size_t i = 0; i < totalXtX.size(); ++i) totalXtX[i] += blk.XtX[i];
+            for (std::size_t i = 0; i < totalXty.size(); ++i) totalXty[i] += blk.Xty[i];
+            count += blk.n;
+        }
+        if (count < m) continue;            // too few points to regress
+        OLSRegressor::solve(totalXtX, totalXty, beta);
+
+        forBlocks([&](Block& blk) {
+            const std::size_t n = blk.n;
+            if (n == 0) return;
+            OLSRegressor::predict(blk.X.first(m * n), beta, blk.fit.first(n));
+            for (std::size_t c = 0; c < n; ++c) {
+                const std::size_t p = blk.itm[c];
+                cash[p] = blk.exercise[c] > blk.fit[c] ? blk.exercise[c] : cash[p];
+            }
+        });
+    }
+    forBlocks([&](Block& blk) {
+        for (std::size_t p = blk.begin; p < blk.end; ++p) cash[p] *= df;
+    });
+
+    // antithetic pairs (p, p + N/2) are averaged before taking the variance
+    const std::size_t samples = cfg_.useAntithetic ? N / 2 : N;
+    auto sample = [&](std::size_t i) {
+        return cfg_.useAntithetic ? 0.5 * (cash[i] + cash[i + samples]) : cash[i];
+    };
+    double sum = 0.0;
+    for (std::size_t i = 0; i < samples; ++i) sum += sample(i);
+    const double mean = sum / samples;
+    double sq = 0.0;
+    for (std::size_t i = 0; i < samples; ++i) sq += (sample(i) - mean) * (sample(i) - mean);
+
+    SimulationResult res;
+    res.optionValue = mean;
+    res.standardError = samples > 1 ? std::sqrt(sq / (samples - 1) / samples) : 0.0;
+    // exercising at t = 0 is also allowed
+    const double immediate = payoff_->evaluate(S0);
+    if (immediate > res.optionValue) {
+        res.optionValue = immediate;
+        res.standardError = 0.0;
+    }
+    res.europeanValue = european;
+    res.earlyExercisePremium = res.optionValue - res.europeanValue;
+    return res;
+}
+
+}
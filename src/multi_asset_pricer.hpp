@@ -0,0 +1,59 @@
+#pragma once
+
+#include "lsm_types.hpp"
+#include "multi_asset.hpp"
+#include <memory>
+#include <span>
+
+namespace lsm {
+
+class PricingWorkspace;
+
+//  MultiAssetLSMPricer  
+// - Longstaff-Schwartz for a MultiAssetPayoff on a MultiAssetProcess, the
+//   continuation value regressed on a MultivariateBasis of S_a / K over the
+//   in-the-money paths. Paths live in one structure-of-arrays PathMatrix of
+//   (D + 1) d rows, row k d + a holding asset a at date k, so memory is
+//   N (D + 1) d spots (halved by PathPrecision::Float) and each block of
+//   the backward sweep reads contiguous row pieces.
+//
+//   The sweep is LSMPricer's: fixed blocks of paths gather their in-the-
+//   money points and normal-equation sums, reduced in block order, and
+//   simulation tiles are addressed by path index, so results are bit-
+//   identical for any cfg.numThreads. Antithetic paths and float storage
+//   are supported; low-memory mode, Sobol sampling, the control variate,
+//   Greeks and a float design matrix are not and throw std::logic_error at
+//   construction. cfg.profile is ignored.
+
+class MultiAssetLSMPricer {
+public:
+    MultiAssetLSMPricer(const LSMConfig& cfg,
+                        std::unique_ptr<MultiAssetProcess> process,
+                        std::unique_ptr<MultiAssetPayoff> payoff,
+                        MultivariateBasis basis);
+
+    // S0 is numAssets() long
+    SimulationResult price(std::span<const double> S0) const;
+
+    // The path store price() regresses on: row k * numAssets() + a is asset
+    // a at date k, in cfg.pathPrecision.
+    PathMatrix simulatePaths(std::span<const double> S0) const;
+
+    const LSMConfig& config() const { return cfg_; }
+    int numAssets() const { return process_->numAssets(); }
+    const MultivariateBasis& basis() const { return basis_; }
+    const MultiAssetProcess& process() const { return *process_; }
+    const MultiAssetPayoff& payoff() const { return *payoff_; }
+
+private:
+    void simulate(std::span<const double> S0, PathMatrix& paths, PricingWorkspace& ws) const;
+    SimulationResult backwardInduction(const PathMatrix& paths, std::span<const double> S0,
+                                       PricingWorkspace& ws) const;
+
+    LSMConfig cfg_;
+    std::unique_ptr<MultiAssetProcess> process_;
+    std::unique_ptr<MultiAssetPayoff> payoff_;
+    MultivariateBasis basis_;
+};
+
+}
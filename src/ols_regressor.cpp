@@ -0,0 +1,418 @@
+#include "ols_regressor.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace lsm {
+
+namespace {
+
+// Calls f(std::integral_constant<int, m>{}) when m has a fixed-size kernel.
+template <class F>
+bool withFixedCount(int m, F&& f) {
+    switch (m) {
+    case 1: f(std::integral_constant<int, 1>{}); return true;
+    case 2: f(std::integral_constant<int, 2>{}); return true;
+    case 3: f(std::integral_constant<int, 3>{}); return true;
+    case 4: f(std::integral_constant<int, 4>{}); return true;
+    case 5: f(std::integral_constant<int, 5>{}); return true;
+    case 6: f(std::integral_constant<int, 6>{}); return true;
+    case 7: f(std::integral_constant<int, 7>{}); return true;
+    case 8: f(std::integral_constant<int, 8>{}); return true;
+    case 9: f(std::integral_constant<int, 9>{}); return true;
+    default: return false;
+    }
+}
+static_assert(kMaxFixedRegressors == 9, "withFixedCount must cover every fixed size");
+
+// Working storage for one solve: on the stack when the size is a
+// compile-time constant M, on the heap for the run-time case M = 0
+template <int M>
+struct SolveScratch {
+    explicit SolveScratch(int) {}
+    std::array<double, M * M> A, V;
+    std::array<double, M> d, c, z;
+};
+
+template <>
+struct SolveScratch<0> {
+    explicit SolveScratch(int m) : A(m * m), V(m * m), d(m), c(m), z(m) {}
+    std::vector<double> A, V, d, c, z;
+};
+
+constexpr double kCholeskyTol = 1e-10;     // pivot floor, on the unit-diagonal scale
+constexpr double kEigenTol = 1e-12;        // kept eigenvalues, relative to the largest
+
+// Cyclic Jacobi on a symmetric m x m A: A ends up (numerically) diagonal
+// with the eigenvalues, V holds the eigenvectors in its columns
+template <int M>
+void jacobiEigen(int m, double* A, double* V) {
+    for (int i = 0; i < m; ++i)
+        for (int j = 0; j < m; ++j) V[i * m + j] = i == j ? 1.0 : 0.0;
+
+    for (int sweep = 0; sweep < 64; ++sweep) {
+        double off = 0.0, diag = 0.0;
+        for (int i = 0; i < m; ++i) {
+            diag += A[i * m + i] * A[i * m + i];
+            for (int j = i + 1; j < m; ++j) off += A[i * m + j] * A[i * m + j];
+        }
+        if (off <= 1e-32 * diag) break;
+
+        for (int p = 0; p < m; ++p) {
+            for (int q = p + 1; q < m; ++q) {
+                const double apq = A[p * m + q];
+                if (apq == 0.0) continue;
+                const double theta = (A[q * m + q] - A[p * m + p]) / (2.0 * apq);
+                const double t = (theta >= 0.0 ? 1.0 : -1.0) /
+                                 (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                const double c = 1.0 / std::sqrt(t * t + 1.0);
+                const double s = t * c;
+                for (int k = 0; k < m; ++k) {
+                    const double akp = A[k * m + p], akq = A[k * m + q];
+                    A[k * m + p] = c * akp - s * akq;
+                    A[k * m + q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < m; ++k) {
+                    const double apk = A[p * m + k], aqk = A[q * m + k];
+                    A[p * m + k] = c * apk - s * aqk;
+                    A[q * m + k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < m; ++k) {
+                    const double vkp = V[k * m + p], vkq = V[k * m + q];
+                    V[k * m + p] = c * vkp - s * vkq;
+                    V[k * m + q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+}
+
+// (X'X) beta = X'y with m = M, or m = mRun when M = 0
+template <int M>
+void solveSymmetric(int mRun, const double* XtX, const double* Xty, double* beta) {
+    const int m = M > 0 ? M : mRun;
+    SolveScratch<M> w(m);
+    double* A = std::data(w.A);
+    double* d = std::data(w.d);
+    double* c = std::data(w.c);
+    double* z = std::data(w.z);
+
+    // scale to a unit diagonal; an all-zero regressor keeps beta = 0
+    for (int i = 0; i < m; ++i) {
+        const double aii = XtX[i * m + i];
+        d[i] = aii > 0.0 ? 1.0 / std::sqrt(aii) : 0.0;
+    }
+    auto scaled = [&]() {
+        for (int i = 0; i < m; ++i) {
+            c[i] = d[i] * Xty[i];
+            for (int j = 0; j < m; ++j) A[i * m + j] = d[i] * XtX[i * m + j] * d[j];
+        }
+    };
+    scaled();
+
+    // Cholesky, L overwriting the lower triangle
+    bool spd = true;
+    for (int j = 0; j < m && spd; ++j) {
+        if (d[j] == 0.0) {
+            A[j * m + j] = 1.0;
+            for (int i = j + 1; i < m; ++i) A[i * m + j] = 0.0;
+            continue;
+        }
+        double sum = A[j * m + j];
+        for (int k = 0; k < j; ++k) sum -= A[j * m + k] * A[j * m + k];
+        if (sum <= kCholeskyTol) {
+            spd = false;
+            break;
+        }
+        const double ljj = std::sqrt(sum);
+        A[j * m + j] = ljj;
+        for (int i = j + 1; i < m; ++i) {
+            double v = A[i * m + j];
+            for (int k = 0; k < j; ++k) v -= A[i * m + k] * A[j * m + k];
+            A[i * m + j] = v / ljj;
+        }
+    }
+
+    if (spd) {
+        for (int i = 0; i < m; ++i) {
+            double v = c[i];
+            for (int k = 0; k < i; ++k) v -= A[i * m + k] * z[k];
+            z[i] = v / A[i * m + i];
+        }
+        for (int i = m - 1; i >= 0; --i) {
+            double v = z[i];
+            for (int k = i + 1; k < m; ++k) v -= A[k * m + i] * z[k];
+            z[i] = v / A[i * m + i];
+        }
+    } else {
+        // collinear regressors: minimum-norm solution over the well-determined
+        // eigen-directions
+        scaled();
+        double* V = std::data(w.V);
+        jacobiEigen<M>(m, A, V);
+        double top = 0.0;
+        for (int k = 0; k < m; ++k) top = std::max(top, A[k * m + k]);
+        for (int i = 0; i < m; ++i) z[i] = 0.0;
+        for (int k = 0; k < m; ++k) {
+            const double lambda = A[k * m + k];
+            if (lambda <= kEigenTol * top) continue;
+            double proj = 0.0;
+            for (int i = 0; i < m; ++i) proj += V[i * m + k] * c[i];
+            proj /= lambda;
+            for (int i = 0; i < m; ++i) z[i] += proj * V[i * m + k];
+        }
+    }
+    for (int i = 0; i < m; ++i) beta[i] = d[i] * z[i];
+}
+
+// The kernels for a design matrix stored as T (double or float); products
+// and sums are always formed in double.
+template <int M, class T>
+void accumulateFixed(const T* X, const double* y, std::size_t n, double* XtX, double* Xty) {
+    // four interleaved partial sums per entry, so the row loop vectorises;
+    // they are combined in a fixed order at the end
+    constexpr std::size_t L = 4;
+    double xx[M][M][L] = {};
+    double xy[M][L] = {};
+    const std::size_t full = n - n % L;
+    for (std::size_t i = 0; i < full; i += L) {
+        double x[M][L];
+        for (int a = 0; a < M; ++a)
+            for (std::size_t l = 0; l < L; ++l) x[a][l] = static_cast<double>(X[a * n + i + l]);
+        for (int a = 0; a < M; ++a) {
+            for (std::size_t l = 0; l < L; ++l) xy[a][l] += x[a][l] * y[i + l];
+            for (int b = 0; b <= a; ++b)
+                for (std::size_t l = 0; l < L; ++l) xx[a][b][l] += x[a][l] * x[b][l];
+        }
+    }
+    for (std::size_t i = full; i < n; ++i) {
+        const std::size_t l = i - full;
+        for (int a = 0; a < M; ++a) {
+            const double xa = X[a * n + i];
+            xy[a][l] += xa * y[i];
+            for (int b = 0; b <= a; ++b) xx[a][b][l] += xa * static_cast<double>(X[b * n + i]);
+        }
+    }
+    for (int a = 0; a < M; ++a) {
+        Xty[a] += (xy[a][0] + xy[a][1]) + (xy[a][2] + xy[a][3]);
+        for (int b = 0; b <= a; ++b) {
+            const double s = (xx[a][b][0] + xx[a][b][1]) + (xx[a][b][2] + xx[a][b][3]);
+            XtX[a * M + b] += s;
+            if (a != b) XtX[b * M + a] += s;
+        }
+    }
+}
+
+template <int M, class T>
+void predictFixed(const T* X, const double* beta, std::size_t n, double* out) {
+    for (std::size_t i = 0; i < n; ++i) {
+        double s = 0.0;
+        for (int j = 0; j < M; ++j) s += beta[j] * static_cast<double>(X[j * n + i]);
+        out[i] = s;
+    }
+}
+
+template <class T>
+void accumulateDesign(std::span<const T> X, std::span<const double> y,
+                      std::span<double> XtX, std::span<double> Xty) {
+    const std::size_t n = y.size();
+    const int m = static_cast<int>(Xty.size());
+    if (XtX.size() != Xty.size() * Xty.size()) {
+        throw std::invalid_argument("OLSRegressor::accumulate: X'X must be m x m");
+    }
+    if (X.size() < n * static_cast<std::size_t>(m)) {
+        throw std::invalid_argument("OLSRegressor::accumulate: design matrix does not match y");
+    }
+    const bool fixed = withFixedCount(m, [&](auto M) {
+        accumulateFixed<M()>(X.data(), y.data(), n, XtX.data(), Xty.data());
+    });
+    if (fixed) return;
+
+    for (int a = 0; a < m; ++a) {
+        const T* xa = X.data() + a * n;
+        double sy = 0.0;
+        for (std::size_t i = 0; i < n; ++i) sy += static_cast<double>(xa[i]) * y[i];
+        Xty[a] += sy;
+        for (int b = 0; b <= a; ++b) {
+            const T* xb = X.data() + b * n;
+            double s = 0.0;
+            for (std::size_t i = 0; i < n; ++i) s += static_cast<double>(xa[i]) * xb[i];
+            XtX[a * m + b] += s;
+            if (a != b) XtX[b * m + a] += s;
+        }
+    }
+}
+
+template <class T>
+void predictDesign(std::span<const T> X, std::span<const double> beta, std::span<double> out) {
+    const std::size_t n = out.size();
+    const bool fixed = withFixedCount(static_cast<int>(beta.size()), [&](auto M) {
+        predictFixed<M()>(X.data(), beta.data(), n, out.data());
+    });
+    if (fixed) return;
+
+    for (std::size_t i = 0; i < n; ++i) out[i] = 0.0;
+    for (std::size_t j = 0; j < beta.size(); ++j) {
+        const T* xj = X.data() + j * n;
+        const double bj = beta[j];
+        for (std::size_t i = 0; i < n; ++i) out[i] += bj * static_cast<double>(xj[i]);
+    }
+}
+
+}
+
+// FixedOLSRegressor
+template <int M>
+void FixedOLSRegressor<M>::accumulate(const double* X, const double* y, std::size_t n,
+                                      double* XtX, double* Xty) {
+    accumulateFixed<M>(X, y, n, XtX, Xty);
+}
+
+template <int M>
+void FixedOLSRegressor<M>::accumulate(const float* X, const double* y, std::size_t n,
+                                      double* XtX, double* Xty) {
+    accumulateFixed<M>(X, y, n, XtX, Xty);
+}
+
+template <int M>
+void FixedOLSRegressor<M>::solve(const double* XtX, const double* Xty, double* beta) {
+    solveSymmetric<M>(M, XtX, Xty, beta);
+}
+
+template <int M>
+void FixedOLSRegressor<M>::predict(const double* X, const double* beta, std::size_t n,
+                                   double* out) {
+    predictFixed<M>(X, beta, n, out);
+}
+
+template <int M>
+void FixedOLSRegressor<M>::predict(const float* X, const double* beta, std::size_t n,
+                                   double* out) {
+    predictFixed<M>(X, beta, n, out);
+}
+
+template struct FixedOLSRegressor<1>;
+template struct FixedOLSRegressor<2>;
+template struct FixedOLSRegressor<3>;
+template struct FixedOLSRegressor<4>;
+template struct FixedOLSRegressor<5>;
+template struct FixedOLSRegressor<6>;
+template struct FixedOLSRegressor<7>;
+template struct FixedOLSRegressor<8>;
+template struct FixedOLSRegressor<9>;
+
+// NormalEquations
+NormalEquations::NormalEquations(int m)
+    : m(m), count(0), XtX(static_cast<std::size_t>(m) * m, 0.0), Xty(m, 0.0) {}
+
+void NormalEquations::accumulate(std::span<const double> X, std::span<const double> y) {
+    OLSRegressor::accumulate(X, y, XtX, Xty);
+    count += y.size();
+}
+
+void NormalEquations::add(const NormalEquations& other) {
+    for (std::size_t i = 0; i < XtX.size(); ++i) XtX[i] += other.XtX[i];
+    for (std::size_t i = 0; i < Xty.size(); ++i) Xty[i] += other.Xty[i];
+    count += other.count;
+}
+
+void NormalEquations::clear() {
+    std::fill(XtX.begin(), XtX.end(), 0.0);
+    std::fill(Xty.begin(), Xty.end(), 0.0);
+    count = 0;
+}
+
+// OLSRegressor
+std::vector<double> OLSRegressor::fit(std::span<const double> X,
+                                      std::span<const double> y, int m) {
+    if (m <= 0) {
+        throw std::invalid_argument("OLSRegressor::fit: need at least one regressor");
+    }
+    NormalEquations eq(m);
+    eq.accumulate(X, y);
+    return solve(eq);
+}
+
+std::vector<double> OLSRegressor::solve(const NormalEquations& eq) {
+    std::vector<double> beta(eq.m);
+    solve(eq, beta);
+    return beta;
+}
+
+void OLSRegressor::solve(const NormalEquations& eq, std::span<double> beta) {
+    solve(eq.XtX, eq.Xty, beta);
+}
+
+void OLSRegressor::accumulate(std::span<const double> X, std::span<const double> y,
+                              std::span<double> XtX, std::span<double> Xty) {
+    accumulateDesign(X, y, XtX, Xty);
+}
+
+void OLSRegressor::accumulate(std::span<const float> X, std::span<const double> y,
+                              std::span<double> XtX, std::span<double> Xty) {
+    accumulateDesign(X, y, XtX, Xty);
+}
+
+void OLSRegressor::solve(std::span<const double> XtX, std::span<const double> Xty,
+                         std::span<double> beta) {
+    const int m = static_cast<int>(Xty.size());
+    if (beta.size() != Xty.size()) {
+        throw std::invalid_argument("OLSRegressor::solve: beta must have one entry per regressor");
+    }
+    if (XtX.size() != Xty.size() * Xty.size()) {
+        throw std::invalid_argument("OLSRegressor::solve: X'X must be m x m");
+    }
+    const bool fixed = withFixedCount(m, [&](auto M) {
+        FixedOLSRegressor<M()>::solve(XtX.data(), Xty.data(), beta.data());
+    });
+    if (!fixed) solveSymmetric<0>(m, XtX.data(), Xty.data(), beta.data());
+}
+
+std::vector<double> OLSRegressor::solveNormalEquations(std::vector<double> XtX,
+                                                       std::vector<double> Xty, int m) {
+    NormalEquations eq(m);
+    eq.XtX = std::move(XtX);
+    eq.Xty = std::move(Xty);
+    return solve(eq);
+}
+
+double OLSRegressor::conditionNumber(std::span<const double> XtX) {
+    const int m = static_cast<int>(std::lround(std::sqrt(static_cast<double>(XtX.size()))));
+    if (static_cast<std::size_t>(m) * m != XtX.size()) {
+        throw std::invalid_argument("OLSRegressor::conditionNumber: X'X must be m x m");
+    }
+    std::vector<int> kept;
+    for (int i = 0; i < m; ++i) {
+        if (XtX[i * m + i] > 0.0) kept.push_back(i);
+    }
+    const int r = static_cast<int>(kept.size());
+    if (r == 0) return std::numeric_limits<double>::infinity();
+    std::vector<double> A(r * r), V(r * r);
+    for (int i = 0; i < r; ++i)
+        for (int j = 0; j < r; ++j) {
+            const int a = kept[i], b = kept[j];
+            A[i * r + j] = XtX[a * m + b] / std::sqrt(XtX[a * m + a] * XtX[b * m + b]);
+        }
+    jacobiEigen<0>(r, A.data(), V.data());
+    double lo = A[0], hi = A[0];
+    for (int k = 1; k < r; ++k) {
+        lo = std::min(lo, A[k * r + k]);
+        hi = std::max(hi, A[k * r + k]);
+    }
+    return lo > 0.0 ? hi / lo : std::numeric_limits<double>::infinity();
+}
+
+void OLSRegressor::predict(std::span<const double> X, std::span<const double> beta,
+                           std::span<double> out) {
+    predictDesign(X, beta, out);
+}
+
+void OLSRegressor::predict(std::span<const float> X, std::span<const double> beta,
+                           std::span<double> out) {
+    predictDesign(X, beta, out);
+}
+
+}
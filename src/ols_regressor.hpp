@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace lsm {
+
+//  NormalEquations  
+// - running X'X (full symmetric, row-major) and X'y for one regression.
+//   Independent blocks of observations accumulate their own partial sums,
+//   which are then merged with add(); merging in a fixed order gives the
+//   same bits no matter which thread produced which block.
+
+struct NormalEquations {
+    explicit NormalEquations(int m = 0);
+
+    // add the rows of X (column-major, y.size() rows) and y
+    void accumulate(std::span<const double> X, std::span<const double> y);
+    void add(const NormalEquations& other);
+    void clear();
+
+    int m;
+    std::size_t count;          // observations accumulated
+    std::vector<double> XtX;
+    std::vector<double> Xty;
+};
+
+//  FixedOLSRegressor<M>  
+// - the OLS kernels with the regressor count fixed at compile time: the
+//   normal equations are solved on the stack and every loop over regressors
+//   unrolls. NormalEquations and OLSRegressor dispatch here whenever
+//   m <= kMaxFixedRegressors, so small bases pay no heap or per-loop cost.
+//   Array layouts are as in NormalEquations and OLSRegressor.
+
+inline constexpr int kMaxFixedRegressors = 9;      // basis order 8 plus the constant
+
+template <int M>
+struct FixedOLSRegressor {
+    static void accumulate(const double* X, const double* y, std::size_t n,
+                           double* XtX, double* Xty);
+    static void accumulate(const float* X, const double* y, std::size_t n,
+                           double* XtX, double* Xty);
+    static void solve(const double* XtX, const double* Xty, double* beta);
+    static void predict(const double* X, const double* beta, std::size_t n, double* out);
+    static void predict(const float* X, const double* beta, std::size_t n, double* out);
+};
+
+//  OLSRegressor  
+// - ordinary least squares through the normal equations
+
+class OLSRegressor {
+public:
+    // Fit y on the m columns of X, stored column-major with y.size() rows:
+    // X[j * n + i] is regressor j at observation i. Returns beta (size m).
+    static std::vector<double> fit(std::span<const double> X,
+                                   std::span<const double> y, int m);
+
+    static std::vector<double> solve(const NormalEquations& eq);
+    static void solve(const NormalEquations& eq, std::span<double> beta);     // beta.size() == m
+
+    // The same on caller-owned storage, m = Xty.size(): accumulate adds the
+    // rows of X and y into XtX / Xty, solve writes beta. Neither allocates
+    // for m <= kMaxFixedRegressors.
+    static void accumulate(std::span<const double> X, std::span<const double> y,
+                           std::span<double> XtX, std::span<double> Xty);
+    // X stored in float (mixed precision); the sums are still in double
+    static void accumulate(std::span<const float> X, std::span<const double> y,
+                           std::span<double> XtX, std::span<double> Xty);
+    static void solve(std::span<const double> XtX, std::span<const double> Xty,
+                      std::span<double> beta);
+
+    // Solve (X'X) beta = X'y for an m x m row-major XtX. The system is
+    // scaled to a unit diagonal and solved by Cholesky; if that meets a
+    // near-zero pivot (collinear regressors) it is solved instead through
+    // the eigen-decomposition, dropping directions with eigenvalues below
+    // 1e-12 of the largest, which gives the minimum-norm least-squares fit.
+    static std::vector<double> solveNormalEquations(std::vector<double> XtX,
+                                                    std::vector<double> Xty, int m);
+
+    // 2-norm condition number of the system solveNormalEquations factors,
+    // X'X scaled to a unit diagonal (zero rows dropped); infinite when it
+    // is singular. Allocates; meant for diagnostics.
+    static double conditionNumber(std::span<const double> XtX);
+
+    // Fitted values: out[i] = sum_j beta[j] * X[j * n + i]
+    static void predict(std::span<const double> X, std::span<const double> beta,
+                        std::span<double> out);
+    static void predict(std::span<const float> X, std::span<const double> beta,
+                        std::span<double> out);
+};
+
+}
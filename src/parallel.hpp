@@ -0,0 +1,309 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace lsm {
+
+// Worker count for a requested thread setting; 0 means every hardware thread.
+inline int resolveThreadCount(int requested) {
+    if (requested > 0) return requested;
+    const unsigned hw = std::thread::hardware_concurrency();
+    return hw == 0 ? 1 : static_cast<int>(hw);
+}
+
+//  WorkStealingPool  
+// - workers with one task deque each: a worker runs its own deque newest
+//   first and, when that is empty, steals the oldest task of another. Tasks
+//   submitted from a worker go to its own deque, so the pieces a task
+//   splits off stay local unless someone is idle.
+//
+//   parallelFor() runs a loop as self-scheduled pieces: the caller and up
+//   to size() helper tasks claim pieces from a shared counter until none
+//   are left, then the caller waits for the pieces still running. Helpers
+//   that start late find nothing to claim, so an idle worker turns into
+//   extra hands for a big loop and a busy pool costs the loop nothing but
+//   a few no-op tasks. The free parallelFor() below routes here when called
+//   from a worker, which is how a pricing running as a pool task spreads
+//   its path blocks over the whole pool.
+
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int numThreads = 0) {
+        const int T = resolveThreadCount(numThreads);
+        for (int t = 0; t < T; ++t) queues_.push_back(std::make_unique<Queue>());
+        workers_.reserve(T);
+        for (int t = 0; t < T; ++t) workers_.emplace_back([this, t] { work(static_cast<std::size_t>(t)); });
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            stop_ = true;
+        }
+        ready_.notify_all();
+        for (auto& w : workers_) w.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    int size() const { return static_cast<int>(workers_.size()); }
+
+    // the pool whose worker is calling, if any
+    static WorkStealingPool* current() { return current_; }
+
+    template <class Fn>
+    std::future<std::invoke_result_t<std::decay_t<Fn>>> submit(Fn&& fn) {
+        using R = std::invoke_result_t<std::decay_t<Fn>>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<Fn>(fn));
+        auto result = task->get_future();
+        push([task] { (*task)(); });
+        return result;
+    }
+
+    // fn(begin, end) over pieces of `grain` indices covering [0, n) once
+    // each, in no particular order; grain 0 picks about four pieces per
+    // worker. The first exception is rethrown after every claimed piece
+    // has finished.
+    template <class Fn>
+    void parallelFor(std::size_t n, Fn&& fn, std::size_t grain = 0) {
+        if (n == 0) return;
+        if (grain == 0) grain = std::max<std::size_t>(1, n / (4 * workers_.size()));
+        struct Loop {
+            std::atomic<std::size_t> next{0};
+            std::atomic<std::size_t> done{0};
+            std::mutex mutex;
+            std::exception_ptr error;
+        };
+        const auto loop = std::make_shared<Loop>();
+        // never touches fn once the counter is past n, so a helper that
+        // starts after the caller returned is harmless
+        auto claim = [loop, n, grain, body = &fn] {
+            for (;;) {
+                const std::size_t begin = loop->next.fetch_add(grain);
+                if (begin >= n) return;
+                const std::size_t end = std::min(n, begin + grain);
+                try {
+                    (*body)(begin, end);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(loop->mutex);
+                    if (!loop->error) loop->error = std::current_exception();
+                }
+                loop->done.fetch_add(end - begin, std::memory_order_release);
+            }
+        };
+        const std::size_t pieces = (n + grain - 1) / grain;
+        const std::size_t helpers = std::min(workers_.size(), pieces - 1);
+        for (std::size_t h = 0; h < helpers; ++h) push(claim);
+        claim();
+        while (loop->done.load(std::memory_order_acquire) < n) std::this_thread::yield();
+        if (loop->error) std::rethrow_exception(loop->error);
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void push(std::function<void()> task) {
+        const std::size_t q = current_ == this ? index_ : nextQueue_++ % queues_.size();
+        {
+            std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+            queues_[q]->tasks.push_back(std::move(task));
+        }
+        queued_.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+        }
+        ready_.notify_one();
+    }
+
+    // own deque newest first, then the others oldest first
+    bool take(std::size_t self, std::function<void()>& task) {
+        for (std::size_t i = 0; i < queues_.size(); ++i) {
+            Queue& q = *queues_[(self + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.empty()) continue;
+            if (i == 0) {
+                task = std::move(q.tasks.back());
+                q.tasks.pop_back();
+            } else {
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+            }
+            queued_.fetch_sub(1);
+            return true;
+        }
+        return false;
+    }
+
+    void work(std::size_t self) {
+        current_ = this;
+        index_ = self;
+        for (;;) {
+            std::function<void()> task;
+            if (take(self, task)) {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            ready_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+            if (stop_ && queued_.load() == 0) return;
+        }
+    }
+
+    inline static thread_local WorkStealingPool* current_ = nullptr;
+    inline static thread_local std::size_t index_ = 0;
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::atomic<std::size_t> queued_{0};
+    std::atomic<std::size_t> nextQueue_{0};
+    std::mutex sleepMutex_;
+    std::condition_variable ready_;
+    bool stop_ = false;
+    std::vector<std::thread> workers_;
+};
+
+// Threads parallelFor(n, numThreads, ...) can keep busy: the pool's size
+// on a WorkStealingPool worker, resolveThreadCount(numThreads) elsewhere.
+// For sizing per-worker scratch.
+inline int effectiveThreadCount(int numThreads) {
+    if (const WorkStealingPool* pool = WorkStealingPool::current()) return pool->size();
+    return resolveThreadCount(numThreads);
+}
+
+// The pool behind the free parallelFor() for a given helper count, created
+// on first use and kept for the life of the process: a loop outside a pool
+// then costs a few queue operations rather than a thread start per chunk.
+inline WorkStealingPool& sharedPool(int numHelpers) {
+    static std::mutex mutex;
+    static std::map<int, std::unique_ptr<WorkStealingPool>> pools;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& pool = pools[numHelpers];
+    if (!pool) pool = std::make_unique<WorkStealingPool>(numHelpers);
+    return *pool;
+}
+
+// Split [0, n) into numThreads contiguous chunks and run fn(begin, end) on
+// each: the caller and the numThreads - 1 workers of sharedPool() claim
+// chunks until none are left. Chunk c is always [c*n/T, (c+1)*n/T), so
+// callers that index per-chunk state get the same layout on every run.
+// The first exception thrown by any chunk is rethrown on the caller.
+//
+// Called on a WorkStealingPool worker the loop runs through the pool's
+// parallelFor instead, whatever numThreads says, in pieces that need not
+// line up with those chunks: fn must only rely on visiting every index
+// once.
+template <class Fn>
+void parallelFor(std::size_t n, int numThreads, Fn&& fn) {
+    if (WorkStealingPool* pool = WorkStealingPool::current()) {
+        pool->parallelFor(n, fn);
+        return;
+    }
+    const int threads = resolveThreadCount(numThreads);
+    const std::size_t T = std::max<std::size_t>(1, std::min<std::size_t>(static_cast<std::size_t>(threads), n));
+    if (T == 1) {
+        fn(std::size_t{0}, n);
+        return;
+    }
+    // keyed on the thread setting, not T, so short loops share the pool
+    sharedPool(threads - 1).parallelFor(T, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t c = lo; c < hi; ++c) fn(c * n / T, (c + 1) * n / T);
+    }, 1);
+}
+
+//  ThreadPool  
+// - a fixed set of workers running submitted tasks in FIFO order, for
+//   independent jobs of uneven length (whole pricings, say) where
+//   parallelFor's static chunks would idle. submit() returns a future that
+//   carries the task's value or exception. Tasks must not wait on futures
+//   of the same pool. The destructor finishes every queued task.
+
+class ThreadPool {
+public:
+    explicit ThreadPool(int numThreads = 0) {
+        const int T = resolveThreadCount(numThreads);
+        workers_.reserve(T);
+        for (int t = 0; t < T; ++t) workers_.emplace_back([this] { work(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        ready_.notify_all();
+        for (auto& w : workers_) w.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return static_cast<int>(workers_.size()); }
+
+    template <class Fn>
+    std::future<std::invoke_result_t<std::decay_t<Fn>>> submit(Fn&& fn) {
+        using R = std::invoke_result_t<std::decay_t<Fn>>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<Fn>(fn));
+        auto result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.emplace_back([task] { (*task)(); });
+        }
+        ready_.notify_one();
+        return result;
+    }
+
+private:
+    void work() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+                if (queue_.empty()) return;
+                task = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::function<void()>> queue_;
+    bool stop_ = false;
+    std::vector<std::thread> workers_;
+};
+
+// job(i) for each i in [0, n) as tasks on pool, results in index order.
+// Every task finishes before the first failure is rethrown, so jobs may
+// reference the caller's frame.
+template <class Job>
+auto runTasks(ThreadPool& pool, std::size_t n, Job&& job) {
+    using R = std::invoke_result_t<Job&, std::size_t>;
+    std::vector<std::future<R>> pending;
+    pending.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) pending.push_back(pool.submit([&job, i] { return job(i); }));
+    for (auto& f : pending) f.wait();
+    std::vector<R> results;
+    results.reserve(n);
+    for (auto& f : pending) results.push_back(f.get());
+    return results;
+}
+
+}
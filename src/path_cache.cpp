@@ -0,0 +1,119 @@
+#include "path_cache.hpp"
+#include <sstream>
+
+namespace lsm {
+
+PathCache::PathCache(std::size_t maxBytes) : maxBytes_(maxBytes) {}
+
+std::string PathCache::makeKey(const StochasticProcess& process, const LSMConfig& cfg,
+                               double S0, std::uint64_t seed) {
+    return makeKey(process.cacheKey(), cfg, S0, seed);
+}
+
+std::string PathCache::makeKey(const std::string& proc, const LSMConfig& cfg,
+                               double S0, std::uint64_t seed) {
+    if (proc.empty()) return {};
+
+    // hexfloat keeps every bit of the doubles; numThreads is left out since
+    // paths do not depend on it
+    std::ostringstream key;
+    key << std::hexfloat << proc
+        << "|S0=" << S0
+        << "|N=" << cfg.numPaths
+        << "|D=" << cfg.numExerciseDates
+        << "|T=" << cfg.maturity
+        << "|anti=" << cfg.useAntithetic
+        << "|scheme=" << static_cast<int>(cfg.samplingScheme)
+        << "|reps=" << (cfg.samplingScheme == SamplingScheme::Sobol ? cfg.qmcReplicates : 0)
+        << "|prec=" << static_cast<int>(cfg.pathPrecision)
+        << "|seed=" << seed;
+    return key.str();
+}
+
+std::shared_ptr<const PathMatrix> PathCache::find(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) return nullptr;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->paths;
+}
+
+std::shared_ptr<const PathMatrix> PathCache::getOrSimulate(const std::string& key,
+                                                           const std::function<PathMatrix()>& simulate) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            ++hits_;
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return it->second->paths;
+        }
+        ++misses_;
+    }
+
+    // simulate outside the lock; if another thread raced us to the same
+    // key, keep its grid so every caller shares one copy
+    auto paths = std::make_shared<const PathMatrix>(simulate());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) return it->second->paths;
+    if (paths->bytes() > maxBytes_) return paths;
+
+    lru_.push_front({key, paths});
+    index_[key] = lru_.begin();
+    bytesUsed_ += paths->bytes();
+    evictToFit();
+    return paths;
+}
+
+void PathCache::insert(const std::string& key, std::shared_ptr<const PathMatrix> paths) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        if (!it->second->pinned) bytesUsed_ -= it->second->paths->bytes();
+        lru_.erase(it->second);
+    }
+    lru_.push_front({key, std::move(paths), true});
+    index_[key] = lru_.begin();
+}
+
+void PathCache::evictToFit() {
+    // least recently used first, passing over pinned grids
+    for (auto it = lru_.end(); bytesUsed_ > maxBytes_ && it != lru_.begin();) {
+        --it;
+        if (it->pinned) continue;
+        bytesUsed_ -= it->paths->bytes();
+        index_.erase(it->key);
+        it = lru_.erase(it);
+    }
+}
+
+void PathCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    index_.clear();
+    bytesUsed_ = 0;
+}
+
+std::size_t PathCache::bytesUsed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytesUsed_;
+}
+
+std::size_t PathCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+}
+
+std::size_t PathCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+std::size_t PathCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "lsm_types.hpp"
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace lsm {
+
+//  PathCache  
+// - simulated grids shared between pricers, keyed on everything the paths
+//   depend on: process parameters, spot, time grid, path count, sampling
+//   options and seed. Least-recently-used grids are evicted once the total
+//   size passes maxBytes; a grid still held by a pricer stays alive until
+//   released. Safe to share between threads.
+
+class PathCache {
+public:
+    explicit PathCache(std::size_t maxBytes = std::size_t(1) << 30);
+
+    // Key for the grid a process would simulate under cfg from S0, or an
+    // empty string when the process has no cacheKey()
+    static std::string makeKey(const StochasticProcess& process, const LSMConfig& cfg,
+                               double S0, std::uint64_t seed);
+    // the same from a process's cacheKey()
+    static std::string makeKey(const std::string& processKey, const LSMConfig& cfg,
+                               double S0, std::uint64_t seed);
+
+    std::shared_ptr<const PathMatrix> find(const std::string& key);
+
+    // Cached grid for key, simulating and inserting it on a miss. Grids
+    // larger than the whole budget are returned without being kept.
+    std::shared_ptr<const PathMatrix> getOrSimulate(const std::string& key,
+                                                    const std::function<PathMatrix()>& simulate);
+
+    // Pin paths as the grid for key, replacing any cached one: pinned grids
+    // (mapped PathFiles, typically) count against no budget and are never
+    // evicted, only dropped by clear()
+    void insert(const std::string& key, std::shared_ptr<const PathMatrix> paths);
+
+    void clear();
+
+    std::size_t bytesUsed() const;
+    std::size_t size() const;
+    std::size_t hits() const;
+    std::size_t misses() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const PathMatrix> paths;
+        bool pinned = false;
+    };
+
+    void evictToFit();
+
+    std::size_t maxBytes_;
+    std::size_t bytesUsed_ = 0;
+    std::size_t hits_ = 0;
+    std::size_t misses_ = 0;
+    std::list<Entry> lru_;          // front = most recently used
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    mutable std::mutex mutex_;
+};
+
+}
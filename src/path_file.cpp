@@ -0,0 +1,164 @@
+#include "path_file.hpp"
+#include "path_cache.hpp"
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lsm {
+
+namespace {
+
+constexpr char kMagic[8] = {'L', 'S', 'M', 'P', 'A', 'T', 'H', 'S'};
+
+std::size_t elementSize(PathPrecision precision) {
+    return precision == PathPrecision::Double ? sizeof(double) : sizeof(float);
+}
+
+// a read-only mapping of a whole file, unmapped with its last owner
+struct Mapping {
+    void* addr = MAP_FAILED;
+    std::size_t size = 0;
+
+    ~Mapping() {
+        if (addr != MAP_FAILED) ::munmap(addr, size);
+    }
+};
+
+std::runtime_error fileError(const std::string& filename, const std::string& what) {
+    return std::runtime_error("PathFile: " + filename + ": " + what);
+}
+
+}
+
+// PathFile
+void PathFile::write(const std::string& filename, const PathMatrix& paths,
+                     const StochasticProcess& process, const LSMConfig& cfg,
+                     double S0, std::uint64_t seed) {
+    const std::string key = process.cacheKey();
+    if (key.empty()) {
+        throw std::invalid_argument("PathFile: " + process.name() + " has no cacheKey() to record");
+    }
+    if (paths.numPaths() != static_cast<std::size_t>(cfg.numPaths) ||
+        paths.numDates() != static_cast<std::size_t>(cfg.numExerciseDates) + 1 ||
+        paths.precision() != cfg.pathPrecision) {
+        throw std::invalid_argument("PathFile: grid shape does not match the config");
+    }
+
+    PathFileHeader h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.byteOrder = kByteOrderMark;
+    h.dataOffset = (sizeof(PathFileHeader) + key.size() + kPageSize - 1) / kPageSize * kPageSize;
+    h.numPaths = paths.numPaths();
+    h.numDates = paths.numDates();
+    h.rowStride = paths.rowStride();
+    h.precision = static_cast<std::uint32_t>(paths.precision());
+    h.samplingScheme = static_cast<std::uint32_t>(cfg.samplingScheme);
+    h.numExerciseDates = cfg.numExerciseDates;
+    h.qmcReplicates = cfg.qmcReplicates;
+    h.useAntithetic = cfg.useAntithetic;
+    h.maturity = cfg.maturity;
+    h.riskFreeRate = cfg.riskFreeRate;
+    h.spot = S0;
+    h.seed = seed;
+    h.processKeyBytes = key.size();
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out) throw fileError(filename, "cannot open for writing");
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(key.data(), static_cast<std::streamsize>(key.size()));
+    const std::vector<char> pad(h.dataOffset - sizeof(h) - key.size(), 0);
+    out.write(pad.data(), static_cast<std::streamsize>(pad.size()));
+    // rows are contiguous, padding included
+    if (paths.bytes() > 0) {
+        const char* rows = paths.precision() == PathPrecision::Double
+                               ? reinterpret_cast<const char*>(paths.doubleRow(0))
+                               : reinterpret_cast<const char*>(paths.floatRow(0));
+        out.write(rows, static_cast<std::streamsize>(paths.bytes()));
+    }
+    out.close();
+    if (!out) throw fileError(filename, "write failed");
+}
+
+PathFile::PathFile(const std::string& filename) {
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw fileError(filename, "cannot open");
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw fileError(filename, "cannot stat");
+    }
+    auto mapping = std::make_shared<Mapping>();
+    mapping->size = static_cast<std::size_t>(st.st_size);
+    if (mapping->size >= sizeof(PathFileHeader)) {
+        mapping->addr = ::mmap(nullptr, mapping->size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (mapping->addr == MAP_FAILED) throw fileError(filename, "cannot map (or too short)");
+
+    const auto* base = static_cast<const std::byte*>(mapping->addr);
+    std::memcpy(&header_, base, sizeof(header_));
+    const PathFileHeader& h = header_;
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0) throw fileError(filename, "not a path file");
+    if (h.byteOrder != kByteOrderMark) throw fileError(filename, "written with another byte order");
+    if (h.version != kVersion) {
+        throw fileError(filename, "format version " + std::to_string(h.version) + ", expected " +
+                                      std::to_string(kVersion));
+    }
+    // the key must fit between the header and the data, checked without
+    // summing a corrupt length that could wrap
+    if (h.precision > static_cast<std::uint32_t>(PathPrecision::Float) ||
+        h.samplingScheme > static_cast<std::uint32_t>(SamplingScheme::Sobol) ||
+        h.dataOffset % kPageSize != 0 || h.dataOffset < sizeof(h) ||
+        h.processKeyBytes > h.dataOffset - sizeof(h)) {
+        throw fileError(filename, "corrupt header");
+    }
+    // the grid must be the one config() describes, or a pricer finding it
+    // under cacheKey() reads past its rows
+    if (h.numExerciseDates < 1 || h.numDates != static_cast<std::uint64_t>(h.numExerciseDates) + 1 ||
+        h.numPaths < 1 || h.numPaths > static_cast<std::uint64_t>(std::numeric_limits<int>::max()) ||
+        h.rowStride < h.numPaths ||
+        h.rowStride > std::numeric_limits<std::uint64_t>::max() / sizeof(double) / h.numDates) {
+        throw fileError(filename, "corrupt header");
+    }
+    const auto precision = static_cast<PathPrecision>(h.precision);
+    const std::uint64_t dataBytes = h.numDates * h.rowStride * elementSize(precision);
+    if (h.dataOffset > mapping->size || dataBytes != mapping->size - h.dataOffset) {
+        throw fileError(filename, "size does not match the header");
+    }
+
+    processKey_.assign(reinterpret_cast<const char*>(base + sizeof(h)), h.processKeyBytes);
+    paths_ = std::make_shared<const PathMatrix>(PathMatrix::view(
+        h.numPaths, h.numDates, h.rowStride, precision, base + h.dataOffset, mapping));
+}
+
+LSMConfig PathFile::config() const {
+    LSMConfig cfg;
+    cfg.numPaths = static_cast<int>(header_.numPaths);
+    cfg.numExerciseDates = header_.numExerciseDates;
+    cfg.maturity = header_.maturity;
+    cfg.riskFreeRate = header_.riskFreeRate;
+    cfg.useAntithetic = header_.useAntithetic != 0;
+    cfg.rngSeed = header_.seed;
+    cfg.pathPrecision = static_cast<PathPrecision>(header_.precision);
+    cfg.samplingScheme = static_cast<SamplingScheme>(header_.samplingScheme);
+    cfg.qmcReplicates = header_.qmcReplicates;
+    return cfg;
+}
+
+std::string PathFile::cacheKey() const {
+    return PathCache::makeKey(processKey_, config(), header_.spot, header_.seed);
+}
+
+void PathFile::addTo(PathCache& cache) const {
+    cache.insert(cacheKey(), paths_);
+}
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "lsm_types.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace lsm {
+
+class PathCache;
+
+//  PathFileHeader  
+// - fixed leading record of a path file, in native byte order. After it
+//   come processKeyBytes of the process's cacheKey(), then zero padding
+//   up to dataOffset (a multiple of kPageSize), then the grid's numDates
+//   rows of rowStride elements exactly as PathMatrix holds them.
+
+struct PathFileHeader {
+    char magic[8];                      // "LSMPATHS"
+    std::uint32_t version;
+    std::uint32_t byteOrder;            // kByteOrderMark as written
+    std::uint64_t dataOffset;
+    std::uint64_t numPaths;
+    std::uint64_t numDates;             // including t = 0
+    std::uint64_t rowStride;            // elements
+    std::uint32_t precision;            // PathPrecision
+    std::uint32_t samplingScheme;       // SamplingScheme
+    std::int32_t numExerciseDates;
+    std::int32_t qmcReplicates;
+    std::uint32_t useAntithetic;
+    std::uint32_t reserved;
+    double maturity;
+    double riskFreeRate;
+    double spot;                        // S0 the paths start from
+    std::uint64_t seed;
+    std::uint64_t processKeyBytes;
+};
+
+//  PathFile  
+// - a simulated grid on disk, so one simulation can feed pricing jobs in
+//   other processes. write() stores the grid with everything it depends
+//   on; opening a file maps it read-only and paths() is a PathMatrix view
+//   straight onto the mapping. Processes on one node mapping the same file
+//   share its page-cache copy rather than each holding the grid.
+//
+//   A pricer picks the grid up through a PathCache: addTo() pins it under
+//   the key the pricer's own lookup computes, so backward induction reads
+//   the mapped rows in place. Files that do not match (other parameters,
+//   another version or byte order) are rejected on open or never hit.
+
+class PathFile {
+public:
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr std::uint32_t kByteOrderMark = 0x01020304u;
+    static constexpr std::size_t kPageSize = 4096;
+
+    // Write paths, simulated by process under cfg from S0 with seed (as
+    // LSMPricer::simulatePaths returns them); the process must have a
+    // cacheKey(). Throws std::runtime_error on I/O failure.
+    static void write(const std::string& filename, const PathMatrix& paths,
+                      const StochasticProcess& process, const LSMConfig& cfg,
+                      double S0, std::uint64_t seed);
+
+    // Map filename read-only; throws std::runtime_error when it cannot be
+    // read or is not a path file of this version and byte order
+    explicit PathFile(const std::string& filename);
+
+    const PathFileHeader& header() const { return header_; }
+    const std::string& processKey() const { return processKey_; }
+
+    // the stored settings: grid, sampling, precision and seed (numThreads
+    // and the pricing-only options keep their defaults)
+    LSMConfig config() const;
+
+    // PathCache::makeKey of the stored process, settings, spot and seed
+    std::string cacheKey() const;
+
+    // view of the mapped grid; holding it keeps the mapping alive
+    std::shared_ptr<const PathMatrix> paths() const { return paths_; }
+
+    // pin paths() in cache under cacheKey()
+    void addTo(PathCache& cache) const;
+
+private:
+    PathFileHeader header_;
+    std::string processKey_;
+    std::shared_ptr<const PathMatrix> paths_;
+};
+
+}
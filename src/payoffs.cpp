@@ -0,0 +1,61 @@
+#include "payoffs.hpp"
+
+namespace lsm {
+
+// PutPayoff
+PutPayoff::PutPayoff(double K) {
+    if (K <= 0.0) {
+        throw std::invalid_argument("strike must be > 0");
+    }
+    K_ = K;
+}
+
+double PutPayoff::evaluate(double spot) const {
+    return std::max(K_ - spot, 0.0);
+}
+
+void PutPayoff::evaluateBatch(std::span<const double> spots, std::span<double> out) const {
+    for (std::size_t i = 0; i < spots.size(); ++i) out[i] = std::max(K_ - spots[i], 0.0);
+}
+
+double PutPayoff::derivative(double spot) const {
+    return spot < K_ ? -1.0 : 0.0;
+}
+
+double PutPayoff::strike() const {
+    return K_;
+}
+
+std::string PutPayoff::name() const {
+    return "Put(K=" + std::to_string(K_) + ")";
+}
+
+// CallPayoff
+CallPayoff::CallPayoff(double K) {
+    if (K <= 0.0) {
+        throw std::invalid_argument("strike must be > 0");
+    }
+    K_ = K;
+}
+
+double CallPayoff::evaluate(double spot) const {
+    return std::max(spot - K_, 0.0);
+}
+
+void CallPayoff::evaluateBatch(std::span<const double> spots, std::span<double> out) const {
+    for (std::size_t i = 0; i < spots.size(); ++i) out[i] = std::max(spots[i] - K_, 0.0);
+}
+
+double CallPayoff::derivative(double spot) const {
+    return spot > K_ ? 1.0 : 0.0;
+}
+
+double CallPayoff::strike() const {
+    return K_;
+}
+
+std::string CallPayoff::name() const {
+    return "Call(K=" + std::to_string(K_) + ")";
+}
+
+}
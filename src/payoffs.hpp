@@ -0,0 +1,44 @@
+#pragma once
+
+#include "lsm_types.hpp"
+#include <algorithm>
+#include <string>
+#include <stdexcept>
+
+namespace lsm {
+
+//  PutPayoff  
+// - max(K - S, 0)
+
+class PutPayoff : public Payoff {
+public:
+    PutPayoff(double K);
+
+    double evaluate(double spot) const;
+    void evaluateBatch(std::span<const double> spots, std::span<double> out) const;
+    double derivative(double spot) const;
+    double strike() const;
+    std::string name() const;
+
+private:
+    double K_;
+};
+
+//  CallPayoff  
+// - max(S - K, 0)
+
+class CallPayoff : public Payoff {
+public:
+    CallPayoff(double K);
+
+    double evaluate(double spot) const;
+    void evaluateBatch(std::span<const double> spots, std::span<double> out) const;
+    double derivative(double spot) const;
+    double strike() const;
+    std::string name() const;
+
+private:
+    double K_;
+};
+
+}
@@ -0,0 +1,62 @@
+#include "portfolio_pricer.hpp"
+#include <cmath>
+#include <stdexcept>
+
+namespace lsm {
+
+// PortfolioPricer
+PortfolioPricer::PortfolioPricer(const LSMConfig& cfg,
+                                 std::unique_ptr<StochasticProcess> process,
+                                 BasisFamily basis)
+    : cfg_(cfg), process_(std::move(process)), basis_(basis) {
+    if (!process_) {
+        throw std::invalid_argument("PortfolioPricer: process is required");
+    }
+    if (cfg_.numExerciseDates <= 0 || cfg_.maturity <= 0.0) {
+        throw std::invalid_argument("LSMConfig: numExerciseDates and maturity must be > 0");
+    }
+}
+
+std::size_t PortfolioPricer::addContract(std::unique_ptr<Payoff> payoff, double maturity) {
+    const double dt = cfg_.maturity / cfg_.numExerciseDates;
+    const double steps = std::round(maturity / dt);
+    if (!(maturity > 0.0) || steps < 1.0 || std::abs(steps * dt - maturity) > 1e-9 * maturity) {
+        throw std::invalid_argument("PortfolioPricer: maturity must be a positive multiple of the time step");
+    }
+    LSMConfig cfg = cfg_;
+    cfg.maturity = maturity;
+    cfg.numExerciseDates = static_cast<int>(steps);
+    contracts_.push_back(LSMPricer(LSMPricer::SharedProcess{}, cfg, process_, std::move(payoff), basis_));
+    if (contracts_.back().config().numExerciseDates > contracts_[longest_].config().numExerciseDates) {
+        longest_ = contracts_.size() - 1;
+    }
+    return contracts_.size() - 1;
+}
+
+std::vector<SimulationResult> PortfolioPricer::price(double S0) const {
+    std::vector<SimulationResult> results;
+    results.reserve(contracts_.size());
+    if (contracts_.empty()) return results;
+
+    PricingWorkspace local;
+    PricingWorkspace& ws = workspace_ ? *workspace_ : local;
+    ws.reset();
+    const LSMPricer& longest = contracts_[longest_];
+    if (cfg_.lowMemory) {
+        const int horizon = longest.config().numExerciseDates;
+        for (const auto& c : contracts_) {
+            results.push_back(c.profiled(ws, [&] { return c.fitAndPrice(S0, nullptr, ws, horizon); }));
+            ws.reset();
+        }
+        return results;
+    }
+
+    const auto paths = longest.grid(S0, longest.config().rngSeed, ws);
+    for (const auto& c : contracts_) {
+        ws.reset();         // the grid is not arena memory
+        results.push_back(c.profiled(ws, [&] { return c.priceOn(*paths, S0, ws); }));
+    }
+    return results;
+}
+
+}
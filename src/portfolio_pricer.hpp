@@ -0,0 +1,56 @@
+#pragma once
+
+#include "lsm_pricer.hpp"
+#include <memory>
+#include <vector>
+
+namespace lsm {
+
+//  PortfolioPricer  
+// - many Bermudan / American contracts on one underlying priced from one
+//   simulation. cfg fixes the time step (maturity / numExerciseDates) and
+//   every other setting; each contract brings its own payoff and a
+//   maturity on that step. The grid is simulated once to the longest
+//   maturity and each contract runs its own backward induction on the
+//   dates up to its maturity.
+//
+//   Contracts at the longest maturity price exactly as their standalone
+//   LSMPricer would. Shorter ones see the first dates of the longer paths:
+//   the processes build paths from the end point back, so these differ
+//   from (but are distributed like) the paths a standalone pricer draws,
+//   and their prices agree within the standard error. Low-memory mode
+//   regenerates the same horizon paths per contract, so it holds no grid
+//   yet matches the stored-grid prices bit for bit. With cfg.profile each
+//   result's profile covers its own contract; the shared simulation is in
+//   none of them.
+
+class PortfolioPricer {
+public:
+    PortfolioPricer(const LSMConfig& cfg,
+                    std::unique_ptr<StochasticProcess> process,
+                    BasisFamily basis);
+
+    // Add a contract expiring after `maturity` years, a positive multiple
+    // of the time step up to rounding; returns its index in price()
+    std::size_t addContract(std::unique_ptr<Payoff> payoff, double maturity);
+
+    std::size_t size() const { return contracts_.size(); }
+
+    // one result per contract, in the order they were added
+    std::vector<SimulationResult> price(double S0) const;
+
+    // reuse ws for every call's scratch memory and grid (nullptr detaches)
+    void setWorkspace(std::shared_ptr<PricingWorkspace> ws) { workspace_ = std::move(ws); }
+
+    const LSMConfig& config() const { return cfg_; }
+
+private:
+    LSMConfig cfg_;
+    std::shared_ptr<const StochasticProcess> process_;
+    BasisFamily basis_;
+    std::vector<LSMPricer> contracts_;
+    std::size_t longest_ = 0;               // simulates the shared grid
+    std::shared_ptr<PricingWorkspace> workspace_;
+};
+
+}
@@ -0,0 +1,60 @@
+#include "pricing_profile.hpp"
+#include <cmath>
+#include <sstream>
+
+namespace lsm {
+
+namespace {
+
+// JSON has no infinity: an unsolvable system reports null
+void writeNumber(std::ostream& os, double v) {
+    if (std::isfinite(v)) os << v;
+    else os << "null";
+}
+
+template <class T>
+void writeArray(std::ostream& os, const std::vector<T>& values) {
+    os << '[';
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (i) os << ',';
+        writeNumber(os, static_cast<double>(values[i]));
+    }
+    os << ']';
+}
+
+}
+
+// PricingProfile
+const char* PricingProfile::stageName(Stage stage) {
+    switch (stage) {
+        case Simulation: return "simulation";
+        case Basis: return "basis";
+        case Regression: return "regression";
+        case Exercise: return "exercise";
+        default: return "unknown";
+    }
+}
+
+std::string PricingProfile::toJson() const {
+    std::ostringstream os;
+    os.precision(17);
+    os << "{\"totalSeconds\":";
+    writeNumber(os, totalSeconds);
+    os << ",\"stageSeconds\":{";
+    for (int s = 0; s < kNumStages; ++s) {
+        if (s) os << ',';
+        os << '"' << stageName(static_cast<Stage>(s)) << "\":";
+        writeNumber(os, stageSeconds[s]);
+    }
+    os << "},\"regressions\":" << regressions
+       << ",\"itmPaths\":";
+    writeArray(os, itmPaths);
+    os << ",\"conditionNumbers\":";
+    writeArray(os, conditionNumbers);
+    os << ",\"workspaceBytes\":" << workspaceBytes
+       << ",\"heapAllocations\":" << heapAllocations
+       << ",\"numThreads\":" << numThreads << '}';
+    return os.str();
+}
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Instrumentation is compiled in with LSM_PROFILING=1 (CMake option
+// LSM_ENABLE_PROFILING); without it LSMConfig::profile has no effect and
+// the timers below are empty.
+#ifndef LSM_PROFILING
+#define LSM_PROFILING 0
+#endif
+
+namespace lsm {
+
+//  PricingProfile  
+// - where one pricing call spent its time and memory, filled when
+//   LSMConfig::profile is set. Stage seconds are summed over worker
+//   threads (with T threads they can add up to T times totalSeconds):
+//     Simulation  path generation, and reading or regenerating spots
+//     Basis       basis evaluation into the design matrices
+//     Regression  normal-equation sums, their reduction and the solves
+//     Exercise    payoffs, continuation values and exercise decisions
+//   Per-date vectors run over dates 0 .. numExerciseDates.
+
+struct PricingProfile {
+    enum Stage { Simulation, Basis, Regression, Exercise, kNumStages };
+    static const char* stageName(Stage stage);
+
+    double totalSeconds = 0.0;                      // wall time of the call
+    std::array<double, kNumStages> stageSeconds{};
+    std::size_t regressions = 0;
+    std::vector<std::size_t> itmPaths;              // in-the-money paths per date
+    std::vector<double> conditionNumbers;           // of X'X per date; 0 where none was solved
+    std::size_t workspaceBytes = 0;                 // arena bytes the call carved out
+    std::size_t heapAllocations = 0;                // arena chunks and grid buffers allocated
+    int numThreads = 1;
+
+    // one JSON object, keys as the members above
+    std::string toJson() const;
+};
+
+//  StageTimer  
+// - adds the seconds between construction and destruction to *sink; does
+//   nothing (not even read the clock) for a null sink
+
+class StageTimer {
+public:
+#if LSM_PROFILING
+    explicit StageTimer(double* sink) : sink_(sink) {
+        if (sink_) start_ = std::chrono::steady_clock::now();
+    }
+    ~StageTimer() {
+        if (sink_) *sink_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+#else
+    explicit StageTimer(double*) {}
+#endif
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+#if LSM_PROFILING
+private:
+    double* sink_;
+    std::chrono::steady_clock::time_point start_;
+#endif
+};
+
+}
@@ -0,0 +1,50 @@
+#include "pricing_scheduler.hpp"
+#include "lsm_pricer.hpp"
+#include <algorithm>
+#include <exception>
+#include <numeric>
+
+namespace lsm {
+
+// PricingScheduler
+PricingScheduler::PricingScheduler(int numThreads) : pool_(numThreads) {}
+
+std::vector<SimulationResult> PricingScheduler::run(std::vector<PricingTask> tasks) {
+    const std::size_t n = tasks.size();
+    std::vector<SimulationResult> results(n);
+    std::vector<std::exception_ptr> errors(n);
+    if (n == 0) return results;
+
+    // largest first, so the long tasks start early and the short ones fill
+    // in around them
+    auto cost = [&](std::size_t i) {
+        return static_cast<double>(tasks[i].config.numPaths) * tasks[i].config.numExerciseDates;
+    };
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return cost(a) > cost(b); });
+
+    // the claiming loop runs on a worker, so the pricings' own loops
+    // spread over the pool too
+    pool_.submit([&] {
+        pool_.parallelFor(n, [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t i = lo; i < hi; ++i) {
+                PricingTask& task = tasks[order[i]];
+                try {
+                    const LSMPricer pricer(LSMPricer::SharedProcess{}, task.config, task.process,
+                                           std::move(task.payoff), task.basis);
+                    results[order[i]] = pricer.price(task.spot);
+                } catch (...) {
+                    errors[order[i]] = std::current_exception();
+                }
+            }
+        }, 1);
+    }).get();
+
+    for (auto& e : errors) {
+        if (e) std::rethrow_exception(e);
+    }
+    return results;
+}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "basis_functions.hpp"
+#include "lsm_types.hpp"
+#include "parallel.hpp"
+#include <memory>
+#include <vector>
+
+namespace lsm {
+
+//  PricingTask  
+// - one independent pricing: config, process, payoff, basis and spot. The
+//   process is shared, so a grid of tasks on one model holds it once.
+
+struct PricingTask {
+    LSMConfig config;
+    std::shared_ptr<const StochasticProcess> process;
+    std::unique_ptr<Payoff> payoff;
+    BasisFamily basis;
+    double spot = 0.0;
+};
+
+//  PricingScheduler  
+// - prices a list of tasks on a WorkStealingPool. Tasks are claimed one at
+//   a time, largest (numPaths x numExerciseDates) first, and each runs on a
+//   worker, where its simulation tiles and backward-sweep blocks become
+//   stealable pieces of the pool: while tasks remain every worker prices
+//   its own, and once they run out idle workers join the ones still
+//   running. A task's cfg.numThreads is therefore ignored.
+//
+//   Every result is bit-identical to LSMPricer::price() on the same task
+//   run serially, as blocks are reduced in order however they were spread.
+//   Results come back in submission order; if tasks throw, the first
+//   failure in that order is rethrown after all of them have finished.
+
+class PricingScheduler {
+public:
+    explicit PricingScheduler(int numThreads = 0);
+
+    int numThreads() const { return pool_.size(); }
+
+    std::vector<SimulationResult> run(std::vector<PricingTask> tasks);
+
+private:
+    WorkStealingPool pool_;
+};
+
+}
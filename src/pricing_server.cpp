@@ -0,0 +1,363 @@
+#include "pricing_server.hpp"
+#include "lsm_pricer.hpp"
+#include "path_cache.hpp"
+#include "payoffs.hpp"
+#include "pricing_workspace.hpp"
+#include "stochastic_processes.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iomanip>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace lsm {
+
+namespace {
+
+double toDouble(const std::string& key, const std::string& value) {
+    double v = 0.0;
+    const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), v);
+    if (ec != std::errc() || end != value.data() + value.size() || !std::isfinite(v)) {
+        throw std::invalid_argument("QuoteRequest: " + key + "=" + value + " is not a number");
+    }
+    return v;
+}
+
+// what the unit-spot grid depends on: contracts agreeing on it read the
+// same PathCache entry. hexfloat, so keys agree exactly when the doubles do
+std::string gridKey(const QuoteRequest& req) {
+    std::ostringstream key;
+    key << std::hexfloat << (req.jumps ? "jd" : "gbm") << ' ' << req.sigma;
+    if (req.jumps) key << ' ' << req.lambda << ' ' << req.jumpMean << ' ' << req.jumpVol;
+    const LSMConfig& cfg = req.config;
+    key << ' ' << cfg.riskFreeRate << ' ' << cfg.maturity << ' ' << cfg.numPaths << ' ' << cfg.numExerciseDates
+        << ' ' << cfg.rngSeed << ' ' << cfg.useAntithetic;
+    return key.str();
+}
+
+long long toInteger(const std::string& key, const std::string& value) {
+    long long v = 0;
+    const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), v);
+    if (ec != std::errc() || end != value.data() + value.size()) {
+        throw std::invalid_argument("QuoteRequest: " + key + "=" + value + " is not an integer");
+    }
+    return v;
+}
+
+// nearest-rank percentile of v, which it reorders
+double percentile(std::vector<double>& v, double p) {
+    if (v.empty()) return 0.0;
+    const auto rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(v.size())));
+    const auto nth = v.begin() + static_cast<std::ptrdiff_t>(std::max<std::size_t>(rank, 1) - 1);
+    std::nth_element(v.begin(), nth, v.end());
+    return *nth;
+}
+
+}
+
+// QuoteRequest
+QuoteRequest QuoteRequest::parse(const std::string& line) {
+    QuoteRequest req;
+    bool haveSpot = false;
+    std::istringstream in(line);
+    std::string token;
+    while (in >> token) {
+        const auto eq = token.find('=');
+        if (eq == std::string::npos || eq == 0) {
+            throw std::invalid_argument("QuoteRequest: expected key=value, got " + token);
+        }
+        const std::string key = token.substr(0, eq), value = token.substr(eq + 1);
+        if (key == "id") req.id = value;
+        else if (key == "S") { req.spot = toDouble(key, value); haveSpot = true; }
+        else if (key == "K") req.strike = toDouble(key, value);
+        else if (key == "type") {
+            if (value != "put" && value != "call") {
+                throw std::invalid_argument("QuoteRequest: type must be put or call");
+            }
+            req.call = value == "call";
+        } else if (key == "process") {
+            if (value != "gbm" && value != "jd") {
+                throw std::invalid_argument("QuoteRequest: process must be gbm or jd");
+            }
+            req.jumps = value == "jd";
+        } else if (key == "r") req.config.riskFreeRate = toDouble(key, value);
+        else if (key == "sigma") req.sigma = toDouble(key, value);
+        else if (key == "lambda") req.lambda = toDouble(key, value);
+        else if (key == "jumpMean") req.jumpMean = toDouble(key, value);
+        else if (key == "jumpVol") req.jumpVol = toDouble(key, value);
+        else if (key == "T") req.config.maturity = toDouble(key, value);
+        else if (key == "paths") req.config.numPaths = static_cast<int>(toInteger(key, value));
+        else if (key == "dates") req.config.numExerciseDates = static_cast<int>(toInteger(key, value));
+        else if (key == "seed") req.config.rngSeed = static_cast<std::uint64_t>(toInteger(key, value));
+        else if (key == "antithetic") req.config.useAntithetic = toInteger(key, value) != 0;
+        else if (key == "M") req.numTerms = static_cast<int>(toInteger(key, value));
+        else if (key == "basis") {
+            if (value == "laguerre") req.basis = BasisFamilyType::Laguerre;
+            else if (value == "monomial") req.basis = BasisFamilyType::Monomial;
+            else if (value == "hermite") req.basis = BasisFamilyType::Hermite;
+            else if (value == "chebyshev") req.basis = BasisFamilyType::Chebyshev;
+            else throw std::invalid_argument("QuoteRequest: unknown basis " + value);
+        } else {
+            throw std::invalid_argument("QuoteRequest: unknown key " + key);
+        }
+    }
+    if (!haveSpot || !(req.spot > 0.0)) {
+        throw std::invalid_argument("QuoteRequest: S must be given and > 0");
+    }
+    return req;
+}
+
+std::string QuoteRequest::contractKey() const {
+    std::ostringstream key;
+    key << std::hexfloat << (call ? "call" : "put") << ' ' << strike << ' ' << static_cast<int>(basis) << ' '
+        << numTerms << ' ' << gridKey(*this);
+    return key.str();
+}
+
+// PricingServer
+struct PricingServer::Warm {
+    std::unique_ptr<LSMPricer> pricer;
+};
+
+PricingServer::PricingServer(ServerConfig cfg)
+    : cfg_(cfg), pool_(cfg.numThreads), cache_(std::make_shared<PathCache>(cfg.cacheBytes)) {
+    if (cfg_.maxBatch == 0 || cfg_.maxPricers == 0 || !(cfg_.batchWindowMillis >= 0.0)) {
+        throw std::invalid_argument("ServerConfig: need maxBatch, maxPricers > 0 and batchWindowMillis >= 0");
+    }
+}
+
+PricingServer::~PricingServer() = default;
+
+std::shared_ptr<PricingServer::Warm> PricingServer::warmPricer(const std::string& key,
+                                                               const QuoteRequest& req) {
+    if (const auto it = pricers_.find(key); it != pricers_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->second;
+    }
+    std::unique_ptr<StochasticProcess> process;
+    if (req.jumps) {
+        process = std::make_unique<JumpDiffusionProcess>(req.config.riskFreeRate, req.sigma, req.lambda,
+                                                         req.jumpMean, req.jumpVol);
+    } else {
+        process = std::make_unique<GeometricBrownianMotion>(req.config.riskFreeRate, req.sigma);
+    }
+    std::unique_ptr<Payoff> payoff;
+    if (req.call) payoff = std::make_unique<CallPayoff>(req.strike);
+    else payoff = std::make_unique<PutPayoff>(req.strike);
+    auto warm = std::make_shared<Warm>();
+    warm->pricer = std::make_unique<LSMPricer>(req.config, std::move(process), std::move(payoff),
+                                               BasisFamily(req.basis, req.numTerms));
+    warm->pricer->setPathCache(cache_);
+    warm->pricer->setWorkspace(std::make_shared<PricingWorkspace>());
+
+    lru_.emplace_front(key, warm);
+    pricers_[key] = lru_.begin();
+    if (lru_.size() > cfg_.maxPricers) {
+        pricers_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+    return warm;
+}
+
+ServerStats PricingServer::serve(std::istream& in, std::ostream& out) {
+    // the reader only timestamps and queues; everything else happens here
+    std::mutex mutex;
+    std::condition_variable arrived;
+    std::deque<Line> queue;
+    bool done = false;
+    std::thread reader([&] {
+        std::string text;
+        while (std::getline(in, text)) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                queue.push_back({std::move(text), Clock::now()});
+            }
+            arrived.notify_one();
+            text.clear();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+        }
+        arrived.notify_one();
+    });
+
+    const auto window = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(cfg_.batchWindowMillis));
+    for (;;) {
+        std::vector<Line> batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            arrived.wait(lock, [&] { return !queue.empty() || done; });
+            if (queue.empty()) break;
+            arrived.wait_until(lock, queue.front().arrival + window,
+                               [&] { return queue.size() >= cfg_.maxBatch || done; });
+            const std::size_t n = std::min(queue.size(), cfg_.maxBatch);
+            for (std::size_t i = 0; i < n; ++i) {
+                batch.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+        }
+        handleBatch(batch, out);
+    }
+    reader.join();
+    return stats();
+}
+
+void PricingServer::handleBatch(std::vector<Line>& batch, std::ostream& out) {
+    // parse, then group the requests by contract; each group is one pricer
+    // and one ladder over its distinct spots
+    struct Item {
+        std::string id;
+        bool statsRequest = false;
+        bool skip = false;
+        std::string error;
+        std::size_t group = 0, spot = 0;
+    };
+    struct Group {
+        std::string grid;
+        std::shared_ptr<Warm> warm;
+        std::vector<double> spots;
+        std::vector<SimulationResult> results;
+        std::string error;
+    };
+    std::vector<Item> items(batch.size());
+    std::vector<Group> groups;
+    std::unordered_map<std::string, std::size_t> groupOf;
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        Item& item = items[i];
+        const std::string& text = batch[i].text;
+        const auto first = text.find_first_not_of(" \t\r");
+        if (first == std::string::npos || text[first] == '#') {
+            item.skip = true;
+            continue;
+        }
+        if (text.compare(first, 5, "stats") == 0 && text.find_first_not_of(" \t\r", first + 5) == std::string::npos) {
+            item.statsRequest = true;
+            continue;
+        }
+        try {
+            const QuoteRequest req = QuoteRequest::parse(text);
+            item.id = req.id;
+            const std::string key = req.contractKey();
+            auto [it, inserted] = groupOf.try_emplace(key, groups.size());
+            if (inserted) {
+                groups.emplace_back();
+                groups.back().grid = gridKey(req);
+                groups.back().warm = warmPricer(key, req);
+            }
+            Group& g = groups[it->second];
+            item.group = it->second;
+            const auto pos = std::find(g.spots.begin(), g.spots.end(), req.spot);
+            item.spot = static_cast<std::size_t>(pos - g.spots.begin());
+            if (pos == g.spots.end()) g.spots.push_back(req.spot);
+        } catch (const std::exception& e) {
+            // the id is still wanted for the reply when the rest is bad
+            std::istringstream tokens(text);
+            std::string token;
+            while (tokens >> token) {
+                if (token.rfind("id=", 0) == 0) item.id = token.substr(3);
+            }
+            item.error = e.what();
+        }
+    }
+
+    // groups on one grid run one after another, so the first simulates it
+    // and the rest read it from the cache rather than racing to fill it
+    std::vector<std::vector<std::size_t>> grids;
+    std::unordered_map<std::string, std::size_t> gridOf;
+    for (std::size_t g = 0; g < groups.size(); ++g) {
+        auto [it, inserted] = gridOf.try_emplace(groups[g].grid, grids.size());
+        if (inserted) grids.emplace_back();
+        grids[it->second].push_back(g);
+    }
+
+    const std::size_t misses = cache_->misses();
+    if (!grids.empty()) {
+        // the claiming loop runs on a worker, so each ladder's own loops
+        // spread over the pool as well
+        pool_.submit([&] {
+            pool_.parallelFor(grids.size(), [&](std::size_t lo, std::size_t hi) {
+                for (std::size_t k = lo; k < hi; ++k) {
+                    for (std::size_t g : grids[k]) {
+                        try {
+                            groups[g].results = groups[g].warm->pricer->priceLadder(groups[g].spots);
+                        } catch (const std::exception& e) {
+                            groups[g].error = e.what();
+                        }
+                    }
+                }
+            }, 1);
+        }).get();
+    }
+    stats_.simulations += cache_->misses() - misses;
+    ++stats_.batches;
+
+    const auto now = Clock::now();
+    if (!started_) {
+        firstArrival_ = batch.front().arrival;
+        started_ = true;
+    }
+    lastResponse_ = now;
+    const auto requests = std::count_if(items.begin(), items.end(),
+                                        [](const Item& item) { return !item.skip && !item.statsRequest; });
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        const Item& item = items[i];
+        if (item.skip) continue;
+        if (item.statsRequest) {
+            out << statsLine() << '\n';
+            continue;
+        }
+        const double micros = std::chrono::duration<double, std::micro>(now - batch[i].arrival).count();
+        const std::string& error = item.error.empty() ? groups[item.group].error : item.error;
+        out << "id=" << (item.id.empty() ? "?" : item.id);
+        if (!error.empty()) {
+            out << " error=" << error << '\n';
+            ++stats_.errors;
+            continue;
+        }
+        const SimulationResult& res = groups[item.group].results[item.spot];
+        out << std::setprecision(17) << " value=" << res.optionValue << " se=" << res.standardError
+            << " european=" << res.europeanValue << " eep=" << res.earlyExercisePremium
+            << " batch=" << requests << " latency_us=" << std::llround(micros) << '\n';
+        ++stats_.quotes;
+        record(micros);
+    }
+    out.flush();
+}
+
+void PricingServer::record(double micros) {
+    if (latencies_.size() < kLatencyWindow) latencies_.push_back(micros);
+    else latencies_[nextLatency_] = micros;
+    nextLatency_ = (nextLatency_ + 1) % kLatencyWindow;
+    stats_.maxMicros = std::max(stats_.maxMicros, micros);
+}
+
+ServerStats PricingServer::stats() const {
+    ServerStats s = stats_;
+    std::vector<double> v = latencies_;
+    s.p50Micros = percentile(v, 0.50);
+    s.p99Micros = percentile(v, 0.99);
+    const double seconds = started_ ? std::chrono::duration<double>(lastResponse_ - firstArrival_).count() : 0.0;
+    s.quotesPerSecond = seconds > 0.0 ? static_cast<double>(s.quotes) / seconds : 0.0;
+    return s;
+}
+
+std::string PricingServer::statsLine() const {
+    const ServerStats s = stats();
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1) << "stats quotes=" << s.quotes << " errors=" << s.errors
+         << " batches=" << s.batches << " simulations=" << s.simulations << " p50_us=" << s.p50Micros
+         << " p99_us=" << s.p99Micros << " max_us=" << s.maxMicros << " quotes_per_sec=" << s.quotesPerSecond;
+    return line.str();
+}
+
+}
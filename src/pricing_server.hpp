@@ -0,0 +1,141 @@
+#pragma once
+
+#include "basis_functions.hpp"
+#include "lsm_types.hpp"
+#include "parallel.hpp"
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lsm {
+
+class PathCache;
+
+//  QuoteRequest  
+// - one line of the server protocol: whitespace-separated key=value pairs,
+//   any order, every key but S optional
+//
+//     id=q1 S=36 K=40 type=put r=0.06 sigma=0.2 T=1 paths=10000 dates=50
+//     seed=42 antithetic=1 basis=laguerre M=3 process=gbm
+//
+//   process=jd adds lambda, jumpMean and jumpVol (JumpDiffusionProcess's
+//   defaults); basis is laguerre, monomial, hermite or chebyshev. Unset
+//   keys take LSMConfig's and the constructors' defaults, K = 40.
+
+struct QuoteRequest {
+    std::string id;
+    double spot = 0.0;
+    double strike = 40.0;
+    bool call = false;
+    bool jumps = false;
+    double sigma = 0.2;
+    double lambda = 0.0, jumpMean = -0.10, jumpVol = 0.25;
+    LSMConfig config;
+    BasisFamilyType basis = BasisFamilyType::Laguerre;
+    int numTerms = 3;
+
+    // std::invalid_argument on an unknown key or a malformed value
+    static QuoteRequest parse(const std::string& line);
+
+    // everything but the id and the spot: requests that agree on it are
+    // priced by one pricer from one unit-spot grid
+    std::string contractKey() const;
+};
+
+//  ServerConfig / ServerStats  
+// - PricingServer's batching and warm-state limits, and what it measured
+
+struct ServerConfig {
+    int numThreads = 0;                     // WorkStealingPool workers, 0 = all
+    double batchWindowMillis = 2.0;         // requests this close behind the first share a batch
+    std::size_t maxBatch = 256;             // requests per batch at most
+    std::size_t cacheBytes = std::size_t(512) << 20;    // PathCache budget
+    std::size_t maxPricers = 64;            // warm pricers kept, least recently used dropped
+};
+
+struct ServerStats {
+    std::size_t quotes = 0;                 // results sent
+    std::size_t errors = 0;                 // requests answered with an error
+    std::size_t batches = 0;
+    std::size_t simulations = 0;            // grids simulated (PathCache misses)
+    double p50Micros = 0.0;                 // arrival to response, over the last kLatencyWindow quotes
+    double p99Micros = 0.0;
+    double maxMicros = 0.0;
+    double quotesPerSecond = 0.0;           // quotes over the time from first arrival to last response
+};
+
+//  PricingServer  
+// - a long-running quote loop over line-delimited QuoteRequests. A reader
+//   thread timestamps lines as they arrive; the serving loop takes the
+//   first waiting request, waits up to batchWindowMillis (or until
+//   maxBatch are queued) for more, and prices the batch. Requests in a
+//   batch are grouped by contractKey(); each group goes to a warm LSMPricer
+//   and is priced by priceLadder() over its distinct spots. Groups on
+//   different grids run side by side on one WorkStealingPool; groups
+//   sharing a grid run in turn, so it is simulated once.
+//
+//   Pricers, with their PricingWorkspaces, live across batches in an LRU
+//   of maxPricers, and share one PathCache: a ladder reads the unit-spot
+//   grid, so requests agreeing on everything but spot, strike, payoff and
+//   basis share one simulation across groups and batches. Results equal
+//   LSMPricer::price() on the same request bit for bit (double storage).
+//
+//   Responses stream back in arrival order, one line per request, flushed
+//   per batch:
+//
+//     id=q1 value=4.4787 se=0.0131 european=3.8443 eep=0.6344 batch=3 latency_us=812
+//     id=q2 error=<message>
+//
+//   '#' comments and blank lines are skipped; a line "stats" is answered
+//   with the ServerStats so far. cfg.numThreads of a request is ignored.
+
+class PricingServer {
+public:
+    static constexpr std::size_t kLatencyWindow = 1 << 16;
+
+    explicit PricingServer(ServerConfig cfg = {});
+    ~PricingServer();
+
+    PricingServer(const PricingServer&) = delete;
+    PricingServer& operator=(const PricingServer&) = delete;
+
+    // serve requests from in until it ends; returns the final statistics
+    ServerStats serve(std::istream& in, std::ostream& out);
+
+    ServerStats stats() const;
+    const ServerConfig& config() const { return cfg_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Line {
+        std::string text;
+        Clock::time_point arrival;
+    };
+    struct Warm;
+
+    void handleBatch(std::vector<Line>& batch, std::ostream& out);
+    std::shared_ptr<Warm> warmPricer(const std::string& key, const QuoteRequest& req);
+    void record(double micros);
+    std::string statsLine() const;
+
+    ServerConfig cfg_;
+    WorkStealingPool pool_;
+    std::shared_ptr<PathCache> cache_;
+
+    // least recently used at the back
+    std::list<std::pair<std::string, std::shared_ptr<Warm>>> lru_;
+    std::unordered_map<std::string, decltype(lru_)::iterator> pricers_;
+
+    ServerStats stats_;
+    std::vector<double> latencies_;         // ring of the last kLatencyWindow, micros
+    std::size_t nextLatency_ = 0;
+    bool started_ = false;
+    Clock::time_point firstArrival_, lastResponse_;
+};
+
+}
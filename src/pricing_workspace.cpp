@@ -0,0 +1,110 @@
+#include "pricing_workspace.hpp"
+#include "lsm_pricer.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <new>
+
+namespace lsm {
+
+namespace {
+
+std::size_t padded(std::size_t bytes) {
+    constexpr std::size_t a = PricingWorkspace::kAlignment;
+    return (bytes + a - 1) / a * a;
+}
+
+}
+
+// PricingWorkspace
+PricingWorkspace::PricingWorkspace(const LSMConfig& cfg, int numBasis) {
+    reserve(requiredBytes(cfg, numBasis));
+}
+
+std::size_t PricingWorkspace::requiredBytes(const LSMConfig& cfg, int numBasis) {
+    // mirrors the carving in LSMPricer::simulate, backwardInduction and
+    // addGreeks; every allocation is rounded up to the alignment
+    const std::size_t N = static_cast<std::size_t>(std::max(cfg.numPaths, 0));
+    const std::size_t numDates = static_cast<std::size_t>(std::max(cfg.numExerciseDates, 0)) + 1;
+    const std::size_t m = static_cast<std::size_t>(std::max(numBasis, 0));
+    const std::size_t numTiles = (N + kTilePaths - 1) / kTilePaths;
+    const std::size_t tileBuffers = std::max<std::size_t>(
+        1, std::min<std::size_t>(static_cast<std::size_t>(effectiveThreadCount(cfg.numThreads)), numTiles));
+    const std::size_t numBlocks = (N + kBlockPaths - 1) / kBlockPaths;
+    const std::size_t B = std::min(N, kBlockPaths);
+    const std::size_t designBytes = cfg.basisPrecision == PathPrecision::Float ? sizeof(float) : sizeof(double);
+
+    // Sobol tiles also hold their normals and Brownian increments
+    const std::size_t tileRows = cfg.samplingScheme == SamplingScheme::Sobol ? 3 * numDates - 2 : numDates;
+    std::size_t bytes = cfg.lowMemory ? 0 : padded(tileBuffers * kTilePaths * tileRows * sizeof(double));
+    // per block: itm, spot, payoff, itmSpot, x, y, exercise, fit, X, X'X, X'y
+    const std::size_t perBlock = padded(B * sizeof(std::size_t)) + 7 * padded(B * sizeof(double))
+                               + padded(B * m * designBytes) + padded(m * m * sizeof(double))
+                               + padded(m * sizeof(double));
+    bytes += padded(numBlocks * LSMPricer::blockBytes()) + numBlocks * perBlock;
+    bytes += padded(N * sizeof(double));                                            // cash
+    if (cfg.useControlVariate) bytes += padded(N * sizeof(double));                 // control
+    bytes += padded(m * m * sizeof(double)) + 2 * padded(m * sizeof(double));       // total, beta
+    if (cfg.computeGreeks) {
+        bytes += padded(N * sizeof(int)) + 5 * padded(N * sizeof(double));
+    }
+    return bytes;
+}
+
+void* PricingWorkspace::allocateBytes(std::size_t bytes) {
+    bytes = padded(std::max<std::size_t>(bytes, 1));
+    if (chunks_.empty() || chunks_.back().size - chunks_.back().used < bytes) {
+        addChunk(std::max(bytes, capacity()));
+    }
+    Chunk& c = chunks_.back();
+    void* p = c.data.get() + c.used;
+    c.used += bytes;
+    used_ += bytes;
+    highWater_ = std::max(highWater_, used_);
+    return p;
+}
+
+void PricingWorkspace::addChunk(std::size_t bytes) {
+    Chunk c;
+    c.data.reset(static_cast<std::byte*>(::operator new(bytes, std::align_val_t{kAlignment})));
+    c.size = bytes;
+    chunks_.push_back(std::move(c));
+    ++heapAllocations_;
+}
+
+void PricingWorkspace::reset() {
+    used_ = 0;
+    if (chunks_.size() > 1) {
+        chunks_.clear();
+        addChunk(highWater_);
+    }
+    for (auto& c : chunks_) c.used = 0;
+}
+
+void PricingWorkspace::reserve(std::size_t bytes) {
+    bytes = padded(bytes);
+    if (bytes <= capacity()) return;
+    if (used_ == 0) chunks_.clear();
+    addChunk(used_ == 0 ? bytes : bytes - capacity());
+}
+
+std::size_t PricingWorkspace::capacity() const {
+    std::size_t total = 0;
+    for (const auto& c : chunks_) total += c.size;
+    return total;
+}
+
+PathMatrix& PricingWorkspace::gridStorage(std::size_t numPaths, std::size_t numDates,
+                                          PathPrecision precision) {
+    if (grid_.numPaths() != numPaths || grid_.numDates() != numDates ||
+        grid_.precision() != precision) {
+        grid_ = PathMatrix(numPaths, numDates, precision);
+        ++heapAllocations_;
+    }
+    return grid_;
+}
+
+void PricingWorkspace::AlignedDelete::operator()(std::byte* p) const {
+    ::operator delete(p, std::align_val_t{kAlignment});
+}
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "lsm_types.hpp"
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace lsm {
+
+// paths per work block in the backward sweep
+inline constexpr std::size_t kBlockPaths = 2048;
+
+// paths simulated together before being transposed into the PathMatrix;
+// a multiple of the cache line in both float and double storage
+inline constexpr std::size_t kTilePaths = 64;
+
+//  PricingWorkspace  
+// - scratch memory reused across LSMPricer calls: one 64-byte aligned arena
+//   that the sweep carves into its per-date buffers (cash flows, in-the-
+//   money lists, design matrices, normal equations, Greeks), plus the
+//   storage of the last grid simulated without a PathCache. reset() rewinds
+//   the arena without freeing it; a call that outgrew it spills into extra
+//   chunks, which the next reset() folds into a single one of the high-water
+//   size. Once warm, pricing the same configuration allocates nothing.
+//   Not thread-safe: one workspace per pricer call in flight.
+
+class PricingWorkspace {
+public:
+    static constexpr std::size_t kAlignment = 64;
+
+    PricingWorkspace() = default;
+
+    // reserve requiredBytes(cfg, numBasis) up front
+    PricingWorkspace(const LSMConfig& cfg, int numBasis);
+
+    // Arena bytes one price() under cfg with numBasis regressors carves
+    // out. Process-specific state (low-memory mode) comes on top and is
+    // picked up by the first reset() after the call.
+    static std::size_t requiredBytes(const LSMConfig& cfg, int numBasis);
+
+    // n value-initialised elements of T, valid until the next reset()
+    template <class T>
+    std::span<T> allocate(std::size_t n) {
+        static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                      "arena storage is never destroyed element by element");
+        T* p = static_cast<T*>(allocateBytes(n * sizeof(T)));
+        for (std::size_t i = 0; i < n; ++i) p[i] = T{};
+        return {p, n};
+    }
+
+    // drop every allocation; keeps (and if need be consolidates) the memory
+    void reset();
+    void reserve(std::size_t bytes);
+
+    std::size_t capacity() const;                    // bytes across all chunks
+    std::size_t bytesInUse() const { return used_; }
+    std::size_t highWater() const { return highWater_; }
+
+    // heap blocks taken so far: arena chunks and grid storage
+    std::size_t heapAllocations() const { return heapAllocations_; }
+
+    // the profile of the call using the workspace, if it records one
+    PricingProfile* profile() const { return LSM_PROFILING ? profile_ : nullptr; }
+    void setProfile(PricingProfile* profile) { profile_ = profile; }
+
+    // A grid of the given shape whose storage persists between calls; it
+    // is reallocated only when the shape changes. Contents are unspecified.
+    PathMatrix& gridStorage(std::size_t numPaths, std::size_t numDates, PathPrecision precision);
+
+private:
+    struct AlignedDelete {
+        void operator()(std::byte* p) const;
+    };
+    struct Chunk {
+        std::unique_ptr<std::byte[], AlignedDelete> data;
+        std::size_t size = 0;
+        std::size_t used = 0;
+    };
+
+    void* allocateBytes(std::size_t bytes);
+    void addChunk(std::size_t bytes);
+
+    std::vector<Chunk> chunks_;         // the last one is being carved
+    std::size_t used_ = 0;              // bytes handed out since reset(), with padding
+    std::size_t highWater_ = 0;
+    std::size_t heapAllocations_ = 0;
+    PricingProfile* profile_ = nullptr;
+    PathMatrix grid_;
+};
+
+}
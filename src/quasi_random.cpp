@@ -0,0 +1,233 @@
+#include "quasi_random.hpp"
+#include "simd_kernels.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace lsm {
+
+namespace {
+
+// Random-stream lane of the scrambling draws: (replicate, dimension) own
+// Philox blocks kScrambleLane, kScrambleLane + 1, ...; kept clear of the
+// path lanes
+constexpr std::uint32_t kScrambleLane = 0x100;
+
+// Initial direction numbers m_1 .. m_s of dimensions 2 .. 21 (dimension 1
+// is the van der Corput sequence), from Joe & Kuo's new-joe-kuo-6.21201
+constexpr int kJoeKuoDimensions = 20;
+constexpr std::uint32_t kJoeKuo[kJoeKuoDimensions][7] = {
+    {1},
+    {1, 3},
+    {1, 3, 1},
+    {1, 1, 1},
+    {1, 1, 3, 3},
+    {1, 3, 5, 13},
+    {1, 1, 5, 5, 17},
+    {1, 1, 5, 5, 5},
+    {1, 1, 7, 11, 19},
+    {1, 1, 5, 1, 1},
+    {1, 1, 1, 3, 11},
+    {1, 3, 5, 5, 31},
+    {1, 3, 3, 9, 7, 49},
+    {1, 1, 1, 15, 21, 21},
+    {1, 3, 1, 13, 27, 49},
+    {1, 1, 1, 15, 7, 5},
+    {1, 3, 1, 15, 13, 25},
+    {1, 1, 5, 5, 19, 61},
+    {1, 3, 7, 11, 23, 15, 103},
+    {1, 3, 7, 13, 13, 15, 69},
+};
+
+// a * b mod p over GF(2); p has degree s and a, b < 2^s
+std::uint64_t mulMod(std::uint64_t a, std::uint64_t b, std::uint64_t p, int s) {
+    std::uint64_t r = 0;
+    for (int i = s - 1; i >= 0; --i) {
+        r <<= 1;
+        if (r >> s & 1) r ^= p;
+        if (b >> i & 1) r ^= a;
+    }
+    return r;
+}
+
+std::uint64_t powMod(std::uint64_t e, std::uint64_t p, int s) {
+    if (s == 1) return 1;                       // x = 1 mod x + 1
+    std::uint64_t result = 1, base = 2;         // x
+    for (; e; e >>= 1) {
+        if (e & 1) result = mulMod(result, base, p, s);
+        base = mulMod(base, base, p, s);
+    }
+    return result;
+}
+
+// x generates the multiplicative group of GF(2)[x] / p
+bool isPrimitive(std::uint64_t p, int s) {
+    const std::uint64_t order = (std::uint64_t(1) << s) - 1;
+    if (powMod(order, p, s) != 1) return false;
+    std::uint64_t n = order;
+    for (std::uint64_t q = 2; q * q <= n; ++q) {
+        if (n % q != 0) continue;
+        if (powMod(order / q, p, s) == 1) return false;
+        while (n % q == 0) n /= q;
+    }
+    return n == 1 || powMod(order / n, p, s) != 1;
+}
+
+}
+
+// SobolSequence
+SobolSequence::SobolSequence(int dimensions)
+    : dims_(dimensions), directions_(static_cast<std::size_t>(std::max(dimensions, 0)) * kBits),
+      shift_(std::max(dimensions, 0), 0u) {
+    if (dimensions <= 0 || dimensions > kMaxDimensions) {
+        throw std::invalid_argument("SobolSequence: dimensions must be in 1 .. " +
+                                    std::to_string(kMaxDimensions));
+    }
+    for (int b = 0; b < kBits; ++b) directions_[b] = 1u << (kBits - 1 - b);
+
+    // dimension d >= 1 takes the d-th primitive polynomial, by degree and
+    // then by value; V[i] = m_i 2^(32 - i), then the Bratley-Fox recurrence
+    int d = 1;
+    for (int s = 1; d < dimensions; ++s) {
+        for (std::uint64_t p = (std::uint64_t(1) << s) | 1; p >> s == 1 && d < dimensions; p += 2) {
+            if (!isPrimitive(p, s)) continue;
+            const std::uint64_t a = p >> 1 & ((std::uint64_t(1) << (s - 1)) - 1);
+            std::uint32_t* V = directions_.data() + static_cast<std::size_t>(d) * kBits - 1;  // 1-based
+            for (int i = 1; i <= std::min(s, kBits); ++i) {
+                std::uint32_t m;
+                if (d - 1 < kJoeKuoDimensions) {
+                    m = kJoeKuo[d - 1][i - 1];
+                } else {
+                    const auto r = Philox4x32::generate({static_cast<std::uint32_t>(d),
+                                                         static_cast<std::uint32_t>(i), 0, 0},
+                                                        {0x536F626Fu, 0x6C4A4B21u});
+                    m = (r[0] & ((std::uint32_t(1) << i) - 1)) | 1u;
+                }
+                V[i] = m << (kBits - i);
+            }
+            for (int i = s + 1; i <= kBits; ++i) {
+                V[i] = V[i - s] ^ (V[i - s] >> s);
+                for (int k = 1; k < s; ++k) {
+                    if (a >> (s - 1 - k) & 1) V[i] ^= V[i - k];
+                }
+            }
+            ++d;
+        }
+    }
+}
+
+void SobolSequence::scramble(const CounterRNG& rng, std::uint64_t replicate) {
+    for (int d = 0; d < dims_; ++d) {
+        std::uint32_t words[36];
+        for (std::uint32_t g = 0; g < 9; ++g) {
+            const auto r = rng.bits(replicate, static_cast<std::uint32_t>(d), kScrambleLane + g);
+            for (int w = 0; w < 4; ++w) words[4 * g + w] = r[w];
+        }
+        // lower-triangular matrix with unit diagonal: output digit j (from
+        // the most significant) mixes input digits 1 .. j
+        std::uint32_t column[kBits];
+        for (int j = 0; j < kBits; ++j) {
+            const std::uint32_t lead = 1u << (kBits - 1 - j);
+            column[j] = lead | (words[j] & (lead - 1));
+        }
+        std::uint32_t* V = directions_.data() + static_cast<std::size_t>(d) * kBits;
+        for (int b = 0; b < kBits; ++b) {
+            std::uint32_t v = 0;
+            for (int j = 0; j < kBits; ++j) {
+                if (V[b] >> (kBits - 1 - j) & 1) v ^= column[j];
+            }
+            V[b] = v;
+        }
+        shift_[d] = words[kBits];
+    }
+}
+
+void SobolSequence::uniforms(std::uint64_t first, std::size_t count, std::span<double> out) const {
+    if (first + count > (std::uint64_t(1) << kBits)) {
+        throw std::invalid_argument("SobolSequence: point index beyond 2^32");
+    }
+    if (out.size() < count * dims_) {
+        throw std::invalid_argument("SobolSequence: output span too small");
+    }
+    const std::uint64_t gray = first ^ (first >> 1);
+    for (int d = 0; d < dims_; ++d) {
+        const std::uint32_t* V = directions_.data() + static_cast<std::size_t>(d) * kBits;
+        std::uint32_t x = shift_[d];
+        for (int b = 0; b < kBits; ++b) {
+            if (gray >> b & 1) x ^= V[b];
+        }
+        double* row = out.data() + d * count;
+        for (std::size_t i = 0; i < count; ++i) {
+            row[i] = (static_cast<double>(x) + 0.5) * 0x1.0p-32;
+            // Gray-code order: the next point flips the lowest set bit of its index
+            if (i + 1 < count) x ^= V[std::countr_zero(first + i + 1)];
+        }
+    }
+}
+
+void SobolSequence::normals(std::uint64_t first, std::size_t count, std::span<double> out) const {
+    uniforms(first, count, out);
+    simd::normalQuantileBlock(out.data(), count * dims_, out.data());
+}
+
+// BrownianBridge
+BrownianBridge::BrownianBridge(std::size_t numSteps, double dt)
+    : bridge_(numSteps), left_(numSteps), right_(numSteps),
+      leftWeight_(numSteps), rightWeight_(numSteps), stdDev_(numSteps) {
+    if (numSteps == 0 || dt <= 0.0) {
+        throw std::invalid_argument("BrownianBridge: need at least one step of positive length");
+    }
+    auto t = [&](std::size_t k) { return static_cast<double>(k + 1) * dt; };
+
+    // filled[k]: date k + 1 already placed
+    std::vector<char> filled(numSteps, 0);
+    filled[numSteps - 1] = 1;
+    bridge_[0] = numSteps - 1;
+    stdDev_[0] = std::sqrt(t(numSteps - 1));
+    for (std::size_t i = 1, j = 0; i < numSteps; ++i) {
+        while (filled[j]) j = j + 1 == numSteps ? 0 : j + 1;
+        std::size_t k = j;
+        while (!filled[k]) ++k;                     // [j, k) is the next open gap
+        const std::size_t l = j + ((k - 1 - j) >> 1);
+        filled[l] = 1;
+        bridge_[i] = l;
+        left_[i] = j;
+        right_[i] = k;
+        const double tl = t(l), tk = t(k), tj = j == 0 ? 0.0 : t(j - 1);
+        leftWeight_[i] = (tk - tl) / (tk - tj);
+        rightWeight_[i] = (tl - tj) / (tk - tj);
+        stdDev_[i] = std::sqrt((tl - tj) * (tk - tl) / (tk - tj));
+        j = k + 1;
+        if (j >= numSteps) j = 0;
+    }
+}
+
+void BrownianBridge::transform(std::span<const double> z, std::size_t count,
+                               std::span<double> W) const {
+    const std::size_t D = numSteps();
+    if (z.size() < D * count || W.size() < D * count) {
+        throw std::invalid_argument("BrownianBridge: blocks must hold numSteps rows of count");
+    }
+    auto row = [&](std::size_t k) { return W.data() + k * count; };
+    {
+        double* w = row(bridge_[0]);
+        for (std::size_t p = 0; p < count; ++p) w[p] = stdDev_[0] * z[p];
+    }
+    for (std::size_t i = 1; i < D; ++i) {
+        double* w = row(bridge_[i]);
+        const double* zi = z.data() + i * count;
+        const double* wr = row(right_[i]);
+        const double b = rightWeight_[i], s = stdDev_[i];
+        if (left_[i] == 0) {
+            for (std::size_t p = 0; p < count; ++p) w[p] = b * wr[p] + s * zi[p];
+        } else {
+            const double* wl = row(left_[i] - 1);
+            const double a = leftWeight_[i];
+            for (std::size_t p = 0; p < count; ++p) w[p] = a * wl[p] + b * wr[p] + s * zi[p];
+        }
+    }
+}
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "counter_rng.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace lsm {
+
+//  SobolSequence  
+// - Sobol (1967) low-discrepancy points with 32-bit resolution, built from
+//   primitive polynomials in order of degree. The first 21 dimensions use
+//   the initial direction numbers of Joe & Kuo (2008); later ones use odd
+//   initial numbers drawn once from a fixed Philox stream, which keeps the
+//   sequence a digital (t, s)-sequence. Any point is produced directly from
+//   its index, so blocks of points can be generated in any order.
+//
+//   scramble() applies a random linear (Matousek) scramble and a digital
+//   shift per dimension: the points stay a net and each scrambling is an
+//   unbiased, independent replicate of the whole point set.
+
+class SobolSequence {
+public:
+    static constexpr int kMaxDimensions = 1024;
+    static constexpr int kBits = 32;
+
+    explicit SobolSequence(int dimensions);
+
+    // randomise with draws from rng's stream `replicate`
+    void scramble(const CounterRNG& rng, std::uint64_t replicate);
+
+    int dimensions() const { return dims_; }
+
+    // Points [first, first + count) as uniforms on (0, 1), dimension-major:
+    // out[d * count + i] is coordinate d of point first + i.
+    void uniforms(std::uint64_t first, std::size_t count, std::span<double> out) const;
+
+    // the same mapped through the standard normal quantile
+    void normals(std::uint64_t first, std::size_t count, std::span<double> out) const;
+
+private:
+    int dims_;
+    std::vector<std::uint32_t> directions_;     // directions_[d * kBits + b]
+    std::vector<std::uint32_t> shift_;          // per dimension
+};
+
+//  BrownianBridge  
+// - builds W on the dates dt, 2 dt, ..., numSteps dt from numSteps normals:
+//   the first fixes the end point and each later one fills the middle of
+//   the widest gap left, so the leading normals carry most of the path's
+//   variance. Fed with low-discrepancy points this is what lets QMC beat
+//   plain Monte Carlo on path-dependent payoffs.
+
+class BrownianBridge {
+public:
+    BrownianBridge(std::size_t numSteps, double dt);
+
+    std::size_t numSteps() const { return bridge_.size(); }
+
+    // Date-major blocks of count paths: z[j * count + i] is normal j of path
+    // i, W[(k - 1) * count + i] is W at date k.
+    void transform(std::span<const double> z, std::size_t count, std::span<double> W) const;
+
+private:
+    // step j sets date bridge_[j] from dates left_[j] - 1 (none when 0) and right_[j]
+    std::vector<std::size_t> bridge_, left_, right_;
+    std::vector<double> leftWeight_, rightWeight_, stdDev_;
+};
+
+}
@@ -0,0 +1,58 @@
+// =============================================================================
+//  server_main.cpp  —  lsm_server: the pricer as a long-running quote service
+//
+//  Reads line-delimited QuoteRequests on stdin and streams one result line
+//  per request to stdout (protocol in pricing_server.hpp). Pricers, their
+//  workspaces, the thread pool and the path cache stay warm across
+//  requests; requests arriving within --window-ms of each other are priced
+//  as one batch on shared simulations. On end of input the final latency
+//  and throughput figures go to stderr. Pipe a socket in with, e.g.,
+//  socat TCP-LISTEN:9000,fork EXEC:./lsm_server.
+//
+//  Usage: lsm_server [--threads=T] [--window-ms=ms] [--max-batch=N]
+//                    [--cache-mb=MB] [--max-pricers=N]
+// =============================================================================
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "pricing_server.hpp"
+
+using namespace lsm;
+
+int main(int argc, char** argv)
+{
+    std::map<std::string, std::string> opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            std::cerr << "usage: lsm_server [--threads=T] [--window-ms=ms] [--max-batch=N] "
+                         "[--cache-mb=MB] [--max-pricers=N]\n";
+            return 1;
+        }
+        opts[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+    }
+    ServerConfig cfg;
+    if (opts.count("threads")) cfg.numThreads = std::atoi(opts["threads"].c_str());
+    if (opts.count("window-ms")) cfg.batchWindowMillis = std::atof(opts["window-ms"].c_str());
+    if (opts.count("max-batch")) cfg.maxBatch = std::strtoull(opts["max-batch"].c_str(), nullptr, 10);
+    if (opts.count("cache-mb")) cfg.cacheBytes = std::strtoull(opts["cache-mb"].c_str(), nullptr, 10) << 20;
+    if (opts.count("max-pricers")) cfg.maxPricers = std::strtoull(opts["max-pricers"].c_str(), nullptr, 10);
+
+    std::ios::sync_with_stdio(false);
+    try {
+        PricingServer server(cfg);
+        const ServerStats s = server.serve(std::cin, std::cout);
+        std::cerr << "lsm_server: " << s.quotes << " quotes, " << s.errors << " errors, "
+                  << s.batches << " batches, " << s.simulations << " simulations; latency p50 "
+                  << s.p50Micros << " us, p99 " << s.p99Micros << " us, max " << s.maxMicros
+                  << " us; " << s.quotesPerSecond << " quotes/s\n";
+    } catch (const std::exception& e) {
+        std::cerr << "lsm_server: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "simd_kernels.hpp"
+#include "simd_math.hpp"
+#include "counter_rng.hpp"
+#include <atomic>
+#include <stdexcept>
+
+namespace lsm::simd {
+
+namespace {
+
+const detail::KernelTable kScalarKernels = {
+    &drawBlock<ScalarPack, Draw::Normal>,
+    &drawBlock<ScalarPack, Draw::ClosedUniform>,
+    &scaledExpBlock<ScalarPack>,
+    &normalQuantileBlock<ScalarPack>,
+};
+
+const detail::KernelTable& kernelsFor(SimdLevel level) {
+    switch (level) {
+#ifdef LSM_HAVE_SIMD_KERNELS
+    case SimdLevel::AVX512: return detail::avx512Kernels();
+    case SimdLevel::AVX2: return detail::avx2Kernels();
+#endif
+    default: return kScalarKernels;
+    }
+}
+
+SimdLevel detectSimdLevel() {
+#ifdef LSM_HAVE_SIMD_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+std::atomic<SimdLevel>& activeLevel() {
+    static std::atomic<SimdLevel> level{supportedSimdLevel()};
+    return level;
+}
+
+const detail::KernelTable& active() {
+    return kernelsFor(activeLevel().load(std::memory_order_relaxed));
+}
+
+}
+
+SimdLevel supportedSimdLevel() {
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+SimdLevel activeSimdLevel() {
+    return activeLevel().load();
+}
+
+void setSimdLevel(SimdLevel level) {
+    if (static_cast<int>(level) > static_cast<int>(supportedSimdLevel())) {
+        throw std::invalid_argument("setSimdLevel: " + simdLevelName(level) +
+                                    " is not available on this build / CPU");
+    }
+    activeLevel().store(level);
+}
+
+std::string simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX512: return "AVX-512";
+    case SimdLevel::AVX2: return "AVX2";
+    default: return "scalar";
+    }
+}
+
+void normalBlock(const CounterRNG& rng, std::uint64_t firstPath, std::size_t count,
+                 std::uint32_t step, std::uint32_t lane, double* out0, double* out1) {
+    const auto key = rng.key();
+    active().normalBlock(key[0], key[1], firstPath, count, step, lane, out0, out1);
+}
+
+void uniformBlock(const CounterRNG& rng, std::uint64_t firstPath, std::size_t count,
+                  std::uint32_t step, std::uint32_t lane, double* out0, double* out1) {
+    const auto key = rng.key();
+    active().uniformBlock(key[0], key[1], firstPath, count, step, lane, out0, out1);
+}
+
+void scaledExpBlock(const double* x, double scale, std::size_t count, double* out) {
+    active().scaledExpBlock(x, scale, count, out);
+}
+
+void normalQuantileBlock(const double* u, std::size_t count, double* out) {
+    active().normalQuantileBlock(u, count, out);
+}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace lsm {
+
+class CounterRNG;
+
+namespace simd {
+
+// instruction sets the path kernels are built for, in increasing order
+enum class SimdLevel { Scalar, AVX2, AVX512 };
+
+// best level this build and this CPU both support
+SimdLevel supportedSimdLevel();
+
+// level the kernels below dispatch to; starts at supportedSimdLevel().
+// Every level produces the same bits, so this only changes speed.
+SimdLevel activeSimdLevel();
+void setSimdLevel(SimdLevel level);     // std::invalid_argument above supported
+
+std::string simdLevelName(SimdLevel level);
+
+// Draws for `count` consecutive paths firstPath, firstPath+1, ... at Philox
+// block (step, lane): out0[i] / out1[i] are the first / second value of
+// CounterRNG::normalPair (or uniformPair) for path firstPath + i.
+void normalBlock(const CounterRNG& rng, std::uint64_t firstPath, std::size_t count,
+                 std::uint32_t step, std::uint32_t lane, double* out0, double* out1);
+void uniformBlock(const CounterRNG& rng, std::uint64_t firstPath, std::size_t count,
+                  std::uint32_t step, std::uint32_t lane, double* out0, double* out1);
+
+// out[i] = scale * simd::exp(x[i]); out may alias x
+void scaledExpBlock(const double* x, double scale, std::size_t count, double* out);
+
+// out[i] = simd::normalQuantile(u[i]); out may alias u
+void normalQuantileBlock(const double* u, std::size_t count, double* out);
+
+namespace detail {
+
+// one entry per instruction set, filled from the templates in simd_math.hpp
+struct KernelTable {
+    void (*normalBlock)(std::uint32_t, std::uint32_t, std::uint64_t, std::size_t,
+                        std::uint32_t, std::uint32_t, double*, double*);
+    void (*uniformBlock)(std::uint32_t, std::uint32_t, std::uint64_t, std::size_t,
+                         std::uint32_t, std::uint32_t, double*, double*);
+    void (*scaledExpBlock)(const double*, double, std::size_t, double*);
+    void (*normalQuantileBlock)(const double*, std::size_t, double*);
+};
+
+const KernelTable& avx2Kernels();       // simd_kernels_avx2.cpp
+const KernelTable& avx512Kernels();     // simd_kernels_avx512.cpp
+
+}
+
+}
+
+}
@@ -0,0 +1,62 @@
+// Built with -mavx2 (see CMakeLists.txt) and only called after the CPU check
+// in simd_kernels.cpp. Nothing here may instantiate code that baseline
+// translation units also emit: the linker could keep this copy.
+#include "simd_kernels.hpp"
+#include "simd_math.hpp"
+#include <immintrin.h>
+
+namespace lsm::simd {
+
+namespace {
+
+struct Avx2Pack {
+    using D = __m256d;
+    using U = __m256i;
+    using M = __m256d;
+    static constexpr std::size_t width = 4;
+
+    static D set(double v) { return _mm256_set1_pd(v); }
+    static U setU(std::uint64_t v) { return _mm256_set1_epi64x(static_cast<long long>(v)); }
+    static U lanesFrom(std::uint64_t first) {
+        return _mm256_add_epi64(setU(first), _mm256_setr_epi64x(0, 1, 2, 3));
+    }
+    static D load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, D v) { _mm256_storeu_pd(p, v); }
+
+    static D add(D a, D b) { return _mm256_add_pd(a, b); }
+    static D sub(D a, D b) { return _mm256_sub_pd(a, b); }
+    static D mul(D a, D b) { return _mm256_mul_pd(a, b); }
+    static D div(D a, D b) { return _mm256_div_pd(a, b); }
+    static D sqrt(D a) { return _mm256_sqrt_pd(a); }
+    static D abs(D a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+    static D min(D a, D b) { return _mm256_min_pd(a, b); }
+    static D max(D a, D b) { return _mm256_max_pd(a, b); }
+    static M less(D a, D b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static M lessEq(D a, D b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+    static D select(M m, D a, D b) { return _mm256_blendv_pd(b, a, m); }
+    static bool all(M m) { return _mm256_movemask_pd(m) == 0xF; }
+
+    static D asDouble(U u) { return _mm256_castsi256_pd(u); }
+    static U asBits(D d) { return _mm256_castpd_si256(d); }
+    static U addU(U a, U b) { return _mm256_add_epi64(a, b); }
+    static U xorU(U a, U b) { return _mm256_xor_si256(a, b); }
+    static U andU(U a, U b) { return _mm256_and_si256(a, b); }
+    static U orU(U a, U b) { return _mm256_or_si256(a, b); }
+    template <int N> static U shl(U a) { return _mm256_slli_epi64(a, N); }
+    template <int N> static U shr(U a) { return _mm256_srli_epi64(a, N); }
+    static U mulLo32(U a, U b) { return _mm256_mul_epu32(a, b); }
+};
+
+}
+
+const detail::KernelTable& detail::avx2Kernels() {
+    static const KernelTable table = {
+        &drawBlock<Avx2Pack, Draw::Normal>,
+        &drawBlock<Avx2Pack, Draw::ClosedUniform>,
+        &scaledExpBlock<Avx2Pack>,
+        &normalQuantileBlock<Avx2Pack>,
+    };
+    return table;
+}
+
+}
@@ -0,0 +1,64 @@
+// Built with -mavx512f (see CMakeLists.txt) and only called after the CPU
+// check in simd_kernels.cpp. Nothing here may instantiate code that baseline
+// translation units also emit: the linker could keep this copy.
+#include "simd_kernels.hpp"
+#include "simd_math.hpp"
+#include <immintrin.h>
+
+namespace lsm::simd {
+
+namespace {
+
+struct Avx512Pack {
+    using D = __m512d;
+    using U = __m512i;
+    using M = __mmask8;
+    static constexpr std::size_t width = 8;
+
+    static D set(double v) { return _mm512_set1_pd(v); }
+    static U setU(std::uint64_t v) { return _mm512_set1_epi64(static_cast<long long>(v)); }
+    static U lanesFrom(std::uint64_t first) {
+        return _mm512_add_epi64(setU(first), _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7));
+    }
+    static D load(const double* p) { return _mm512_loadu_pd(p); }
+    static void store(double* p, D v) { _mm512_storeu_pd(p, v); }
+
+    static D add(D a, D b) { return _mm512_add_pd(a, b); }
+    static D sub(D a, D b) { return _mm512_sub_pd(a, b); }
+    static D mul(D a, D b) { return _mm512_mul_pd(a, b); }
+    static D div(D a, D b) { return _mm512_div_pd(a, b); }
+    static D sqrt(D a) { return _mm512_sqrt_pd(a); }
+    static D abs(D a) {
+        return asDouble(_mm512_and_epi64(asBits(a), setU(0x7FFFFFFFFFFFFFFFull)));
+    }
+    static D min(D a, D b) { return _mm512_min_pd(a, b); }
+    static D max(D a, D b) { return _mm512_max_pd(a, b); }
+    static M less(D a, D b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+    static M lessEq(D a, D b) { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+    static D select(M m, D a, D b) { return _mm512_mask_blend_pd(m, b, a); }
+    static bool all(M m) { return m == 0xFF; }
+
+    static D asDouble(U u) { return _mm512_castsi512_pd(u); }
+    static U asBits(D d) { return _mm512_castpd_si512(d); }
+    static U addU(U a, U b) { return _mm512_add_epi64(a, b); }
+    static U xorU(U a, U b) { return _mm512_xor_epi64(a, b); }
+    static U andU(U a, U b) { return _mm512_and_epi64(a, b); }
+    static U orU(U a, U b) { return _mm512_or_epi64(a, b); }
+    template <int N> static U shl(U a) { return _mm512_slli_epi64(a, N); }
+    template <int N> static U shr(U a) { return _mm512_srli_epi64(a, N); }
+    static U mulLo32(U a, U b) { return _mm512_mul_epu32(a, b); }
+};
+
+}
+
+const detail::KernelTable& detail::avx512Kernels() {
+    static const KernelTable table = {
+        &drawBlock<Avx512Pack, Draw::Normal>,
+        &drawBlock<Avx512Pack, Draw::ClosedUniform>,
+        &scaledExpBlock<Avx512Pack>,
+        &normalQuantileBlock<Avx512Pack>,
+    };
+    return table;
+}
+
+}
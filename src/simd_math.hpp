@@ -0,0 +1,299 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace lsm::simd {
+
+// Kernels in this header are templates over a "pack" P: a fixed number of
+// double lanes (P::D), matching 64-bit integer lanes (P::U) and a compare
+// mask (P::M), with the static operations used below. ScalarPack is the
+// one-lane reference; the AVX2 / AVX-512 packs live in simd_kernels_*.cpp.
+// Only +, -, *, /, sqrt, min, max and bit operations are used, all exact or
+// correctly rounded, so every pack returns the same bits for the same input
+// (with floating-point contraction off, see CMakeLists.txt).
+
+//  ScalarPack
+// - one lane, plain C++
+
+struct ScalarPack {
+    using D = double;
+    using U = std::uint64_t;
+    using M = bool;
+    static constexpr std::size_t width = 1;
+
+    static D set(double v) { return v; }
+    static U setU(std::uint64_t v) { return v; }
+    static U lanesFrom(std::uint64_t first) { return first; }
+    static D load(const double* p) { return *p; }
+    static void store(double* p, D v) { *p = v; }
+
+    static D add(D a, D b) { return a + b; }
+    static D sub(D a, D b) { return a - b; }
+    static D mul(D a, D b) { return a * b; }
+    static D div(D a, D b) { return a / b; }
+    static D sqrt(D a) { return std::sqrt(a); }
+    static D abs(D a) { return std::fabs(a); }
+    static D min(D a, D b) { return a < b ? a : b; }
+    static D max(D a, D b) { return a > b ? a : b; }
+    static M less(D a, D b) { return a < b; }
+    static M lessEq(D a, D b) { return a <= b; }
+    static D select(M m, D a, D b) { return m ? a : b; }
+    static bool all(M m) { return m; }
+
+    static D asDouble(U u) { return std::bit_cast<double>(u); }
+    static U asBits(D d) { return std::bit_cast<std::uint64_t>(d); }
+    static U addU(U a, U b) { return a + b; }
+    static U xorU(U a, U b) { return a ^ b; }
+    static U andU(U a, U b) { return a & b; }
+    static U orU(U a, U b) { return a | b; }
+    template <int N> static U shl(U a) { return a << N; }
+    template <int N> static U shr(U a) { return a >> N; }
+    static U mulLo32(U a, U b) { return (a & 0xFFFFFFFFu) * (b & 0xFFFFFFFFu); }
+};
+
+// integer lanes holding values below 2^52, converted exactly to double
+template <class P>
+typename P::D smallToDouble(typename P::U u) {
+    return P::sub(P::asDouble(P::orU(u, P::setU(0x4330000000000000ull))), P::set(0x1.0p52));
+}
+
+// exp(x) to about 1 ulp. x is clamped to [-708, 709], which keeps 2^n normal;
+// NaN propagates.
+template <class P>
+typename P::D exp(typename P::D x) {
+    using D = typename P::D;
+    constexpr double kShifter = 0x1.8p52;
+    constexpr double kLn2Hi = 0x1.62e42feep-1;         // trailing zeros: n * kLn2Hi is exact
+    constexpr double kLn2Lo = 0x1.a39ef35793c76p-33;
+    x = P::max(P::set(-708.0), P::min(P::set(709.0), x));
+
+    // x = n ln2 + r, |r| <= ln2 / 2; the shifter leaves n in the low bits of t
+    const D t = P::add(P::mul(x, P::set(0x1.71547652b82fep0)), P::set(kShifter));
+    const D n = P::sub(t, P::set(kShifter));
+    const D r = P::sub(P::sub(x, P::mul(n, P::set(kLn2Hi))), P::mul(n, P::set(kLn2Lo)));
+
+    // Taylor series to r^13 (truncation < 1e-17 on |r| <= ln2 / 2)
+    constexpr double c[] = {1.0 / 6227020800.0, 1.0 / 479001600.0, 1.0 / 39916800.0,
+                            1.0 / 3628800.0, 1.0 / 362880.0, 1.0 / 40320.0, 1.0 / 5040.0,
+                            1.0 / 720.0, 1.0 / 120.0, 1.0 / 24.0, 1.0 / 6.0, 0.5, 1.0, 1.0};
+    D p = P::set(c[0]);
+    for (std::size_t i = 1; i < sizeof(c) / sizeof(c[0]); ++i) p = P::add(P::mul(p, r), P::set(c[i]));
+
+    // 2^n from the biased exponent n + 1023
+    const auto bias = P::addU(P::asBits(t), P::setU(1023ull - 0x4338000000000000ull));
+    return P::mul(p, P::asDouble(P::template shl<52>(bias)));
+}
+
+// natural log for positive normal x, to a few ulp
+template <class P>
+typename P::D log(typename P::D x) {
+    using D = typename P::D;
+    const auto bits = P::asBits(x);
+    D e = P::sub(smallToDouble<P>(P::template shr<52>(bits)), P::set(1023.0));
+    D m = P::asDouble(P::orU(P::andU(bits, P::setU(0x000FFFFFFFFFFFFFull)),
+                             P::setU(0x3FF0000000000000ull)));
+
+    // m in [sqrt(1/2), sqrt(2)), then log(m) = 2 atanh(s) = 2s + s R(s^2) with
+    // s = (m-1)/(m+1) and fdlibm's minimax R (error below 2^-58 on this range)
+    const auto big = P::less(P::set(1.4142135623730951), m);
+    m = P::select(big, P::mul(m, P::set(0.5)), m);
+    e = P::select(big, P::add(e, P::set(1.0)), e);
+    const D f = P::sub(m, P::set(1.0));
+    const D s = P::div(f, P::add(P::set(2.0), f));
+    const D z = P::mul(s, s);
+    constexpr double lg[] = {1.479819860511658591e-01, 1.531383769920937332e-01,
+                             1.818357216161805012e-01, 2.222219843214978396e-01,
+                             2.857142874366239149e-01, 3.999999999940941908e-01,
+                             6.666666666666735130e-01};
+    D R = P::set(lg[0]);
+    for (int i = 1; i < 7; ++i) R = P::add(P::mul(R, z), P::set(lg[i]));
+    R = P::mul(R, z);
+
+    constexpr double kLn2Hi = 0x1.62e42feep-1;
+    constexpr double kLn2Lo = 0x1.a39ef35793c76p-33;
+    const D lm = P::add(P::add(s, s), P::mul(s, R));
+    return P::add(P::mul(e, P::set(kLn2Hi)), P::add(P::mul(e, P::set(kLn2Lo)), lm));
+}
+
+// Normal quantile, Wichura (1988) AS241 PPND16, relative error ~1e-16.
+// Both regions are rational functions: every lane evaluates the central one,
+// the tail is only evaluated when some lane lies in it, and each lane keeps
+// its own numerator and denominator for a single division at the end.
+namespace as241 {
+// central region |u - 0.5| <= 0.425, highest power first
+constexpr double a[] = {2.5090809287301226727e+3, 3.3430575583588128105e+4,
+                        6.7265770927008700853e+4, 4.5921953931549871457e+4,
+                        1.3731693765509461125e+4, 1.9715909503065514427e+3,
+                        1.3314166789178437745e+2, 3.3871328727963666080e+0};
+constexpr double b[] = {5.2264952788528545610e+3, 2.8729085735721942674e+4,
+                        3.9307895800092710610e+4, 2.1213794301586595867e+4,
+                        5.3941960214247511077e+3, 6.8718700749205790830e+2,
+                        4.2313330701600911252e+1, 1.0};
+// tails, r = sqrt(-log(min(u, 1 - u))) <= 5
+constexpr double c[] = {7.74545014278341407640e-4, 2.27238449892691845833e-2,
+                        2.41780725177450611770e-1, 1.27045825245236838258e+0,
+                        3.64784832476320460504e+0, 5.76949722146069140550e+0,
+                        4.63033784615654529590e+0, 1.42343711074968357734e+0};
+constexpr double d[] = {1.05075007164441684324e-9, 5.47593808499534494600e-4,
+                        1.51986665636164571966e-2, 1.48103976427480074590e-1,
+                        6.89767334985100004550e-1, 1.67638483018380384940e+0,
+                        2.05319162663775882187e+0, 1.0};
+// far tails, r > 5
+constexpr double e[] = {2.01033439929228813265e-7, 2.71155556874348757815e-5,
+                        1.24266094738807843860e-3, 2.65321895265761230930e-2,
+                        2.96560571828504891230e-1, 1.78482653991729133580e+0,
+                        5.46378491116411436990e+0, 6.65790464350110377720e+0};
+constexpr double f[] = {2.04426310338993978564e-15, 1.42151175831644588870e-7,
+                        1.84631831751005468180e-5, 7.86869131145613259100e-4,
+                        1.48753612908506148525e-2, 1.36929880922735805310e-1,
+                        5.99832206555887937690e-1, 1.0};
+}
+
+template <class P>
+typename P::D normalQuantile(typename P::D u) {
+    using D = typename P::D;
+    const D q = P::sub(u, P::set(0.5));
+    const auto central = P::lessEq(P::abs(q), P::set(0.425));
+
+    const D r = P::sub(P::set(0.180625), P::mul(q, q));
+    D num = P::set(as241::a[0]);
+    D den = P::set(as241::b[0]);
+    for (int i = 1; i < 8; ++i) {
+        num = P::add(P::mul(num, r), P::set(as241::a[i]));
+        den = P::add(P::mul(den, r), P::set(as241::b[i]));
+    }
+    num = P::mul(q, num);
+
+    if (!P::all(central)) {
+        const auto lower = P::less(q, P::set(0.0));
+        const D t = P::sqrt(P::sub(P::set(0.0), simd::log<P>(P::select(lower, u, P::sub(P::set(1.0), u)))));
+        const auto near = P::lessEq(t, P::set(5.0));
+        const D x = P::select(near, P::sub(t, P::set(1.6)), P::sub(t, P::set(5.0)));
+        D tn = P::select(near, P::set(as241::c[0]), P::set(as241::e[0]));
+        D td = P::select(near, P::set(as241::d[0]), P::set(as241::f[0]));
+        for (int i = 1; i < 8; ++i) {
+            tn = P::add(P::mul(tn, x), P::select(near, P::set(as241::c[i]), P::set(as241::e[i])));
+            td = P::add(P::mul(td, x), P::select(near, P::set(as241::d[i]), P::set(as241::f[i])));
+        }
+        num = P::select(central, num, P::select(lower, P::sub(P::set(0.0), tn), tn));
+        den = P::select(central, den, td);
+    }
+    return P::div(num, den);
+}
+
+inline double normalQuantile(double u) {
+    return simd::normalQuantile<ScalarPack>(u);
+}
+
+inline double exp(double x) {
+    return simd::exp<ScalarPack>(x);
+}
+
+// Philox4x32-10 on P::width counters at once; each 64-bit lane carries one
+// 32-bit counter word. Same rounds as Philox4x32::generate.
+template <class P>
+void philox(typename P::U c[4], std::uint32_t k0, std::uint32_t k1) {
+    const auto lo32 = P::setU(0xFFFFFFFFull);
+    const auto m0 = P::setU(0xD2511F53u);
+    const auto m1 = P::setU(0xCD9E8D57u);
+    for (int round = 0; round < 10; ++round) {
+        if (round > 0) {
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        const auto p0 = P::mulLo32(m0, c[0]);
+        const auto p1 = P::mulLo32(m1, c[2]);
+        const auto n0 = P::xorU(P::xorU(P::template shr<32>(p1), c[1]), P::setU(k0));
+        const auto n2 = P::xorU(P::xorU(P::template shr<32>(p0), c[3]), P::setU(k1));
+        c[0] = n0;
+        c[1] = P::andU(p1, lo32);
+        c[2] = n2;
+        c[3] = P::andU(p0, lo32);
+    }
+}
+
+// uniform on (0, 1] from two words, as CounterRNG::uniformPair
+template <class P>
+typename P::D closedUniform(typename P::U hi, typename P::U lo) {
+    const auto m = P::add(P::mul(smallToDouble<P>(hi), P::set(0x1.0p21)),
+                          smallToDouble<P>(P::template shr<11>(lo)));
+    return P::mul(P::add(m, P::set(1.0)), P::set(0x1.0p-53));
+}
+
+// uniform on (0, 1), 52 bits, for the normal quantile
+template <class P>
+typename P::D openUniform(typename P::U hi, typename P::U lo) {
+    const auto m = P::add(P::mul(smallToDouble<P>(hi), P::set(0x1.0p20)),
+                          smallToDouble<P>(P::template shr<12>(lo)));
+    return P::mul(P::add(m, P::set(0.5)), P::set(0x1.0p-52));
+}
+
+// Block kernels over `count` lanes. A ragged tail is run through a padded
+// local copy rather than a scalar loop, so an ISA translation unit never
+// instantiates anything shared with the baseline build.
+enum class Draw { ClosedUniform, Normal };
+
+template <class P, Draw kind>
+void drawBlock(std::uint32_t k0, std::uint32_t k1, std::uint64_t firstPath, std::size_t count,
+               std::uint32_t step, std::uint32_t lane, double* out0, double* out1) {
+    for (std::size_t i = 0; i < count; i += P::width) {
+        const auto path = P::lanesFrom(firstPath + i);
+        typename P::U c[4] = {P::setU(step), P::setU(lane),
+                              P::andU(path, P::setU(0xFFFFFFFFull)), P::template shr<32>(path)};
+        philox<P>(c, k0, k1);
+        typename P::D a, b;
+        if constexpr (kind == Draw::Normal) {
+            a = simd::normalQuantile<P>(openUniform<P>(c[0], c[1]));
+            b = simd::normalQuantile<P>(openUniform<P>(c[2], c[3]));
+        } else {
+            a = closedUniform<P>(c[0], c[1]);
+            b = closedUniform<P>(c[2], c[3]);
+        }
+        if (i + P::width <= count) {
+            P::store(out0 + i, a);
+            P::store(out1 + i, b);
+        } else {
+            double ta[P::width], tb[P::width];
+            P::store(ta, a);
+            P::store(tb, b);
+            for (std::size_t j = 0; i + j < count; ++j) {
+                out0[i + j] = ta[j];
+                out1[i + j] = tb[j];
+            }
+        }
+    }
+}
+
+template <class P>
+void scaledExpBlock(const double* x, double scale, std::size_t count, double* out) {
+    const auto s = P::set(scale);
+    std::size_t i = 0;
+    for (; i + P::width <= count; i += P::width) {
+        P::store(out + i, P::mul(s, simd::exp<P>(P::load(x + i))));
+    }
+    if (i < count) {
+        double t[P::width];
+        for (std::size_t j = 0; j < P::width; ++j) t[j] = i + j < count ? x[i + j] : 0.0;
+        P::store(t, P::mul(s, simd::exp<P>(P::load(t))));
+        for (std::size_t j = 0; i + j < count; ++j) out[i + j] = t[j];
+    }
+}
+
+template <class P>
+void normalQuantileBlock(const double* u, std::size_t count, double* out) {
+    std::size_t i = 0;
+    for (; i + P::width <= count; i += P::width) {
+        P::store(out + i, simd::normalQuantile<P>(P::load(u + i)));
+    }
+    if (i < count) {
+        double t[P::width];
+        for (std::size_t j = 0; j < P::width; ++j) t[j] = i + j < count ? u[i + j] : 0.5;
+        P::store(t, simd::normalQuantile<P>(P::load(t)));
+        for (std::size_t j = 0; i + j < count; ++j) out[i + j] = t[j];
+    }
+}
+
+}
@@ -0,0 +1,321 @@
+#include "static_pricer.hpp"
+#include "counter_rng.hpp"
+#include "lsm_pricer.hpp"
+#include "ols_regressor.hpp"
+#include "parallel.hpp"
+#include "simd_kernels.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <typeinfo>
+
+namespace lsm {
+
+namespace {
+
+// the payoffs' evaluateBatch(), one spot at a time and inline
+template <class P>
+struct PayoffKernel;
+
+template <>
+struct PayoffKernel<PutPayoff> {
+    static double value(double K, double S) { return std::max(K - S, 0.0); }
+};
+
+template <>
+struct PayoffKernel<CallPayoff> {
+    static double value(double K, double S) { return std::max(S - K, 0.0); }
+};
+
+// the M + 1 columns of BasisFamily(B, M) at one point, through the same
+// recurrences in the same order of operations; for Laguerre, t[1] must
+// already hold the weight
+template <BasisFamilyType B, int M>
+inline void basisTerms(double x, double* t) {
+    static_assert(B == BasisFamilyType::Laguerre || B == BasisFamilyType::Monomial,
+                  "StaticLSMPricer: Laguerre and Monomial bases only");
+    t[0] = 1.0;
+    if constexpr (M == 0) return;
+    if constexpr (B == BasisFamilyType::Monomial) {
+        for (int k = 1; k <= M; ++k) t[k] = x * t[k - 1];
+    } else {
+        // t[1], the weight exp(-x/2), comes in precomputed
+        if constexpr (M >= 2) t[2] = t[1] * (1.0 - x);
+        for (int k = 1; k + 2 <= M; ++k) {
+            t[k + 2] = ((2.0 * k + 1.0 - x) * t[k + 1] - static_cast<double>(k) * t[k]) /
+                       static_cast<double>(k + 1);
+        }
+    }
+}
+
+void validate(const LSMConfig& cfg) {
+    if (cfg.numPaths <= 0 || cfg.numExerciseDates <= 0 || cfg.maturity <= 0.0) {
+        throw std::invalid_argument("LSMConfig: numPaths, numExerciseDates and maturity must be > 0");
+    }
+    if (cfg.useAntithetic && cfg.numPaths % 2 != 0) {
+        throw std::invalid_argument("LSMConfig: antithetic sampling needs an even numPaths");
+    }
+}
+
+bool supported(const LSMConfig& cfg) {
+    return !cfg.lowMemory && cfg.samplingScheme == SamplingScheme::PseudoRandom &&
+           !cfg.useControlVariate && !cfg.computeGreeks && cfg.basisPrecision == PathPrecision::Double;
+}
+
+}
+
+// StaticLSMPricer
+template <class Process, class Payoff, BasisFamilyType Basis, int M>
+StaticLSMPricer<Process, Payoff, Basis, M>::StaticLSMPricer(const LSMConfig& cfg, Process process,
+                                                            Payoff payoff)
+    : cfg_(cfg), process_(std::move(process)), payoff_(std::move(payoff)) {
+    validate(cfg_);
+    if (!supported(cfg_)) {
+        throw std::logic_error("StaticLSMPricer: supports neither low-memory mode, Sobol sampling, "
+                               "the control variate, Greeks nor a float design matrix");
+    }
+}
+
+template <class Process, class Payoff, BasisFamilyType Basis, int M>
+SimulationResult StaticLSMPricer<Process, Payoff, Basis, M>::price(double S0) const {
+    constexpr int m = M + 1;
+    using Kernel = PayoffKernel<Payoff>;
+    using Regressor = FixedOLSRegressor<m>;
+
+    PricingWorkspace local;
+    PricingWorkspace& ws = workspace_ ? *workspace_ : local;
+    ws.reset();
+
+    const int D = cfg_.numExerciseDates;
+    const std::size_t N = cfg_.numPaths;
+    const std::size_t numDates = D + 1;
+    const double dt = cfg_.maturity / D;
+    const double df = std::exp(-cfg_.riskFreeRate * dt);
+    const double discT = std::exp(-cfg_.riskFreeRate * cfg_.maturity);
+    const double K = payoff_.strike();
+    const double invK = 1.0 / K;
+    const std::size_t half = cfg_.useAntithetic ? N / 2 : N;
+    const CounterRNG rng(cfg_.rngSeed);
+
+    // LSMPricer::simulate(): tiles of kTilePaths simulated date-major and
+    // stored row by row, a tile straddling the antithetic midpoint as two
+    PathMatrix& paths = ws.gridStorage(N, numDates, cfg_.pathPrecision);
+    {
+        const std::size_t numTiles = (N + kTilePaths - 1) / kTilePaths;
+        const std::size_t workers = std::max<std::size_t>(
+            1, std::min<std::size_t>(static_cast<std::size_t>(effectiveThreadCount(cfg_.numThreads)), numTiles));
+        const std::size_t perWorker = kTilePaths * numDates;
+        const auto buffers = ws.allocate<double>(workers * perWorker);
+        parallelFor(workers, cfg_.numThreads, [&](std::size_t cBegin, std::size_t cEnd) {
+            for (std::size_t c = cBegin; c < cEnd; ++c) {
+                double* block = buffers.data() + c * perWorker;
+                for (std::size_t t = c * numTiles / workers; t < (c + 1) * numTiles / workers; ++t) {
+                    const std::size_t first = t * kTilePaths;
+                    const std::size_t n = std::min(kTilePaths, N - first);
+                    for (std::size_t done = 0; done < n;) {
+                        const std::size_t p = first + done;
+                        const bool mirror = p >= half;
+                        const std::size_t run = mirror ? n - done : std::min(n - done, half - p);
+                        process_.simulateBlock(S0, dt, rng, mirror ? p - half : p, mirror, run,
+                                               std::span<double>(block, run * numDates));
+                        paths.storeBlock(p, run, block);
+                        done += run;
+                    }
+                }
+            }
+        });
+    }
+
+    // LSMPricer::backwardInduction()'s fixed blocks, with the regressor
+    // count known: the normal equations live in the block itself
+    struct Block {
+        std::size_t begin = 0, end = 0;
+        std::size_t n = 0;
+        std::span<std::size_t> itm;
+        std::span<double> spot, x, y, exercise, fit, X;
+        std::array<double, m * m> XtX{};
+        std::array<double, m> Xty{};
+        double european = 0.0;
+    };
+    const std::size_t numBlocks = (N + kBlockPaths - 1) / kBlockPaths;
+    const auto blocks = ws.allocate<Block>(numBlocks);
+    for (std::size_t b = 0; b < numBlocks; ++b) {
+        Block& blk = blocks[b];
+        blk.begin = b * kBlockPaths;
+        blk.end = std::min(N, blk.begin + kBlockPaths);
+        const std::size_t size = blk.end - blk.begin;
+        blk.itm = ws.allocate<std::size_t>(size);
+        blk.spot = ws.allocate<double>(size);
+        blk.x = ws.allocate<double>(size);
+        blk.y = ws.allocate<double>(size);
+        blk.exercise = ws.allocate<double>(size);
+        blk.fit = ws.allocate<double>(size);
+        blk.X = ws.allocate<double>(size * m);
+    }
+    auto forBlocks = [&](auto&& body) {
+        parallelFor(numBlocks, cfg_.numThreads, [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t b = lo; b < hi; ++b) body(blocks[b]);
+        });
+    };
+
+    const auto cash = ws.allocate<double>(N);
+    forBlocks([&](Block& blk) {
+        const auto S = paths.readDate(D, blk.begin, blk.end, blk.spot);
+        double* c = cash.data() + blk.begin;
+        for (std::size_t i = 0; i < S.size(); ++i) c[i] = Kernel::value(K, S[i]);
+        for (std::size_t i = 0; i < S.size(); ++i) blk.european += c[i];
+    });
+    double european = 0.0;
+    for (const auto& blk : blocks) european += blk.european;
+    european *= discT / N;
+
+    std::array<double, m * m> totalXtX;
+    std::array<double, m> totalXty, beta;
+    for (int k = D - 1; k >= 1; --k) {
+        forBlocks([&](Block& blk) {
+            const auto spots = paths.readDate(k, blk.begin, blk.end, blk.spot);
+            const std::size_t size = spots.size();
+            const double* S = spots.data();
+            double* c = cash.data() + blk.begin;
+            double* h = blk.fit.data();             // free until the exercise pass
+            std::size_t* itm = blk.itm.data();
+            double* x = blk.x.data();
+            double* y = blk.y.data();
+            double* exercise = blk.exercise.data();
+            // payoff and discounting vectorise as separate passes; folding
+            // them into the compaction loop measured slower
+            for (std::size_t i = 0; i < size; ++i) h[i] = Kernel::value(K, S[i]);
+            for (std::size_t i = 0; i < size; ++i) c[i] *= df;
+            std::size_t n = 0;
+            for (std::size_t i = 0; i < size; ++i) {
+                itm[n] = blk.begin + i;
+                x[n] = S[i] * invK;
+                y[n] = c[i];
+                exercise[n] = h[i];
+                n += h[i] > 0.0;
+            }
+            blk.n = n;
+            blk.XtX.fill(0.0);
+            blk.Xty.fill(0.0);
+            if (n == 0) return;
+            double* X = blk.X.data();
+            if constexpr (Basis == BasisFamilyType::Laguerre && M >= 1) {
+                // the weight through the vector exp over the whole compacted
+                // block, then the recurrence a path at a time
+                double* w = X + n;
+                for (std::size_t i = 0; i < n; ++i) w[i] = -0.5 * x[i];
+                simd::scaledExpBlock(w, 1.0, n, w);
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                double t[m];
+                if constexpr (Basis == BasisFamilyType::Laguerre && M >= 1) t[1] = X[n + i];
+                basisTerms<Basis, M>(x[i], t);
+                for (int j = 0; j < m; ++j) X[j * n + i] = t[j];
+            }
+            Regressor::accumulate(X, y, n, blk.XtX.data(), blk.Xty.data());
+        });
+
+        totalXtX.fill(0.0);
+        totalXty.fill(0.0);
+        std::size_t count = 0;
+        for (const auto& blk : blocks) {
+            for (int i = 0; i < m * m; ++i) totalXtX[i] += blk.XtX[i];
+            for (int i = 0; i < m; ++i) totalXty[i] += blk.Xty[i];
+            count += blk.n;
+        }
+        if (count < static_cast<std::size_t>(m)) continue;     // too few points to regress
+        Regressor::solve(totalXtX.data(), totalXty.data(), beta.data());
+
+        forBlocks([&](Block& blk) {
+            const std::size_t n = blk.n;
+            if (n == 0) return;
+            Regressor::predict(blk.X.data(), beta.data(), n, blk.fit.data());
+            for (std::size_t i = 0; i < n; ++i) {
+                const std::size_t p = blk.itm[i];
+                const bool stop = blk.exercise[i] > blk.fit[i];
+                cash[p] = stop ? blk.exercise[i] : cash[p];
+            }
+        });
+    }
+    forBlocks([&](Block& blk) {
+        for (std::size_t p = blk.begin; p < blk.end; ++p) cash[p] *= df;
+    });
+
+    // antithetic pairs (p, p + N/2) are averaged before taking the variance
+    auto sample = [&](std::size_t i) { return cfg_.useAntithetic ? 0.5 * (cash[i] + cash[i + half]) : cash[i]; };
+    double sum = 0.0;
+    for (std::size_t i = 0; i < half; ++i) sum += sample(i);
+    const double mean = sum / half;
+    double ss = 0.0;
+    for (std::size_t i = 0; i < half; ++i) {
+        const double d = sample(i) - mean;
+        ss += d * d;
+    }
+    const double var = half > 1 ? ss / (half - 1) : 0.0;
+
+    SimulationResult res;
+    res.optionValue = mean;
+    res.standardError = std::sqrt(var / half);
+    // exercising at t = 0 is also allowed
+    const double immediate = Kernel::value(K, S0);
+    if (immediate > res.optionValue) {
+        res.optionValue = immediate;
+        res.standardError = 0.0;
+    }
+    res.europeanValue = european;
+    res.earlyExercisePremium = res.optionValue - res.europeanValue;
+    return res;
+}
+
+// only the server's default contract, a Laguerre M = 3 put or call on GBM:
+// each instance costs seconds of compile time
+template class StaticLSMPricer<GeometricBrownianMotion, PutPayoff, BasisFamilyType::Laguerre, 3>;
+template class StaticLSMPricer<GeometricBrownianMotion, CallPayoff, BasisFamilyType::Laguerre, 3>;
+
+// makeSpecialisedPricer
+namespace {
+
+template <class Payoff>
+PricingFunction bindStatic(const LSMConfig& cfg, const StochasticProcess& process, const lsm::Payoff& payoff,
+                     std::shared_ptr<PricingWorkspace> ws) {
+    using Pricer = StaticLSMPricer<GeometricBrownianMotion, Payoff, BasisFamilyType::Laguerre, 3>;
+    auto pricer = std::make_shared<Pricer>(cfg, static_cast<const GeometricBrownianMotion&>(process),
+                                           static_cast<const Payoff&>(payoff));
+    pricer->setWorkspace(std::move(ws));
+    return [pricer](double S0) { return pricer->price(S0); };
+}
+
+// exact types only, since a subclass may override what the kernels inline
+bool compiledIn(const LSMConfig& cfg, const StochasticProcess& process, const lsm::Payoff& payoff,
+                BasisFamily basis) {
+    return supported(cfg) && typeid(process) == typeid(GeometricBrownianMotion) &&
+           (typeid(payoff) == typeid(PutPayoff) || typeid(payoff) == typeid(CallPayoff)) &&
+           basis.type() == BasisFamilyType::Laguerre && basis.numTerms() == 3;
+}
+
+}
+
+PricingFunction makeSpecialisedPricer(const LSMConfig& cfg,
+                                      std::unique_ptr<StochasticProcess> process,
+                                      std::unique_ptr<lsm::Payoff> payoff,
+                                      BasisFamily basis,
+                                      std::shared_ptr<PricingWorkspace> ws) {
+    if (!process || !payoff) {
+        throw std::invalid_argument("makeSpecialisedPricer: process and payoff are required");
+    }
+    if (compiledIn(cfg, *process, *payoff, basis)) {
+        return typeid(*payoff) == typeid(PutPayoff) ? bindStatic<PutPayoff>(cfg, *process, *payoff, std::move(ws))
+                                                    : bindStatic<CallPayoff>(cfg, *process, *payoff, std::move(ws));
+    }
+    auto pricer = std::make_shared<LSMPricer>(cfg, std::move(process), std::move(payoff), basis);
+    pricer->setWorkspace(std::move(ws));
+    return [pricer](double S0) { return pricer->price(S0); };
+}
+
+bool hasSpecialisedPricer(const LSMConfig& cfg, const StochasticProcess& process,
+                          const lsm::Payoff& payoff, BasisFamily basis) {
+    return compiledIn(cfg, process, payoff, basis);
+}
+
+}
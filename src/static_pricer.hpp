@@ -0,0 +1,75 @@
+#pragma once
+
+#include "lsm_types.hpp"
+#include "basis_functions.hpp"
+#include "payoffs.hpp"
+#include "pricing_workspace.hpp"
+#include "stochastic_processes.hpp"
+#include <functional>
+#include <memory>
+
+namespace lsm {
+
+//  StaticLSMPricer  
+// - LSMPricer's stored-grid price() with the process, payoff and basis fixed
+//   at compile time: Process and Payoff are held by value, so their calls
+//   need no virtual dispatch, and the payoff and the M + 1 basis columns
+//   (constant included) of the Basis family are inlined kernels; the
+//   design matrix is filled a path at a time and the normal equations go
+//   through FixedOLSRegressor<M + 1> directly. The Laguerre weight
+//   exp(-x/2), which dominates the scalar basis pass, goes through
+//   simd::scaledExpBlock over each block's compacted in-the-money paths.
+//
+//   Paths, block order and the rest of the arithmetic are LSMPricer's:
+//   the European value is the same bit for bit, and the price agrees to a
+//   small fraction of its standard error, since the vector exp can round
+//   the weight differently from std::exp and flip a marginal exercise
+//   decision. Results are the same bits for any cfg.numThreads.
+//
+//   Supports antithetic paths and float path storage; low-memory mode,
+//   Sobol sampling, the control variate, Greeks and a float design matrix
+//   throw std::logic_error. cfg.profile is ignored. Instantiated only for
+//   GeometricBrownianMotion with PutPayoff or CallPayoff on the Laguerre
+//   basis with M = 3; the template also takes JumpDiffusionProcess and
+//   Monomial bases, should a further instance pay for its compile time.
+
+template <class Process, class Payoff, BasisFamilyType Basis, int M>
+class StaticLSMPricer {
+public:
+    StaticLSMPricer(const LSMConfig& cfg, Process process, Payoff payoff);
+
+    SimulationResult price(double S0) const;
+
+    // reuse ws for every call's scratch memory and grid (nullptr detaches);
+    // once warm, a single-threaded price() performs no heap allocation
+    void setWorkspace(std::shared_ptr<PricingWorkspace> ws) { workspace_ = std::move(ws); }
+
+    const LSMConfig& config() const { return cfg_; }
+    static constexpr int numBasis() { return M + 1; }
+
+private:
+    LSMConfig cfg_;
+    Process process_;
+    Payoff payoff_;
+    std::shared_ptr<PricingWorkspace> workspace_;
+};
+
+//  makeSpecialisedPricer  
+// - price(S0) through the StaticLSMPricer instance for (process, payoff,
+//   basis) when one is compiled in and cfg is within what it supports, and
+//   through an LSMPricer on the same arguments otherwise. ws, when given,
+//   is attached to whichever is built.
+
+using PricingFunction = std::function<SimulationResult(double S0)>;
+
+PricingFunction makeSpecialisedPricer(const LSMConfig& cfg,
+                                      std::unique_ptr<StochasticProcess> process,
+                                      std::unique_ptr<lsm::Payoff> payoff,
+                                      BasisFamily basis,
+                                      std::shared_ptr<PricingWorkspace> ws = nullptr);
+
+// whether makeSpecialisedPricer() would pick a StaticLSMPricer
+bool hasSpecialisedPricer(const LSMConfig& cfg, const StochasticProcess& process,
+                          const lsm::Payoff& payoff, BasisFamily basis);
+
+}
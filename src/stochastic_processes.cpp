@@ -0,0 +1,379 @@
+#include "stochastic_processes.hpp"
+#include "simd_kernels.hpp"
+#include <algorithm>
+#include <sstream>
+
+namespace lsm {
+
+namespace {
+
+// Random-stream lanes; each (path, step) pair owns one Philox block per lane.
+constexpr std::uint32_t kDiffusionLane = 0;
+constexpr std::uint32_t kJumpCountLane = 1;
+constexpr std::uint32_t kJumpSizeLane  = 2;
+
+// paths a block kernel advances together; bounds its stack scratch
+constexpr std::size_t kBlockLanes = 64;
+
+// Gaussian draw for step k: steps 2m and 2m+1 share one normalPair
+double gaussian(const CounterRNG& rng, std::uint64_t pathId, std::size_t k,
+                std::pair<double, double>& pair) {
+    if (k % 2 == 0) {
+        pair = rng.normalPair(pathId, static_cast<std::uint32_t>(k / 2), kDiffusionLane);
+        return pair.first;
+    }
+    return pair.second;
+}
+
+// Same draw as gaussian(), for callers visiting steps in any order: the pair
+// and its index are cached in state[2..4]
+constexpr std::size_t kGbmStateSize = 5;
+
+double cachedGaussian(const CounterRNG& rng, std::uint64_t pathId, std::size_t k,
+                      std::span<double> state) {
+    const double idx = static_cast<double>(k / 2);
+    if (state[2] != idx) {
+        const auto pair = rng.normalPair(pathId, static_cast<std::uint32_t>(k / 2), kDiffusionLane);
+        state[2] = idx;
+        state[3] = pair.first;
+        state[4] = pair.second;
+    }
+    return k % 2 == 0 ? state[3] : state[4];
+}
+
+// Even checkpoint spacing close to sqrt(numSteps) for jump-diffusion replay
+std::size_t checkpointInterval(std::size_t numSteps) {
+    auto C = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(numSteps))));
+    return std::max<std::size_t>(2, C + C % 2);
+}
+
+// exact text form of a parameter list, for cache keys
+std::string exactKey(const std::string& name, std::initializer_list<double> params) {
+    std::ostringstream out;
+    out << std::hexfloat << name;
+    for (double p : params) out << ':' << p;
+    return out.str();
+}
+
+// Number of Poisson(mean) events by inversion; mean = lambda*dt is small
+int poissonInverse(double u, double mean) {
+    double p = std::exp(-mean);
+    double cdf = p;
+    int n = 0;
+    while (u > cdf && n < 64) {
+        ++n;
+        p *= mean / n;
+        cdf += p;
+    }
+    return n;
+}
+
+}
+
+// GeometricBrownianMotion
+GeometricBrownianMotion::GeometricBrownianMotion(double r, double sigma) {
+    if (sigma < 0.0) {
+        throw std::invalid_argument("sigma must be >= 0");
+    }
+    r_ = r;
+    sigma_ = sigma;
+}
+
+void GeometricBrownianMotion::simulatePath(double S0, double dt, const CounterRNG& rng,
+                                           std::uint64_t pathId, bool antithetic,
+                                           std::span<double> out) const {
+    const std::size_t D = out.size() - 1;
+    out[0] = S0;
+    if (D == 0) return;
+
+    double state[kGbmStateSize];
+    out[D] = GeometricBrownianMotion::beginBackward(S0, dt, D, rng, pathId, antithetic, state);
+    for (std::size_t k = D - 1; k >= 1; --k) {
+        out[k] = GeometricBrownianMotion::stepBackward(dt, k, rng, pathId, antithetic, state);
+    }
+}
+
+// The same backward bridge for a whole block, one date row at a time: each
+// Gaussian pair row comes from simd::normalBlock and serves two dates, and
+// the spots come from simd::scaledExpBlock.
+void GeometricBrownianMotion::simulateBlock(double S0, double dt, const CounterRNG& rng,
+                                            std::uint64_t firstPathId, bool antithetic,
+                                            std::size_t count, std::span<double> out) const {
+    const std::size_t D = out.size() / count - 1;
+    std::fill_n(out.data(), count, S0);
+    if (D == 0) return;
+
+    const double sign = antithetic ? -1.0 : 1.0;
+    const double mu = r_ - 0.5 * sigma_ * sigma_;
+    double W[kBlockLanes], zEven[kBlockLanes], zOdd[kBlockLanes];
+    for (std::size_t c = 0; c < count; c += kBlockLanes) {
+        const std::size_t n = std::min(kBlockLanes, count - c);
+        for (std::size_t k = D; k >= 1; --k) {
+            const std::size_t j = k - 1;
+            if (k == D || j % 2 == 1) {
+                simd::normalBlock(rng, firstPathId + c, n, static_cast<std::uint32_t>(j / 2),
+                                  kDiffusionLane, zEven, zOdd);
+            }
+            const double* zj = j % 2 == 0 ? zEven : zOdd;
+            if (k == D) {
+                const double a = std::sqrt(D * dt) * sign;
+                for (std::size_t i = 0; i < n; ++i) W[i] = a * zj[i];
+            } else {
+                const double ratio = static_cast<double>(k) / static_cast<double>(k + 1);
+                const double a = std::sqrt(dt * ratio) * sign;
+                for (std::size_t i = 0; i < n; ++i) W[i] = ratio * W[i] + a * zj[i];
+            }
+            double* row = out.data() + k * count + c;
+            const double drift = mu * (k * dt);
+            for (std::size_t i = 0; i < n; ++i) row[i] = drift + sigma_ * W[i];
+            simd::scaledExpBlock(row, S0, n, row);
+        }
+    }
+}
+
+bool GeometricBrownianMotion::simulateFromBrownian(double S0, double dt, std::size_t count,
+                                                   std::span<const double> W,
+                                                   std::span<double> out) const {
+    const std::size_t D = out.size() / count - 1;
+    const double mu = r_ - 0.5 * sigma_ * sigma_;
+    std::fill_n(out.data(), count, S0);
+    for (std::size_t k = 1; k <= D; ++k) {
+        const double* w = W.data() + (k - 1) * count;
+        double* row = out.data() + k * count;
+        const double drift = mu * (k * dt);
+        for (std::size_t i = 0; i < count; ++i) row[i] = drift + sigma_ * w[i];
+        simd::scaledExpBlock(row, S0, count, row);
+    }
+    return true;
+}
+
+// state: [0] W at the last date produced, [1] S0, [2] index of the cached
+// Gaussian pair, [3..4] that pair
+std::size_t GeometricBrownianMotion::backwardStateSize(std::size_t) const {
+    return kGbmStateSize;
+}
+
+double GeometricBrownianMotion::beginBackward(double S0, double dt, std::size_t numSteps,
+                                              const CounterRNG& rng, std::uint64_t pathId,
+                                              bool antithetic, std::span<double> state) const {
+    const double sign = antithetic ? -1.0 : 1.0;
+    state[1] = S0;
+    state[2] = -1.0;
+    const double W = std::sqrt(numSteps * dt) * sign * cachedGaussian(rng, pathId, numSteps - 1, state);
+    state[0] = W;
+    return state[1] * simd::exp((r_ - 0.5 * sigma_ * sigma_) * (numSteps * dt) + sigma_ * W);
+}
+
+double GeometricBrownianMotion::stepBackward(double dt, std::size_t k, const CounterRNG& rng,
+                                             std::uint64_t pathId, bool antithetic,
+                                             std::span<double> state) const {
+    const double sign = antithetic ? -1.0 : 1.0;
+    const double ratio = static_cast<double>(k) / static_cast<double>(k + 1);
+    const double W = ratio * state[0]
+                   + std::sqrt(dt * ratio) * sign * cachedGaussian(rng, pathId, k - 1, state);
+    state[0] = W;
+    return state[1] * simd::exp((r_ - 0.5 * sigma_ * sigma_) * (k * dt) + sigma_ * W);
+}
+
+// W_k is recovered from S_k itself, so no random draws are repeated
+bool GeometricBrownianMotion::sensitivities(double S0, double dt, std::size_t k, double Sk,
+                                            double S1, const CounterRNG&, std::uint64_t, bool,
+                                            PathSensitivity& out) const {
+    if (sigma_ <= 0.0) return false;
+    const double mu = r_ - 0.5 * sigma_ * sigma_;
+    const double t = k * dt;
+    const double Wk = (std::log(Sk / S0) - mu * t) / sigma_;
+    const double Z1 = (std::log(S1 / S0) - mu * dt) / (sigma_ * std::sqrt(dt));
+    out.dS_dS0 = Sk / S0;
+    out.dS_dSigma = Sk * (Wk - sigma_ * t);
+    out.score = Z1 / (S0 * sigma_ * std::sqrt(dt));
+    return true;
+}
+
+bool GeometricBrownianMotion::isScaleInvariant() const {
+    return true;
+}
+
+std::string GeometricBrownianMotion::cacheKey() const {
+    return exactKey(name(), {r_, sigma_});
+}
+
+std::string GeometricBrownianMotion::name() const {
+    return "GBM";
+}
+
+// JumpDiffusionProcess
+JumpDiffusionProcess::JumpDiffusionProcess(double r, double sigma, double lambda,
+                                           double jumpMean, double jumpVol) {
+    if (sigma < 0.0 || lambda < 0.0 || jumpVol < 0.0) {
+        throw std::invalid_argument("sigma, lambda and jumpVol must be >= 0");
+    }
+    r_ = r;
+    sigma_ = sigma;
+    lambda_ = lambda;
+    jumpMean_ = jumpMean;
+    jumpVol_ = jumpVol;
+    kappa_ = std::exp(jumpMean_ + 0.5 * jumpVol_ * jumpVol_) - 1.0;
+}
+
+double JumpDiffusionProcess::logIncrement(std::size_t j, double dt, const CounterRNG& rng,
+                                          std::uint64_t pathId, bool antithetic,
+                                          std::pair<double, double>& pair) const {
+    const double sign = antithetic ? -1.0 : 1.0;
+    const double drift = (r_ - lambda_ * kappa_ - 0.5 * sigma_ * sigma_) * dt;
+    const double mean = lambda_ * dt;
+    double inc = drift + sigma_ * std::sqrt(dt) * sign * gaussian(rng, pathId, j, pair);
+
+    if (mean > 0.0) {
+        // n i.i.d. N(mu, v^2) log-jumps add up to N(n mu, n v^2), so one
+        // Gaussian covers every jump in the step; it is only drawn when
+        // a jump actually occurs
+        const auto step = static_cast<std::uint32_t>(j);
+        const int n = poissonInverse(rng.uniformPair(pathId, step, kJumpCountLane).first, mean);
+        if (n > 0) {
+            const double z = rng.normalPair(pathId, step, kJumpSizeLane).first;
+            inc += n * jumpMean_ + std::sqrt(static_cast<double>(n)) * jumpVol_ * sign * z;
+        }
+    }
+    return inc;
+}
+
+void JumpDiffusionProcess::simulatePath(double S0, double dt, const CounterRNG& rng,
+                                        std::uint64_t pathId, bool antithetic,
+                                        std::span<double> out) const {
+    std::pair<double, double> pair;
+    double X = 0.0;
+    out[0] = S0;
+    for (std::size_t k = 1; k < out.size(); ++k) {
+        X += logIncrement(k - 1, dt, rng, pathId, antithetic, pair);
+        out[k] = S0 * simd::exp(X);
+    }
+}
+
+// Forward over the block one step at a time. Jumps are rare (lambda * dt is
+// small), so the jump count and size stay scalar for the paths that get one.
+void JumpDiffusionProcess::simulateBlock(double S0, double dt, const CounterRNG& rng,
+                                         std::uint64_t firstPathId, bool antithetic,
+                                         std::size_t count, std::span<double> out) const {
+    const std::size_t D = out.size() / count - 1;
+    std::fill_n(out.data(), count, S0);
+
+    const double sign = antithetic ? -1.0 : 1.0;
+    const double drift = (r_ - lambda_ * kappa_ - 0.5 * sigma_ * sigma_) * dt;
+    const double a = sigma_ * std::sqrt(dt) * sign;
+    const double mean = lambda_ * dt;
+    const double noJump = std::exp(-mean);      // first step of poissonInverse
+    double X[kBlockLanes], inc[kBlockLanes], zEven[kBlockLanes], zOdd[kBlockLanes];
+    double u[2 * kBlockLanes];
+    for (std::size_t c = 0; c < count; c += kBlockLanes) {
+        const std::size_t n = std::min(kBlockLanes, count - c);
+        const std::uint64_t first = firstPathId + c;
+        std::fill_n(X, n, 0.0);
+        for (std::size_t j = 0; j < D; ++j) {
+            const auto step = static_cast<std::uint32_t>(j);
+            if (j % 2 == 0) simd::normalBlock(rng, first, n, step / 2, kDiffusionLane, zEven, zOdd);
+            const double* zj = j % 2 == 0 ? zEven : zOdd;
+            for (std::size_t i = 0; i < n; ++i) inc[i] = drift + a * zj[i];
+
+            if (mean > 0.0) {
+                simd::uniformBlock(rng, first, n, step, kJumpCountLane, u, u + kBlockLanes);
+                for (std::size_t i = 0; i < n; ++i) {
+                    if (u[i] <= noJump) continue;
+                    const int jumps = poissonInverse(u[i], mean);
+                    const double zJ = rng.normalPair(first + i, step, kJumpSizeLane).first;
+                    inc[i] += jumps * jumpMean_ + std::sqrt(static_cast<double>(jumps)) * jumpVol_ * sign * zJ;
+                }
+            }
+            for (std::size_t i = 0; i < n; ++i) X[i] += inc[i];
+            simd::scaledExpBlock(X, S0, n, out.data() + (j + 1) * count + c);
+        }
+    }
+}
+
+// state: [0] cached segment (-1 = none), [1] numSteps, [2] S0, then
+// X = log(S/S0) at every checkpoint date 0, C, 2C, ..., then X over the
+// cached segment
+std::size_t JumpDiffusionProcess::backwardStateSize(std::size_t numSteps) const {
+    const std::size_t C = checkpointInterval(numSteps);
+    return 3 + (numSteps / C + 1) + (C + 1);
+}
+
+double JumpDiffusionProcess::beginBackward(double S0, double dt, std::size_t numSteps,
+                                           const CounterRNG& rng, std::uint64_t pathId,
+                                           bool antithetic, std::span<double> state) const {
+    const std::size_t C = checkpointInterval(numSteps);
+    double* checkpoints = state.data() + 3;
+    state[0] = -1.0;
+    state[1] = static_cast<double>(numSteps);
+    state[2] = S0;
+
+    std::pair<double, double> pair;
+    double X = 0.0;
+    checkpoints[0] = X;
+    for (std::size_t k = 1; k <= numSteps; ++k) {
+        X += logIncrement(k - 1, dt, rng, pathId, antithetic, pair);
+        if (k % C == 0) checkpoints[k / C] = X;
+    }
+    return S0 * simd::exp(X);
+}
+
+double JumpDiffusionProcess::stepBackward(double dt, std::size_t k, const CounterRNG& rng,
+                                          std::uint64_t pathId, bool antithetic,
+                                          std::span<double> state) const {
+    const auto numSteps = static_cast<std::size_t>(state[1]);
+    const std::size_t C = checkpointInterval(numSteps);
+    const double* checkpoints = state.data() + 3;
+    double* segment = state.data() + 3 + (numSteps / C + 1);
+
+    // C is even, so replay always starts on the first half of a Gaussian pair
+    const std::size_t seg = k / C;
+    if (state[0] != static_cast<double>(seg)) {
+        const std::size_t first = seg * C;
+        const std::size_t last = std::min(first + C, numSteps);
+        std::pair<double, double> pair;
+        double X = checkpoints[seg];
+        segment[0] = X;
+        for (std::size_t j = first; j < last; ++j) {
+            X += logIncrement(j, dt, rng, pathId, antithetic, pair);
+            segment[j - first + 1] = X;
+        }
+        state[0] = static_cast<double>(seg);
+    }
+    return state[2] * simd::exp(segment[k - seg * C]);
+}
+
+// jumps hide W inside S, so the diffusion draws up to date k are replayed;
+// the score conditions on the first step's jumps
+bool JumpDiffusionProcess::sensitivities(double S0, double dt, std::size_t k, double Sk,
+                                         double, const CounterRNG& rng, std::uint64_t pathId,
+                                         bool antithetic, PathSensitivity& out) const {
+    if (sigma_ <= 0.0) return false;
+    const double sign = antithetic ? -1.0 : 1.0;
+    std::pair<double, double> pair;
+    double sumZ = 0.0;
+    double Z1 = 0.0;
+    for (std::size_t j = 0; j < k; ++j) {
+        const double z = gaussian(rng, pathId, j, pair);
+        if (j == 0) Z1 = sign * z;
+        sumZ += z;
+    }
+    const double Wk = sign * std::sqrt(dt) * sumZ;
+    out.dS_dS0 = Sk / S0;
+    out.dS_dSigma = Sk * (Wk - sigma_ * k * dt);
+    out.score = Z1 / (S0 * sigma_ * std::sqrt(dt));
+    return true;
+}
+
+bool JumpDiffusionProcess::isScaleInvariant() const {
+    return true;
+}
+
+std::string JumpDiffusionProcess::cacheKey() const {
+    return exactKey(name(), {r_, sigma_, lambda_, jumpMean_, jumpVol_});
+}
+
+std::string JumpDiffusionProcess::name() const {
+    return "JumpDiffusion";
+}
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "lsm_types.hpp"
+#include "counter_rng.hpp"
+#include <cmath>
+#include <string>
+#include <stdexcept>
+
+namespace lsm {
+
+//  GeometricBrownianMotion  
+// - risk-neutral GBM, dS = r S dt + sigma S dW, exact in log space.
+//   W is built from the terminal value backward by the Brownian bridge
+//   W_k = k/(k+1) W_{k+1} + sqrt(dt k/(k+1)) Z_k, so low-memory mode can
+//   regenerate every date from W alone. S = S0 * exp(...), so the grid for
+//   any spot is exactly S0 times the grid for S0 = 1.
+
+class GeometricBrownianMotion : public StochasticProcess {
+public:
+    GeometricBrownianMotion(double r, double sigma);
+
+    void simulatePath(double S0, double dt, const CounterRNG& rng,
+                      std::uint64_t pathId, bool antithetic,
+                      std::span<double> out) const;
+    void simulateBlock(double S0, double dt, const CounterRNG& rng,
+                       std::uint64_t firstPathId, bool antithetic,
+                       std::size_t count, std::span<double> out) const;
+    bool simulateFromBrownian(double S0, double dt, std::size_t count,
+                              std::span<const double> W, std::span<double> out) const;
+
+    std::size_t backwardStateSize(std::size_t numSteps) const;
+    double beginBackward(double S0, double dt, std::size_t numSteps,
+                         const CounterRNG& rng, std::uint64_t pathId,
+                         bool antithetic, std::span<double> state) const;
+    double stepBackward(double dt, std::size_t k, const CounterRNG& rng,
+                        std::uint64_t pathId, bool antithetic,
+                        std::span<double> state) const;
+
+    bool sensitivities(double S0, double dt, std::size_t k, double Sk, double S1,
+                       const CounterRNG& rng, std::uint64_t pathId, bool antithetic,
+                       PathSensitivity& out) const;
+
+    bool isScaleInvariant() const;
+    std::string cacheKey() const;
+    std::string name() const;
+
+    double rate() const { return r_; }
+    double volatility() const { return sigma_; }
+
+private:
+    double r_;
+    double sigma_;
+};
+
+//  JumpDiffusionProcess  
+// - Merton (1976) jump-diffusion: GBM plus compound Poisson jumps with
+//   log-normal sizes log(J) ~ N(jumpMean, jumpVol^2); the drift is
+//   compensated so the discounted price stays a martingale. Low-memory mode
+//   keeps log(S/S0) every ~sqrt(D) dates and replays one segment at a time.
+
+class JumpDiffusionProcess : public StochasticProcess {
+public:
+    JumpDiffusionProcess(double r, double sigma, double lambda,
+                         double jumpMean = -0.10, double jumpVol = 0.25);
+
+    void simulatePath(double S0, double dt, const CounterRNG& rng,
+                      std::uint64_t pathId, bool antithetic,
+                      std::span<double> out) const;
+    void simulateBlock(double S0, double dt, const CounterRNG& rng,
+                       std::uint64_t firstPathId, bool antithetic,
+                       std::size_t count, std::span<double> out) const;
+
+    std::size_t backwardStateSize(std::size_t numSteps) const;
+    double beginBackward(double S0, double dt, std::size_t numSteps,
+                         const CounterRNG& rng, std::uint64_t pathId,
+                         bool antithetic, std::span<double> state) const;
+    double stepBackward(double dt, std::size_t k, const CounterRNG& rng,
+                        std::uint64_t pathId, bool antithetic,
+                        std::span<double> state) const;
+
+    bool sensitivities(double S0, double dt, std::size_t k, double Sk, double S1,
+                       const CounterRNG& rng, std::uint64_t pathId, bool antithetic,
+                       PathSensitivity& out) const;
+
+    bool isScaleInvariant() const;
+    std::string cacheKey() const;
+    std::string name() const;
+
+    double rate() const { return r_; }
+    double volatility() const { return sigma_; }
+    double jumpIntensity() const { return lambda_; }
+    double jumpMean() const { return jumpMean_; }
+    double jumpVol() const { return jumpVol_; }
+
+private:
+    // log-spot change over step j (date j -> j+1); forward simulation and
+    // checkpoint replay both go through here so they agree bit for bit
+    double logIncrement(std::size_t j, double dt, const CounterRNG& rng,
+                        std::uint64_t pathId, bool antithetic,
+                        std::pair<double, double>& pair) const;
+
+    double r_;
+    double sigma_;
+    double lambda_;
+    double jumpMean_;
+    double jumpVol_;
+    double kappa_;      // E[J - 1], the jump compensator
+};
+
+}
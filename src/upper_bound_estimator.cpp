@@ -0,0 +1,163 @@
+#include "upper_bound_estimator.hpp"
+#include "counter_rng.hpp"
+#include "lsm_pricer.hpp"
+#include "ols_regressor.hpp"
+#include "parallel.hpp"
+#include "pricing_workspace.hpp"
+#include "simd_math.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace lsm {
+
+namespace {
+
+// offsets separating the inner and lower-bound seeds from the outer one
+constexpr std::uint64_t kInnerSeedOffset = 0xD1B54A32D192ED03ull;
+constexpr std::uint64_t kLowerSeedOffset = 0x8CB92BA72F3D8DD7ull;
+
+// outer paths per pool task: enough to amortise the task's scratch, few
+// enough that uneven in-the-money counts still balance
+constexpr std::size_t kOuterPathsPerTask = 8;
+
+}
+
+UpperBoundEstimator::UpperBoundEstimator(const LSMPricer& pricer, UpperBoundConfig cfg)
+    : pricer_(pricer), cfg_(cfg) {
+    if (cfg_.numOuterPaths < 2 || cfg_.numInnerPaths < 1) {
+        throw std::invalid_argument("UpperBoundEstimator: need at least 2 outer and 1 inner path");
+    }
+    if (!(cfg_.confidenceLevel > 0.0 && cfg_.confidenceLevel < 1.0)) {
+        throw std::invalid_argument("UpperBoundEstimator: confidenceLevel must be in (0, 1)");
+    }
+}
+
+UpperBoundResult UpperBoundEstimator::estimate(double S0, ThreadPool* pool) const {
+    const LSMConfig& lsm = pricer_.cfg_;
+    const StochasticProcess& process = *pricer_.process_;
+    const Payoff& payoff = *pricer_.payoff_;
+    const int D = lsm.numExerciseDates;
+    const double dt = lsm.maturity / D;
+    const double invK = 1.0 / payoff.strike();
+
+    // fit the rule, then value it on fresh paths for the lower bound
+    UpperBoundResult res;
+    LSMPricer::Coefficients coeffs;
+    {
+        PricingWorkspace local;
+        PricingWorkspace& ws = pricer_.workspace(local);
+        res.inSample = pricer_.profiled(ws, [&] { return pricer_.fitAndPrice(S0, &coeffs, ws); });
+        ws.reset();
+        const auto lower = pricer_.valueUnderPolicy(S0, cfg_.seed + kLowerSeedOffset, coeffs, ws);
+        res.lowerBound = lower.optionValue;
+        res.lowerStdError = lower.standardError;
+    }
+
+    // Outer path i, inner path j from date k is path ((i (D + 1) + k) n + j)
+    // of the inner stream, so each inner set is one consecutive block.
+    const std::size_t numOuter = cfg_.numOuterPaths;
+    const std::size_t numInner = cfg_.numInnerPaths;
+    const CounterRNG outerRng(cfg_.seed);
+    const CounterRNG innerRng(cfg_.seed + kInnerSeedOffset);
+    struct Chunk {
+        std::vector<double> gaps;
+        long long innerPaths = 0;
+    };
+    auto job = [&](std::size_t task) {
+        const std::size_t first = task * kOuterPathsPerTask;
+        const std::size_t count = std::min(kOuterPathsPerTask, numOuter - first);
+        std::vector<double> outer(count * (D + 1)), block(numInner * (D + 1)), discounted(numInner);
+        std::vector<double> X(pricer_.numBasis());
+        PathMatrix inner(numInner, D + 1);          // rows reused by every inner set
+        PricingWorkspace ws;
+        process.simulateBlock(S0, dt, outerRng, first, false, count, outer);
+
+        // the rule's value from date k of outer path i, discounted to t = 0
+        Chunk chunk;
+        auto continuation = [&](std::size_t i, int k, double Sk) {
+            const std::size_t rows = D - k + 1;
+            const auto out = std::span<double>(block).first(rows * numInner);
+            const std::uint64_t firstInner = ((first + i) * (D + 1) + k) * numInner;
+            process.simulateBlock(Sk, dt, innerRng, firstInner, false, numInner, out);
+            for (std::size_t row = 0; row < rows; ++row) {
+                std::copy_n(out.data() + row * numInner, numInner, inner.doubleRow(row));
+            }
+            const auto view = PathMatrix::view(numInner, rows, inner.rowStride(), PathPrecision::Double,
+                                               reinterpret_cast<const std::byte*>(inner.doubleRow(0)),
+                                               nullptr);
+            ws.reset();
+            pricer_.applyPolicy(view, coeffs, discounted, {}, ws, k);
+            chunk.innerPaths += numInner;
+            double sum = 0.0;
+            for (double v : discounted) sum += v;
+            return sum / numInner;
+        };
+
+        // Z_k - M_k = (Z_k - L_k) - owed, where L_k is the rule's value
+        // (Z_k when it stops at k, else the continuation Q_k) and owed sums
+        // Z_j - Q_j over the dates j < k where it stopped
+        chunk.gaps.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            double gap = -std::numeric_limits<double>::infinity();
+            double owed = 0.0;
+            for (int k = 1; k < D; ++k) {
+                const double S = outer[k * count + i];
+                const double h = payoff.evaluate(S);
+                if (h <= 0.0) continue;
+                const double Z = std::exp(-lsm.riskFreeRate * k * dt) * h;
+                const double Q = continuation(i, k, S);
+                bool stop = false;
+                if (!coeffs[k].empty()) {
+                    const double x = S * invK;
+                    double fit = 0.0;
+                    pricer_.fillDesign({&x, 1}, X);
+                    OLSRegressor::predict(X, coeffs[k], {&fit, 1});
+                    stop = h > fit;
+                }
+                if (stop) {
+                    gap = std::max(gap, -owed);
+                    owed += Z - Q;
+                } else {
+                    gap = std::max(gap, Z - Q - owed);
+                }
+            }
+            chunk.gaps[i] = std::max(gap, -owed);   // L_D = Z_D
+        }
+        return chunk;
+    };
+
+    const std::size_t numTasks = (numOuter + kOuterPathsPerTask - 1) / kOuterPathsPerTask;
+    std::optional<ThreadPool> localPool;
+    if (!pool) {
+        pool = &localPool.emplace(
+            std::min(resolveThreadCount(lsm.numThreads), static_cast<int>(numTasks)));
+    }
+    const auto chunks = runTasks(*pool, numTasks, job);
+    double sum = 0.0;
+    for (const auto& chunk : chunks) {
+        for (double g : chunk.gaps) sum += g;
+        res.innerPaths += chunk.innerPaths;
+    }
+    const double n = static_cast<double>(numOuter);
+    const double mean = sum / n;
+    double sq = 0.0;
+    for (const auto& chunk : chunks) {
+        for (double g : chunk.gaps) sq += (g - mean) * (g - mean);
+    }
+    const double variance = sq / (n - 1.0);
+
+    res.dualityGap = mean;
+    res.gapStdError = std::sqrt(variance / n);
+    res.upperBound = res.lowerBound + res.dualityGap;
+    res.upperStdError = std::hypot(res.lowerStdError, res.gapStdError);
+    const double z = simd::normalQuantile(0.5 + 0.5 * cfg_.confidenceLevel);
+    res.confidenceLow = res.lowerBound - z * res.lowerStdError;
+    res.confidenceHigh = res.upperBound + z * res.upperStdError;
+    return res;
+}
+
+}
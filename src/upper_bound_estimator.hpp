@@ -0,0 +1,69 @@
+#pragma once
+
+#include "lsm_types.hpp"
+#include <cstdint>
+
+namespace lsm {
+
+class LSMPricer;
+class ThreadPool;
+
+//  UpperBoundConfig  
+// - sizes of the nested simulation behind UpperBoundEstimator
+
+struct UpperBoundConfig {
+    int numOuterPaths = 1000;
+    int numInnerPaths = 500;        // per outer path and in-the-money date
+    std::uint64_t seed = 7;         // outer, inner and lower-bound streams derive from it
+    double confidenceLevel = 0.95;
+};
+
+//  UpperBoundResult  
+// - both bounds on the price under one fitted exercise rule
+
+struct UpperBoundResult {
+    SimulationResult inSample;      // the LSM fit whose rule is tested
+    double lowerBound = 0.0;        // the rule valued on fresh paths
+    double lowerStdError = 0.0;
+    double dualityGap = 0.0;        // upper minus lower bound
+    double gapStdError = 0.0;
+    double upperBound = 0.0;
+    double upperStdError = 0.0;
+    double confidenceLow = 0.0;     // interval for the true price at confidenceLevel
+    double confidenceHigh = 0.0;
+    long long innerPaths = 0;       // simulated in total
+};
+
+//  UpperBoundEstimator  
+// - the Andersen & Broadie (2004) dual bound for the exercise rule an
+//   LSMPricer fits. Along each outer path it builds the martingale from
+//   the rule's own value process, estimated at every in-the-money date by
+//   inner paths started there and run to stopping under the same rule;
+//   out-of-the-money dates need no inner paths, as stopping there is never
+//   optimal. The mean of max_k (Z_k - M_k) over outer paths is the duality
+//   gap: zero for the optimal rule, so its size measures how far the
+//   lower bound can be from the true price.
+//
+//   The lower bound values the rule on cfg.numPaths fresh paths. Outer
+//   paths run in chunks as tasks on a thread pool, their inner sets
+//   through the pricer's block path and basis kernels; every path is
+//   addressed by its indices, so results do not depend on the pool. The
+//   interval is Andersen and Broadie's
+//       [lower - z s_lower, upper + z s_upper].
+
+class UpperBoundEstimator {
+public:
+    // pricer must outlive the estimator
+    explicit UpperBoundEstimator(const LSMPricer& pricer, UpperBoundConfig cfg = {});
+
+    // on pool, or on one of the pricer's cfg.numThreads workers when null
+    UpperBoundResult estimate(double S0, ThreadPool* pool = nullptr) const;
+
+    const UpperBoundConfig& config() const { return cfg_; }
+
+private:
+    const LSMPricer& pricer_;
+    UpperBoundConfig cfg_;
+};
+
+}
@@ -1,6 +1,68 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <new>
+#include <vector>
+
+#include "analytic_prices.hpp"
+#include "basis_functions.hpp"
+#include "convergence_analyzer.hpp"
+#include "device_pricer.hpp"
+#include "exercise_policy.hpp"
+#include "counter_rng.hpp"
+#include "lsm_pricer.hpp"
+#include "mlmc_pricer.hpp"
+#include "multi_asset_pricer.hpp"
+#include "ols_regressor.hpp"
+#include "parallel.hpp"
+#include "path_cache.hpp"
+#include "path_file.hpp"
+#include "payoffs.hpp"
+#include "portfolio_pricer.hpp"
+#include "pricing_scheduler.hpp"
+#include "pricing_server.hpp"
+#include "upper_bound_estimator.hpp"
+#include "pricing_workspace.hpp"
+#include "quasi_random.hpp"
+#include "simd_kernels.hpp"
+#include "static_pricer.hpp"
+#include "stochastic_processes.hpp"
+
+using namespace lsm;
+
+// every heap allocation in the test binary, for the workspace test
+static std::atomic<std::size_t> gAllocations{0};
+
+void* operator new(std::size_t bytes)
+{
+	++gAllocations;
+	if (void* p = std::malloc(bytes ? bytes : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t bytes, std::align_val_t align)
+{
+	++gAllocations;
+	const auto a = static_cast<std::size_t>(align);
+	if (void* p = std::aligned_alloc(a, (bytes + a - 1) / a * a)) return p;
+	throw std::bad_alloc();
+}
+
+// out of line, so GCC does not pair the free() with new at inlined call sites
+[[gnu::noinline]] static void release(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p) noexcept { release(p); }
+void operator delete(void* p, std::size_t) noexcept { release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { release(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+
 TEST_CASE("0 == 0", "[tests]")
 {
 	REQUIRE(0 == 0);
@@ -9,4 +71,1553 @@ TEST_CASE("0 == 0", "[tests]")
 TEST_CASE("1 + 1 == 2", "[tests]")
 {
 	REQUIRE(1 + 1 == 2);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Batch basis evaluation matches per-point evaluate", "[basis]")
+{
+	std::vector<double> xs = {0.0, 0.25, 0.9, 1.0, 1.3, 2.5};
+	std::vector<double> out(xs.size());
+
+	std::vector<std::unique_ptr<BasisFunction>> bases;
+	bases.push_back(std::make_unique<ConstantBasis>());
+	bases.push_back(std::make_unique<MonomialBasis>(0));
+	bases.push_back(std::make_unique<MonomialBasis>(3));
+	for (int n = 0; n < 5; ++n)
+		bases.push_back(std::make_unique<LaguerreBasis>(n));
+
+	for (auto& b : bases) {
+		b->evaluateBatch(xs, out);
+		for (std::size_t i = 0; i < xs.size(); ++i)
+			REQUIRE(out[i] == Approx(b->evaluate(xs[i])));
+	}
+}
+
+TEST_CASE("Weighted Laguerre polynomials match closed forms", "[basis]")
+{
+	double x = 0.7;
+	double w = std::exp(-x / 2);
+	REQUIRE(LaguerreBasis(0).evaluate(x) == Approx(w));
+	REQUIRE(LaguerreBasis(1).evaluate(x) == Approx(w * (1 - x)));
+	REQUIRE(LaguerreBasis(2).evaluate(x) == Approx(w * (1 - 2 * x + x * x / 2)));
+}
+
+TEST_CASE("makeLaguerreSet returns constant plus M terms", "[basis]")
+{
+	auto set = makeLaguerreSet(3);
+	REQUIRE(set.size() == 4);
+	REQUIRE(set[0]->name() == "Const");
+	REQUIRE(set[3]->name() == "Lag2");
+	REQUIRE_THROWS_AS(makeLaguerreSet(-1), std::invalid_argument);
+}
+
+TEST_CASE("Laguerre BasisFamily matches makeLaguerreSet term by term", "[basis]")
+{
+	std::vector<double> xs = {0.1, 0.8, 1.0, 1.7};
+	const int M = 5;
+	BasisFamily fam(BasisFamilyType::Laguerre, M);
+	auto set = makeLaguerreSet(M);
+	REQUIRE(fam.size() == static_cast<int>(set.size()));
+
+	std::vector<double> cols(xs.size() * fam.size());
+	fam.evaluateBatch(xs, cols);
+	for (int j = 0; j < fam.size(); ++j)
+		for (std::size_t i = 0; i < xs.size(); ++i)
+			REQUIRE(cols[j * xs.size() + i] == Approx(set[j]->evaluate(xs[i])));
+}
+
+TEST_CASE("BasisFamily recurrences match closed forms", "[basis]")
+{
+	double x = 0.6;
+	std::vector<double> out(5);
+
+	BasisFamily(BasisFamilyType::Monomial, 4).evaluate(x, out);
+	for (int k = 0; k <= 4; ++k)
+		REQUIRE(out[k] == Approx(std::pow(x, k)));
+
+	BasisFamily(BasisFamilyType::Hermite, 4).evaluate(x, out);
+	REQUIRE(out[2] == Approx(x * x - 1));
+	REQUIRE(out[3] == Approx(x * x * x - 3 * x));
+	REQUIRE(out[4] == Approx(std::pow(x, 4) - 6 * x * x + 3));
+
+	BasisFamily(BasisFamilyType::Chebyshev, 4).evaluate(x, out);
+	for (int k = 0; k <= 4; ++k)
+		REQUIRE(out[k] == Approx(std::cos(k * std::acos(x))));
+}
+
+TEST_CASE("Float basis columns are the double columns rounded once", "[basis]")
+{
+	// more points than one evaluation chunk, and high enough orders that
+	// rounding inside the recurrence would show
+	std::vector<double> x(600);
+	for (std::size_t i = 0; i < x.size(); ++i) x[i] = 0.005 * static_cast<double>(i);
+	for (auto type : {BasisFamilyType::Monomial, BasisFamilyType::Laguerre, BasisFamilyType::Hermite,
+	                  BasisFamilyType::Chebyshev}) {
+		const BasisFamily family(type, 9);
+		std::vector<double> wide(x.size() * family.size());
+		std::vector<float> narrow(wide.size());
+		family.evaluateBatch(x, wide);
+		family.evaluateBatch(x, narrow);
+		for (std::size_t i = 0; i < wide.size(); ++i) REQUIRE(narrow[i] == static_cast<float>(wide[i]));
+	}
+}
+
+static LSMConfig smallConfig(int numThreads = 1)
+{
+	LSMConfig cfg;
+	cfg.numPaths = 4000;
+	cfg.numExerciseDates = 50;
+	cfg.maturity = 1.0;
+	cfg.riskFreeRate = 0.06;
+	cfg.rngSeed = 7;
+	cfg.numThreads = numThreads;
+	return cfg;
+}
+
+static LSMPricer smallPutPricer(const LSMConfig& cfg, double sigma = 0.20)
+{
+	return LSMPricer(cfg,
+	                 std::make_unique<GeometricBrownianMotion>(cfg.riskFreeRate, sigma),
+	                 std::make_unique<PutPayoff>(40.0),
+	                 makeLaguerreSet(3));
+}
+
+TEST_CASE("Philox4x32-10 matches the Random123 known-answer vectors", "[rng]")
+{
+	auto zero = Philox4x32::generate({0, 0, 0, 0}, {0, 0});
+	REQUIRE(zero[0] == 0x6627e8d5u);
+	REQUIRE(zero[3] == 0x9b00dbd8u);
+	auto ones = Philox4x32::generate({~0u, ~0u, ~0u, ~0u}, {~0u, ~0u});
+	REQUIRE(ones[0] == 0x408f276du);
+	REQUIRE(ones[3] == 0x6d5451fdu);
+}
+
+TEST_CASE("Vector math kernels match the standard library", "[simd]")
+{
+	for (double x = -700.0; x <= 700.0; x += 0.737)
+		REQUIRE(std::abs(simd::exp(x) / std::exp(x) - 1.0) < 1e-15);
+	for (double x = 1e-300; x < 1.0; x *= 1.7)
+		REQUIRE(std::abs(simd::log<simd::ScalarPack>(x) - std::log(x)) < 1e-15 * std::max(1.0, std::abs(std::log(x))));
+
+	// Phi(quantile(u)) == u, both central and tail regions
+	for (double u : {1e-300, 1e-20, 1e-9, 0.001, 0.02, 0.075, 0.3, 0.5, 0.8, 0.97, 1.0 - 1e-12}) {
+		const double z = simd::normalQuantile(u);
+		const double phi = 0.5 * std::erfc(-z / std::sqrt(2.0));
+		REQUIRE(phi == Approx(u).epsilon(1e-13));
+		if (u >= 1e-9) REQUIRE(simd::normalQuantile(1.0 - u) == Approx(-z).epsilon(1e-6));
+	}
+}
+
+TEST_CASE("Every SIMD level draws the same bits as the scalar generator", "[simd]")
+{
+	const CounterRNG rng(2024);
+	const std::size_t n = 37;       // not a multiple of any vector width
+	const auto best = simd::supportedSimdLevel();
+	for (auto level : {simd::SimdLevel::Scalar, simd::SimdLevel::AVX2, simd::SimdLevel::AVX512}) {
+		if (static_cast<int>(level) > static_cast<int>(best)) continue;
+		simd::setSimdLevel(level);
+		std::vector<double> z0(n), z1(n), u0(n), u1(n), e(n), q(n);
+		simd::normalBlock(rng, 1000, n, 5, 0, z0.data(), z1.data());
+		simd::uniformBlock(rng, 1000, n, 5, 1, u0.data(), u1.data());
+		simd::scaledExpBlock(z0.data(), 40.0, n, e.data());
+		simd::normalQuantileBlock(u0.data(), n, q.data());
+		for (std::size_t i = 0; i < n; ++i) {
+			const auto z = rng.normalPair(1000 + i, 5, 0);
+			const auto u = rng.uniformPair(1000 + i, 5, 1);
+			REQUIRE(z0[i] == z.first);
+			REQUIRE(z1[i] == z.second);
+			REQUIRE(u0[i] == u.first);
+			REQUIRE(u1[i] == u.second);
+			REQUIRE(e[i] == 40.0 * simd::exp(z.first));
+			REQUIRE(q[i] == simd::normalQuantile(u.first));
+		}
+
+		// whole-block path kernels against one path at a time
+		GeometricBrownianMotion gbm(0.06, 0.2);
+		JumpDiffusionProcess jdp(0.06, 0.2, 2.0);
+		const std::size_t numDates = 26;
+		for (const StochasticProcess* proc : {static_cast<const StochasticProcess*>(&gbm),
+		                                      static_cast<const StochasticProcess*>(&jdp)}) {
+			for (bool antithetic : {false, true}) {
+				std::vector<double> block(n * numDates), path(numDates);
+				proc->simulateBlock(40.0, 0.04, rng, 77, antithetic, n, block);
+				for (std::size_t i = 0; i < n; ++i) {
+					proc->simulatePath(40.0, 0.04, rng, 77 + i, antithetic, path);
+					for (std::size_t k = 0; k < numDates; ++k)
+						REQUIRE(block[k * n + i] == path[k]);
+				}
+			}
+		}
+	}
+	simd::setSimdLevel(best);
+}
+
+TEST_CASE("American put is close to the L&S finite-difference value", "[pricer]")
+{
+	auto res = smallPutPricer(smallConfig()).price(36.0);
+	REQUIRE(std::abs(res.optionValue - 4.478) < 4 * res.standardError + 0.02);
+	REQUIRE(res.earlyExercisePremium > 0.0);
+	REQUIRE(res.europeanValue == Approx(3.844).margin(4 * res.standardError));
+}
+
+TEST_CASE("Pricing is bit-identical for any thread count", "[pricer][threads]")
+{
+	auto serial = smallPutPricer(smallConfig(1)).price(40.0);
+	for (int threads : {2, 3, 8}) {
+		auto par = smallPutPricer(smallConfig(threads)).price(40.0);
+		REQUIRE(par.optionValue == serial.optionValue);
+		REQUIRE(par.standardError == serial.standardError);
+	}
+
+	LSMConfig cfg = smallConfig(1);
+	auto jdSerial = LSMPricer(cfg, std::make_unique<JumpDiffusionProcess>(0.06, 0.2, 0.1),
+	                          std::make_unique<PutPayoff>(40.0), makeLaguerreSet(3)).price(40.0);
+	cfg.numThreads = 5;
+	auto jdPar = LSMPricer(cfg, std::make_unique<JumpDiffusionProcess>(0.06, 0.2, 0.1),
+	                       std::make_unique<PutPayoff>(40.0), makeLaguerreSet(3)).price(40.0);
+	REQUIRE(jdPar.optionValue == jdSerial.optionValue);
+}
+
+TEST_CASE("Antithetic sampling keeps the value and lowers the standard error", "[pricer]")
+{
+	LSMConfig cfg = smallConfig();
+	auto plain = smallPutPricer(cfg).price(40.0);
+	cfg.useAntithetic = true;
+	auto anti = smallPutPricer(cfg).price(40.0);
+	REQUIRE(anti.standardError < plain.standardError);
+	REQUIRE(std::abs(anti.optionValue - plain.optionValue) < 4 * plain.standardError);
+
+	cfg.numPaths = 4001;
+	REQUIRE_THROWS_AS(smallPutPricer(cfg), std::invalid_argument);
+}
+
+TEST_CASE("Blocked normal equations reproduce a single OLS fit", "[ols]")
+{
+	// y = 1 + 2x - 0.5x^2 exactly, split into two blocks of observations
+	std::vector<double> xs = {0.5, 0.8, 1.0, 1.1, 1.4, 1.9, 2.3};
+	std::vector<double> ys;
+	for (double x : xs) ys.push_back(1 + 2 * x - 0.5 * x * x);
+
+	BasisFamily fam(BasisFamilyType::Monomial, 2);
+	auto design = [&](std::size_t lo, std::size_t hi) {
+		std::vector<double> X((hi - lo) * fam.size());
+		fam.evaluateBatch(std::span<const double>(xs.data() + lo, hi - lo), X);
+		return X;
+	};
+
+	NormalEquations a(3), b(3);
+	auto X1 = design(0, 3), X2 = design(3, xs.size());
+	a.accumulate(X1, std::span<const double>(ys.data(), 3));
+	b.accumulate(X2, std::span<const double>(ys.data() + 3, xs.size() - 3));
+	a.add(b);
+	REQUIRE(a.count == xs.size());
+
+	auto blocked = OLSRegressor::solve(a);
+	auto direct = OLSRegressor::fit(design(0, xs.size()), ys, 3);
+	REQUIRE(blocked[0] == Approx(1.0));
+	REQUIRE(blocked[1] == Approx(2.0));
+	REQUIRE(blocked[2] == Approx(-0.5));
+	for (int j = 0; j < 3; ++j)
+		REQUIRE(blocked[j] == Approx(direct[j]));
+}
+
+TEST_CASE("Fixed-size and run-time OLS kernels recover an exact fit", "[ols]")
+{
+	// one fixed-size kernel per m <= kMaxFixedRegressors, the run-time code above
+	for (int m = 1; m <= kMaxFixedRegressors + 3; ++m) {
+		BasisFamily fam(BasisFamilyType::Chebyshev, m - 1);
+		const std::size_t n = 203;
+		std::vector<double> xs(n), ys(n, 0.0), X(n * m), fitted(n);
+		for (std::size_t i = 0; i < n; ++i) xs[i] = -1.0 + 2.0 * i / (n - 1);
+		fam.evaluateBatch(xs, X);
+		for (int j = 0; j < m; ++j)
+			for (std::size_t i = 0; i < n; ++i) ys[i] += (j % 2 ? -1.0 : 1.0) / (j + 1) * X[j * n + i];
+
+		auto beta = OLSRegressor::fit(X, ys, m);
+		OLSRegressor::predict(X, beta, fitted);
+		for (int j = 0; j < m; ++j)
+			REQUIRE(beta[j] == Approx((j % 2 ? -1.0 : 1.0) / (j + 1)).margin(1e-6));
+		for (std::size_t i = 0; i < n; ++i)
+			REQUIRE(fitted[i] == Approx(ys[i]).margin(1e-9));
+	}
+}
+
+TEST_CASE("Collinear regressors fall back to the minimum-norm fit", "[ols]")
+{
+	// columns 1, x, x: y = 1 + 2x splits the x coefficient evenly
+	for (int extra : {0, kMaxFixedRegressors}) {
+		const int m = 3 + extra;
+		const std::size_t n = 9;
+		std::vector<double> X(n * m, 0.0), ys(n);
+		for (std::size_t i = 0; i < n; ++i) {
+			const double x = 0.5 + 0.1 * i;
+			X[i] = 1.0;
+			X[n + i] = x;
+			X[2 * n + i] = x;
+			ys[i] = 1.0 + 2.0 * x;
+		}
+		auto beta = OLSRegressor::fit(X, ys, m);
+		REQUIRE(beta[0] == Approx(1.0));
+		REQUIRE(beta[1] == Approx(1.0));
+		REQUIRE(beta[2] == Approx(1.0));
+		for (int j = 3; j < m; ++j) REQUIRE(beta[j] == 0.0);     // all-zero columns
+	}
+}
+
+TEST_CASE("PathMatrix rows are time-major and 64-byte aligned", "[paths]")
+{
+	for (auto prec : {PathPrecision::Double, PathPrecision::Float}) {
+		PathMatrix m(37, 5, prec);
+		REQUIRE(m.rowStride() >= 37);
+		for (std::size_t k = 0; k < 5; ++k) {
+			const void* row = prec == PathPrecision::Double
+			                      ? static_cast<const void*>(m.doubleRow(k))
+			                      : static_cast<const void*>(m.floatRow(k));
+			REQUIRE(reinterpret_cast<std::uintptr_t>(row) % PathMatrix::kAlignment == 0);
+		}
+
+		// date-major block in, one row per date out
+		std::vector<double> block(5 * 3);
+		for (int k = 0; k < 5; ++k)
+			for (int i = 0; i < 3; ++i)
+				block[k * 3 + i] = 10 * i + k + 0.5;
+		m.storeBlock(30, 3, block.data());
+		std::vector<double> scratch;
+		auto row = m.readDate(4, 30, 33, scratch);
+		REQUIRE(row[0] == 4.5);
+		REQUIRE(row[2] == 24.5);
+		REQUIRE(m.get(1, 31) == 11.5);
+
+		PathMatrix copy = m;
+		REQUIRE(copy.get(3, 32) == 23.5);
+
+		// a view of every second row has twice the stride; its copy is
+		// owned, with the minimal stride, and holds the same spots
+		for (std::size_t k = 0; k < 5; ++k)
+			for (std::size_t p = 0; p < 37; ++p) m.set(k, p, 100.0 * k + p);
+		const auto* rows = prec == PathPrecision::Double ? reinterpret_cast<const std::byte*>(m.doubleRow(0))
+		                                                 : reinterpret_cast<const std::byte*>(m.floatRow(0));
+		const PathMatrix wide = PathMatrix::view(37, 3, 2 * m.rowStride(), prec, rows, nullptr);
+		const PathMatrix owned = wide;
+		REQUIRE(owned.rowStride() == m.rowStride());
+		for (std::size_t k = 0; k < 3; ++k)
+			for (std::size_t p = 0; p < 37; ++p) REQUIRE(owned.get(k, p) == 100.0 * (2 * k) + p);
+	}
+}
+
+TEST_CASE("Float path storage prices within a fraction of an SE", "[paths]")
+{
+	LSMConfig cfg = smallConfig();
+	auto dbl = smallPutPricer(cfg).price(40.0);
+	cfg.pathPrecision = PathPrecision::Float;
+	auto flt = smallPutPricer(cfg).price(40.0);
+	REQUIRE(std::abs(flt.optionValue - dbl.optionValue) < 0.25 * dbl.standardError);
+}
+
+TEST_CASE("A float design matrix accumulates in double and validates on Table 1", "[ols][paths]")
+{
+	// float-held entries widen exactly, so the sums match the double kernels bit for bit
+	for (int m = 1; m <= kMaxFixedRegressors + 3; ++m) {
+		BasisFamily fam(BasisFamilyType::Laguerre, m - 1);
+		const std::size_t n = 203;
+		std::vector<double> xs(n), ys(n), X(n * m), fitted(n), fittedF(n);
+		std::vector<double> XtX(m * m, 0.0), Xty(m, 0.0), XtXf(m * m, 0.0), Xtyf(m, 0.0);
+		std::vector<float> Xf(n * m);
+		for (std::size_t i = 0; i < n; ++i) {
+			xs[i] = 0.5 + 1.5 * i / (n - 1);
+			ys[i] = std::exp(-xs[i]);
+		}
+		fam.evaluateBatch(xs, X);
+		fam.evaluateBatch(xs, Xf);
+		for (std::size_t i = 0; i < X.size(); ++i) {
+			REQUIRE(Xf[i] == Approx(X[i]).epsilon(1e-5).margin(1e-6));
+			X[i] = Xf[i];
+		}
+		OLSRegressor::accumulate(X, ys, XtX, Xty);
+		OLSRegressor::accumulate(std::span<const float>(Xf), ys, XtXf, Xtyf);
+		REQUIRE(XtXf == XtX);
+		REQUIRE(Xtyf == Xty);
+		std::vector<double> beta(m);
+		OLSRegressor::solve(XtX, Xty, beta);
+		OLSRegressor::predict(X, beta, fitted);
+		OLSRegressor::predict(std::span<const float>(Xf), beta, fittedF);
+		REQUIRE(fittedF == fitted);
+	}
+
+	LSMConfig cfg;
+	cfg.numPaths = 10000;
+	cfg.riskFreeRate = 0.06;
+	const auto& table = ConvergenceAnalyzer::longstaffSchwartzTable1();
+	REQUIRE(table.size() == 20);
+	const std::vector<BenchmarkCase> cases = {table[0], table[9], table[18]};
+	const auto checks = ConvergenceAnalyzer::validateMixedPrecision(cfg, cases);
+	REQUIRE(checks.size() == cases.size());
+	for (std::size_t i = 0; i < checks.size(); ++i) {
+		REQUIRE(checks[i].benchmark.S0 == cases[i].S0);
+		REQUIRE(checks[i].standardError > 0.0);
+		REQUIRE(checks[i].passed);
+		REQUIRE(checks[i].doubleValue == Approx(cases[i].reference).margin(4 * checks[i].standardError + 0.05));
+	}
+
+	// deep in the money both runs exercise at once: standard error 0, exact match
+	const auto deep = ConvergenceAnalyzer::validateMixedPrecision(cfg, {{25, 0.20, 1.0, 15.0}});
+	REQUIRE(deep[0].standardError == 0.0);
+	REQUIRE(deep[0].mixedValue == 15.0);
+	REQUIRE(deep[0].deviation == 0.0);
+	REQUIRE(deep[0].passed);
+}
+
+TEST_CASE("Low-memory mode reproduces the stored-grid price exactly", "[pricer][lowmem]")
+{
+	auto run = [](bool lowMemory, bool jumps, bool antithetic, int threads) {
+		LSMConfig cfg = smallConfig(threads);
+		cfg.numExerciseDates = 37;      // checkpoint spacing does not divide D
+		cfg.lowMemory = lowMemory;
+		cfg.useAntithetic = antithetic;
+		std::unique_ptr<StochasticProcess> proc;
+		if (jumps) proc = std::make_unique<JumpDiffusionProcess>(0.06, 0.2, 0.3);
+		else       proc = std::make_unique<GeometricBrownianMotion>(0.06, 0.2);
+		LSMPricer p(cfg, std::move(proc), std::make_unique<PutPayoff>(40.0), makeLaguerreSet(3));
+		return p.priceInAndOutOfSample(40.0, 99);
+	};
+
+	for (bool jumps : {false, true}) {
+		for (bool antithetic : {false, true}) {
+			auto stored = run(false, jumps, antithetic, 1);
+			auto light = run(true, jumps, antithetic, 3);
+			REQUIRE(light.first.optionValue == stored.first.optionValue);
+			REQUIRE(light.first.standardError == stored.first.standardError);
+			REQUIRE(light.first.europeanValue == stored.first.europeanValue);
+			REQUIRE(light.second.optionValue == stored.second.optionValue);
+		}
+	}
+}
+
+TEST_CASE("Batched payoffs and ITM compaction match the per-path definitions", "[pricer][payoff]")
+{
+	const std::vector<double> spots = {0.0, 20.0, 39.999999999999993, 40.0, 40.000000000000007, 55.5, 1e6};
+	std::vector<double> out(spots.size());
+	const PutPayoff put(40.0);
+	const CallPayoff call(40.0);
+	for (const Payoff* payoff : {static_cast<const Payoff*>(&put), static_cast<const Payoff*>(&call)}) {
+		payoff->evaluateBatch(spots, out);
+		for (std::size_t i = 0; i < spots.size(); ++i) REQUIRE(out[i] == payoff->evaluate(spots[i]));
+	}
+	put.evaluateBatch(std::span<const double>(spots).subspan(3, 1), std::span<double>(out).first(1));
+	REQUIRE(out[0] == 0.0);
+
+	// deep in and out of the money the compacted blocks are nearly full or
+	// nearly empty: the stored grid, low-memory mode and the fitted rule
+	// applied to the same paths must still agree
+	for (double S0 : {30.0, 52.0}) {
+		for (int threads : {1, 3}) {
+			LSMConfig cfg = smallConfig(threads);
+			LSMPricer stored(cfg, std::make_unique<GeometricBrownianMotion>(0.06, 0.2), std::make_unique<PutPayoff>(40.0),
+			                 BasisFamily(BasisFamilyType::Laguerre, 3));
+			SimulationResult fitted;
+			const ExercisePolicy policy = stored.fit(S0, &fitted);
+			cfg.lowMemory = true;
+			const auto light = LSMPricer(cfg, std::make_unique<GeometricBrownianMotion>(0.06, 0.2),
+			                             std::make_unique<PutPayoff>(40.0),
+			                             BasisFamily(BasisFamilyType::Laguerre, 3)).price(S0);
+			REQUIRE(light.optionValue == fitted.optionValue);
+			REQUIRE(light.standardError == fitted.standardError);
+			REQUIRE(light.europeanValue == fitted.europeanValue);
+			// the forward pass makes the same decisions but discounts in
+			// another order, so it agrees to rounding
+			const auto applied = stored.applyPolicy(policy, S0, cfg.rngSeed);
+			REQUIRE(applied.optionValue == Approx(fitted.optionValue).epsilon(1e-12));
+		}
+	}
+}
+
+TEST_CASE("Spot ladder matches individual prices from one path set", "[pricer][ladder]")
+{
+	std::vector<double> spots = {36.0, 40.0, 44.0};
+	for (bool jumps : {false, true}) {
+		LSMConfig cfg = smallConfig(2);
+		auto make = [&]() {
+			std::unique_ptr<StochasticProcess> proc;
+			if (jumps) proc = std::make_unique<JumpDiffusionProcess>(0.06, 0.2, 0.2);
+			else       proc = std::make_unique<GeometricBrownianMotion>(0.06, 0.2);
+			return LSMPricer(cfg, std::move(proc), std::make_unique<PutPayoff>(40.0), makeLaguerreSet(3));
+		};
+		auto ladder = make().priceLadder(spots);
+		REQUIRE(ladder.size() == spots.size());
+		for (std::size_t i = 0; i < spots.size(); ++i) {
+			auto single = make().price(spots[i]);
+			REQUIRE(ladder[i].optionValue == single.optionValue);
+			REQUIRE(ladder[i].standardError == single.standardError);
+		}
+	}
+}
+
+TEST_CASE("Greeks from one pass match a binomial-tree American put", "[pricer][greeks]")
+{
+	// 2000-step CRR tree with 50 exercise dates: delta -0.4043, gamma 0.0631, vega 14.75
+	LSMConfig cfg = smallConfig();
+	cfg.computeGreeks = true;
+	auto res = smallPutPricer(cfg).price(40.0);
+	REQUIRE(res.deltaStdError > 0.0);
+	REQUIRE(std::abs(res.delta + 0.4043) < 4 * res.deltaStdError + 0.01);
+	REQUIRE(std::abs(res.gamma - 0.0631) < 4 * res.gammaStdError + 0.005);
+	REQUIRE(std::abs(res.vega - 14.75) < 4 * res.vegaStdError + 0.3);
+
+	cfg.lowMemory = true;
+	auto light = smallPutPricer(cfg).price(40.0);
+	REQUIRE(light.delta == res.delta);
+	REQUIRE(light.gamma == res.gamma);
+
+	// deep in the money the put is exercised at once
+	auto deep = smallPutPricer(cfg).price(20.0);
+	REQUIRE(deep.delta == -1.0);
+	REQUIRE(deep.gamma == 0.0);
+}
+
+TEST_CASE("PathCache shares grids across basis sets and evicts by size", "[cache]")
+{
+	LSMConfig cfg = smallConfig();
+	auto cache = std::make_shared<PathCache>();
+
+	auto priceWith = [&](int M, bool cached) {
+		LSMPricer p(cfg, std::make_unique<GeometricBrownianMotion>(0.06, 0.2),
+		            std::make_unique<PutPayoff>(40.0), makeLaguerreSet(M));
+		if (cached) p.setPathCache(cache);
+		return p.price(40.0);
+	};
+	for (int M = 1; M <= 4; ++M)
+		REQUIRE(priceWith(M, true).optionValue == priceWith(M, false).optionValue);
+	REQUIRE(cache->misses() == 1);
+	REQUIRE(cache->hits() == 3);
+	REQUIRE(cache->size() == 1);
+
+	// a different seed is a different grid
+	cfg.rngSeed = 8;
+	priceWith(3, true);
+	REQUIRE(cache->size() == 2);
+
+	// a budget of one grid keeps only the most recent
+	std::size_t one = cache->bytesUsed() / 2;
+	PathCache small(one);
+	GeometricBrownianMotion gbm(0.06, 0.2);
+	for (std::uint64_t seed : {1, 2, 1}) {
+		small.getOrSimulate(PathCache::makeKey(gbm, cfg, 40.0, seed),
+		                    [&]() { return PathMatrix(cfg.numPaths, cfg.numExerciseDates + 1); });
+	}
+	REQUIRE(small.size() == 1);
+	REQUIRE(small.misses() == 3);
+	REQUIRE(small.bytesUsed() <= one);
+	REQUIRE(PathCache::makeKey(gbm, cfg, 40.0, 1) != PathCache::makeKey(GeometricBrownianMotion(0.06, 0.21), cfg, 40.0, 1));
+}
+
+TEST_CASE("A warm PricingWorkspace prices without heap allocations", "[pricer][workspace]")
+{
+	for (bool lowMemory : {false, true}) {
+		for (bool greeks : {false, true}) {
+			LSMConfig cfg = smallConfig();
+			cfg.lowMemory = lowMemory;
+			cfg.computeGreeks = greeks;
+			cfg.pathPrecision = greeks ? PathPrecision::Float : PathPrecision::Double;
+			cfg.basisPrecision = cfg.pathPrecision;
+			const auto fresh = smallPutPricer(cfg).price(40.0);
+
+			auto pricer = smallPutPricer(cfg);
+			auto ws = std::make_shared<PricingWorkspace>(cfg, pricer.numBasis());
+			pricer.setWorkspace(ws);
+			const auto warm = pricer.price(40.0);
+			ws->reset();        // folds any spill (low-memory path state) into one chunk
+
+			const std::size_t before = gAllocations;
+			const auto again = pricer.price(40.0);
+			const std::size_t allocations = gAllocations - before;
+			REQUIRE(allocations == 0);
+			REQUIRE(warm.optionValue == fresh.optionValue);
+			REQUIRE(again.optionValue == fresh.optionValue);
+			REQUIRE(again.standardError == fresh.standardError);
+			REQUIRE(again.delta == fresh.delta);
+			if (!lowMemory) REQUIRE(ws->highWater() <= PricingWorkspace::requiredBytes(cfg, pricer.numBasis()));
+		}
+	}
+
+	// a shared workspace serves the other entry points unchanged
+	LSMConfig cfg = smallConfig(3);
+	auto pricer = smallPutPricer(cfg);
+	const auto plain = pricer.priceInAndOutOfSample(40.0, 11);
+	pricer.setWorkspace(std::make_shared<PricingWorkspace>());
+	const auto reused = pricer.priceInAndOutOfSample(40.0, 11);
+	REQUIRE(reused.first.optionValue == plain.first.optionValue);
+	REQUIRE(reused.second.optionValue == plain.second.optionValue);
+	REQUIRE(pricer.priceLadder({40.0})[0].optionValue == plain.first.optionValue);
+}
+
+TEST_CASE("Scrambled Sobol points stay stratified and the bridge has Brownian covariance", "[qmc]")
+{
+	// every 1-D projection of the first 2^10 points fills each of 2^10 cells once
+	const int dims = 64;
+	const std::size_t n = 1024;
+	SobolSequence sobol(dims);
+	std::vector<double> u(dims * n);
+	for (int scrambled : {0, 1}) {
+		if (scrambled) sobol.scramble(CounterRNG(5), 3);
+		sobol.uniforms(0, n, u);
+		for (int d = 0; d < dims; ++d) {
+			std::vector<int> cells(n, 0);
+			for (std::size_t i = 0; i < n; ++i) ++cells[static_cast<std::size_t>(u[d * n + i] * n)];
+			REQUIRE(std::count(cells.begin(), cells.end(), 1) == static_cast<long>(n));
+		}
+	}
+
+	// blocks start anywhere: points 100 .. 131 match the full run
+	std::vector<double> part(dims * 32), expected;
+	sobol.uniforms(100, 32, part);
+	for (int d = 0; d < dims; ++d)
+		expected.insert(expected.end(), u.begin() + d * n + 100, u.begin() + d * n + 132);
+	REQUIRE(part == expected);
+
+	// unit normals in, so sum_j W_k(e_j) W_l(e_j) = min(t_k, t_l)
+	const std::size_t D = 13;
+	const double dt = 0.1;
+	BrownianBridge bridge(D, dt);
+	std::vector<double> z(D * D, 0.0), W(D * D);
+	for (std::size_t j = 0; j < D; ++j) z[j * D + j] = 1.0;
+	bridge.transform(z, D, W);
+	for (std::size_t k = 0; k < D; ++k)
+		for (std::size_t l = 0; l < D; ++l) {
+			double cov = 0.0;
+			for (std::size_t i = 0; i < D; ++i) cov += W[k * D + i] * W[l * D + i];
+			REQUIRE(cov == Approx(dt * (std::min(k, l) + 1)).margin(1e-12));
+		}
+}
+
+TEST_CASE("Sobol sampling cuts the standard error at the same path count", "[pricer][qmc]")
+{
+	LSMConfig cfg = smallConfig();
+	cfg.numPaths = 8192;
+	const auto mc = smallPutPricer(cfg).price(40.0);
+
+	cfg.samplingScheme = SamplingScheme::Sobol;
+	cfg.qmcReplicates = 8;
+	const auto qmc = smallPutPricer(cfg).price(40.0);
+	REQUIRE(qmc.standardError > 0.0);
+	REQUIRE(qmc.standardError < 0.5 * mc.standardError);
+	REQUIRE(std::abs(qmc.optionValue - mc.optionValue) < 3 * mc.standardError);
+	REQUIRE(std::abs(qmc.optionValue - 2.314) < 4 * qmc.standardError + 0.01);
+
+	// still independent of the thread count, and the ladder matches
+	cfg.numThreads = 3;
+	const auto par = smallPutPricer(cfg).price(40.0);
+	REQUIRE(par.optionValue == qmc.optionValue);
+	REQUIRE(par.standardError == qmc.standardError);
+	REQUIRE(smallPutPricer(cfg).priceLadder({40.0})[0].optionValue == qmc.optionValue);
+
+	LSMConfig bad = cfg;
+	bad.qmcReplicates = 3;
+	REQUIRE_THROWS_AS(smallPutPricer(bad), std::invalid_argument);
+	bad = cfg;
+	bad.useAntithetic = true;
+	REQUIRE_THROWS_AS(smallPutPricer(bad), std::invalid_argument);
+	LSMPricer jumps(cfg, std::make_unique<JumpDiffusionProcess>(0.06, 0.2, 0.3),
+	                std::make_unique<PutPayoff>(40.0), makeLaguerreSet(3));
+	REQUIRE_THROWS_AS(jumps.price(40.0), std::logic_error);
+}
+
+// |S - K|: no closed form in analytic_prices
+class StraddlePayoff : public Payoff {
+public:
+	explicit StraddlePayoff(double K) : K_(K) {}
+	double evaluate(double spot) const { return std::abs(spot - K_); }
+	double strike() const { return K_; }
+	std::string name() const { return "Straddle"; }
+
+private:
+	double K_;
+};
+
+TEST_CASE("Closed-form European prices satisfy parity and nest Black-Scholes", "[analytic]")
+{
+	const double S = 36.0, K = 40.0, r = 0.06, sigma = 0.2, T = 1.0;
+	const double put = blackScholesPrice(OptionType::Put, S, K, r, sigma, T);
+	const double call = blackScholesPrice(OptionType::Call, S, K, r, sigma, T);
+	REQUIRE(put == Approx(3.844).margin(1e-3));
+	REQUIRE(call - put == Approx(S - K * std::exp(-r * T)).margin(1e-12));
+
+	// no jumps is Black-Scholes; parity holds with jumps as well
+	REQUIRE(mertonJumpDiffusionPrice(OptionType::Put, S, K, r, sigma, 0.0, -0.1, 0.15, T) ==
+	        Approx(put).epsilon(1e-14));
+	const double jput = mertonJumpDiffusionPrice(OptionType::Put, S, K, r, sigma, 0.5, -0.1, 0.15, T);
+	const double jcall = mertonJumpDiffusionPrice(OptionType::Call, S, K, r, sigma, 0.5, -0.1, 0.15, T);
+	REQUIRE(jput > put);
+	REQUIRE(jcall - jput == Approx(S - K * std::exp(-r * T)).margin(1e-10));
+
+	REQUIRE(!europeanClosedForm(GeometricBrownianMotion(r, sigma), StraddlePayoff(K), S, T, r));
+}
+
+TEST_CASE("The European control variate cuts the standard error", "[pricer][control]")
+{
+	LSMConfig cfg = smallConfig();
+	cfg.numPaths = 20000;
+	const auto mc = smallPutPricer(cfg).price(40.0);
+	cfg.useControlVariate = true;
+	const auto cv = smallPutPricer(cfg).price(40.0);
+	// the American payoff tracks the European one best out of the money
+	REQUIRE(cv.standardError < 0.75 * mc.standardError);
+	REQUIRE(std::abs(cv.optionValue - 2.314) < 3 * cv.standardError + 0.02);
+	REQUIRE(cv.europeanValue == Approx(blackScholesPrice(OptionType::Put, 40.0, 40.0, 0.06, 0.2, 1.0)));
+	REQUIRE(cv.controlCoefficient > 0.0);
+	REQUIRE(cv.earlyExercisePremium == Approx(cv.optionValue - cv.europeanValue));
+
+	// antithetic pairs and thread counts go through the same estimator
+	cfg.useAntithetic = true;
+	const auto anti = smallPutPricer(cfg).price(40.0);
+	cfg.numThreads = 3;
+	REQUIRE(smallPutPricer(cfg).price(40.0).optionValue == anti.optionValue);
+
+	// jump diffusion: the built-in Merton price equals a supplied one
+	cfg = smallConfig();
+	cfg.useControlVariate = true;
+	auto jumps = [&] {
+		return LSMPricer(cfg, std::make_unique<JumpDiffusionProcess>(0.06, 0.2, 0.5, -0.1, 0.15),
+		                 std::make_unique<PutPayoff>(40.0), makeLaguerreSet(3));
+	};
+	const auto builtIn = jumps().price(36.0);
+	auto supplied = jumps();
+	supplied.setControlVariate([](double S0) {
+		return mertonJumpDiffusionPrice(OptionType::Put, S0, 40.0, 0.06, 0.2, 0.5, -0.1, 0.15, 1.0);
+	});
+	REQUIRE(supplied.price(36.0).optionValue == Approx(builtIn.optionValue).epsilon(1e-12));
+
+	// no closed form and none supplied
+	LSMPricer straddle(cfg, std::make_unique<GeometricBrownianMotion>(0.06, 0.2),
+	                   std::make_unique<StraddlePayoff>(40.0), makeLaguerreSet(3));
+	REQUIRE_THROWS_AS(straddle.price(36.0), std::logic_error);
+}
+
+TEST_CASE("PortfolioPricer prices every contract from one simulation", "[portfolio]")
+{
+	LSMConfig cfg = smallConfig();
+	cfg.useAntithetic = true;
+	PortfolioPricer book(cfg, std::make_unique<GeometricBrownianMotion>(0.06, 0.2),
+	                     BasisFamily(BasisFamilyType::Laguerre, 3));
+	struct Trade { double K, T; bool call; };
+	const std::vector<Trade> trades = {{36, 0.5, false}, {40, 1.0, false}, {44, 0.5, false}, {40, 0.2, true}};
+	for (const auto& t : trades) {
+		if (t.call) book.addContract(std::make_unique<CallPayoff>(t.K), t.T);
+		else book.addContract(std::make_unique<PutPayoff>(t.K), t.T);
+	}
+	REQUIRE(book.size() == trades.size());
+
+	// the longest contract matches its standalone pricer exactly, shorter
+	// ones (on the first dates of the same paths) within the error
+	const auto results = book.price(40.0);
+	REQUIRE(results.size() == trades.size());
+	for (std::size_t i = 0; i < trades.size(); ++i) {
+		LSMConfig own = cfg;
+		own.maturity = trades[i].T;
+		own.numExerciseDates = static_cast<int>(std::lround(trades[i].T * 50));
+		std::unique_ptr<Payoff> payoff;
+		if (trades[i].call) payoff = std::make_unique<CallPayoff>(trades[i].K);
+		else payoff = std::make_unique<PutPayoff>(trades[i].K);
+		LSMPricer alone(own, std::make_unique<GeometricBrownianMotion>(0.06, 0.2), std::move(payoff),
+		                BasisFamily(BasisFamilyType::Laguerre, 3));
+		const auto expected = alone.price(40.0);
+		if (trades[i].T == 1.0) {
+			REQUIRE(results[i].optionValue == expected.optionValue);
+			REQUIRE(results[i].standardError == expected.standardError);
+		} else {
+			REQUIRE(std::abs(results[i].optionValue - expected.optionValue) <
+			        4 * (results[i].standardError + expected.standardError));
+		}
+	}
+
+	// low-memory mode regenerates the same horizon paths per contract
+	cfg.lowMemory = true;
+	PortfolioPricer lean(cfg, std::make_unique<GeometricBrownianMotion>(0.06, 0.2),
+	                     BasisFamily(BasisFamilyType::Laguerre, 3));
+	for (const auto& t : trades) {
+		if (t.call) lean.addContract(std::make_unique<CallPayoff>(t.K), t.T);
+		else lean.addContract(std::make_unique<PutPayoff>(t.K), t.T);
+	}
+	const auto leanResults = lean.price(40.0);
+	for (std::size_t i = 0; i < trades.size(); ++i)
+		REQUIRE(leanResults[i].optionValue == results[i].optionValue);
+
+	REQUIRE_THROWS_AS(book.addContract(std::make_unique<PutPayoff>(40.0), 0.51), std::invalid_argument);
+	REQUIRE_THROWS_AS(book.addContract(std::make_unique<PutPayoff>(40.0), 0.0), std::invalid_argument);
+}
+
+TEST_CASE("ThreadPool runs every task and hands back values and errors", "[parallel]")
+{
+	ThreadPool pool(3);
+	REQUIRE(pool.size() == 3);
+	std::vector<std::future<int>> squares;
+	for (int i = 0; i < 50; ++i) squares.push_back(pool.submit([i] { return i * i; }));
+	for (int i = 0; i < 50; ++i) REQUIRE(squares[i].get() == i * i);
+	auto failing = pool.submit([]() -> int { throw std::runtime_error("task"); });
+	REQUIRE_THROWS_AS(failing.get(), std::runtime_error);
+}
+
+TEST_CASE("Concurrent diagnostics match serial ones and the adaptive run stops on target", "[convergence]")
+{
+	LSMConfig cfg = smallConfig();
+	cfg.numPaths = 2000;
+	const auto serialRows = ConvergenceAnalyzer::analyzeByBasisFunctions(cfg, 40.0, 40.0, 0.2, 4);
+	const auto serialTrials = ConvergenceAnalyzer::outOfSampleTest(cfg, 40.0, 40.0, 0.2, 3);
+	ThreadPool pool(3);
+	REQUIRE(ConvergenceAnalyzer::analyzeByBasisFunctions(cfg, 40.0, 40.0, 0.2, 4, &pool) == serialRows);
+	const auto trials = ConvergenceAnalyzer::outOfSampleTest(cfg, 40.0, 40.0, 0.2, 3, &pool);
+	REQUIRE(trials.size() == 3);
+	for (std::size_t t = 0; t < trials.size(); ++t) {
+		REQUIRE(trials[t].first.optionValue == serialTrials[t].first.optionValue);
+		REQUIRE(trials[t].second.optionValue == serialTrials[t].second.optionValue);
+	}
+	cfg.numThreads = 3;
+	const auto byN = ConvergenceAnalyzer::analyzeByPathCount(cfg, 40.0, 40.0, 0.2, {500, 1000, 2000});
+	REQUIRE(std::get<1>(byN[2]) == std::get<1>(serialRows[2]));
+
+	// each batch of 2000 has an SE near 0.035: a 0.015 target needs ~6
+	cfg.numThreads = 1;
+	const auto run = ConvergenceAnalyzer::analyzeAdaptive(cfg, 40.0, 40.0, 0.2, 0.015, 60.0);
+	REQUIRE(run.converged);
+	REQUIRE(run.checkpoints.size() >= 3);
+	REQUIRE(run.checkpoints.back().standardError <= 0.015);
+	REQUIRE(run.checkpoints[run.checkpoints.size() - 2].standardError > 0.015);
+	REQUIRE(run.checkpoints.back().numPaths == 2000LL * static_cast<long long>(run.checkpoints.size()));
+	REQUIRE(std::abs(run.checkpoints.back().value - 2.314) < 4 * 0.015 + 0.02);
+
+	// the batch cap (or budget) ends a run whose target is out of reach
+	const auto capped = ConvergenceAnalyzer::analyzeAdaptive(cfg, 40.0, 40.0, 0.2, 1e-6, 60.0, 2);
+	REQUIRE(!capped.converged);
+	REQUIRE(capped.checkpoints.size() == 2);
+	REQUIRE(ConvergenceAnalyzer::analyzeAdaptive(cfg, 40.0, 40.0, 0.2, 1e-6, 0.0).checkpoints.size() == 1);
+}
+
+TEST_CASE("A mapped PathFile feeds backward induction without resimulating", "[paths][file]")
+{
+	const std::string file = (std::filesystem::temp_directory_path() / "lsm_test_paths.bin").string();
+	for (auto precision : {PathPrecision::Double, PathPrecision::Float}) {
+		LSMConfig cfg = smallConfig();
+		cfg.numPaths = 1001;        // rows padded to whole cache lines
+		cfg.useAntithetic = false;
+		cfg.pathPrecision = precision;
+		const GeometricBrownianMotion gbm(cfg.riskFreeRate, 0.20);
+		const auto simulated = smallPutPricer(cfg).simulatePaths(36.0, cfg.rngSeed);
+		PathFile::write(file, simulated, gbm, cfg, 36.0, cfg.rngSeed);
+
+		PathFile mapped(file);
+		REQUIRE(mapped.header().version == PathFile::kVersion);
+		REQUIRE(mapped.header().spot == 36.0);
+		REQUIRE(mapped.processKey() == gbm.cacheKey());
+		REQUIRE(mapped.cacheKey() == PathCache::makeKey(gbm, cfg, 36.0, cfg.rngSeed));
+		const auto grid = mapped.paths();
+		REQUIRE(grid->numPaths() == 1001);
+		REQUIRE(grid->precision() == precision);
+		REQUIRE(grid->get(50, 1000) == simulated.get(50, 1000));
+
+		// the pricer finds the pinned grid and never simulates
+		auto cache = std::make_shared<PathCache>(1);
+		mapped.addTo(*cache);
+		auto pricer = smallPutPricer(cfg);
+		pricer.setPathCache(cache);
+		const auto res = pricer.price(36.0);
+		REQUIRE(cache->hits() == 1);
+		REQUIRE(cache->misses() == 0);
+		REQUIRE(cache->bytesUsed() == 0);
+		REQUIRE(res.optionValue == smallPutPricer(cfg).price(36.0).optionValue);
+	}
+
+	// another format version, or a header whose grid is not the one its
+	// config describes, is refused
+	auto patch = [&](std::size_t offset, const auto& value) {
+		std::fstream f(file, std::ios::in | std::ios::out | std::ios::binary);
+		f.seekp(static_cast<std::streamoff>(offset));
+		f.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	};
+	const PathFileHeader good = PathFile(file).header();
+	patch(offsetof(PathFileHeader, numExerciseDates), static_cast<std::int32_t>(good.numDates));
+	REQUIRE_THROWS_AS(PathFile(file), std::runtime_error);
+	patch(offsetof(PathFileHeader, numExerciseDates), good.numExerciseDates);
+	patch(offsetof(PathFileHeader, numPaths), std::uint64_t(1) << 40);
+	REQUIRE_THROWS_AS(PathFile(file), std::runtime_error);
+	patch(offsetof(PathFileHeader, numPaths), good.numPaths);
+	REQUIRE(PathFile(file).header().numPaths == good.numPaths);
+	// a key length that would wrap the offset check, an unknown sampling scheme
+	patch(offsetof(PathFileHeader, processKeyBytes), ~std::uint64_t(0) - 8);
+	REQUIRE_THROWS_AS(PathFile(file), std::runtime_error);
+	patch(offsetof(PathFileHeader, processKeyBytes), good.processKeyBytes);
+	patch(offsetof(PathFileHeader, samplingScheme), std::uint32_t(7));
+	REQUIRE_THROWS_AS(PathFile(file), std::runtime_error);
+	patch(offsetof(PathFileHeader, samplingScheme), good.samplingScheme);
+	REQUIRE(PathFile(file).processKey() == GeometricBrownianMotion(0.06, 0.20).cacheKey());
+	patch(offsetof(PathFileHeader, version), PathFile::kVersion + 1);
+	REQUIRE_THROWS_AS(PathFile(file), std::runtime_error);
+	std::filesystem::remove(file);
+	REQUIRE_THROWS_AS(PathFile(file), std::runtime_error);
+}
+
+TEST_CASE("A PricingProfile accounts for every stage without moving the price", "[pricer][profile]")
+{
+	LSMConfig cfg = smallConfig();
+	const auto plain = smallPutPricer(cfg).price(36.0);
+	REQUIRE(!plain.profile);
+
+	cfg.profile = true;
+	const auto res = smallPutPricer(cfg).price(36.0);
+	REQUIRE(res.optionValue == plain.optionValue);
+#if LSM_PROFILING
+	REQUIRE(res.profile);
+	const PricingProfile& prof = *res.profile;
+	REQUIRE(prof.itmPaths.size() == 51);
+	REQUIRE(prof.itmPaths[50] > 0);
+	REQUIRE(prof.itmPaths[0] == 0);
+	REQUIRE(prof.regressions == 49);
+	REQUIRE(prof.conditionNumbers[0] == 0.0);
+	for (int k = 1; k < 50; ++k) REQUIRE(prof.conditionNumbers[k] >= 1.0);
+	double stages = 0.0;
+	for (double s : prof.stageSeconds) {
+		REQUIRE(s > 0.0);
+		stages += s;
+	}
+	REQUIRE(stages <= prof.totalSeconds * 1.01);
+	REQUIRE(prof.workspaceBytes > 0);
+	REQUIRE(prof.heapAllocations >= 2);       // the arena chunk and the grid
+
+	// a warm attached workspace allocates nothing more
+	auto pricer = smallPutPricer(cfg);
+	pricer.setWorkspace(std::make_shared<PricingWorkspace>());
+	pricer.price(36.0);
+	REQUIRE(pricer.price(36.0).profile->heapAllocations == 0);
+
+	const std::string json = prof.toJson();
+	REQUIRE(json.front() == '{');
+	REQUIRE(json.back() == '}');
+	REQUIRE(json.find("\"regressions\":49") != std::string::npos);
+	REQUIRE(json.find("\"stageSeconds\":{\"simulation\":") != std::string::npos);
+
+	// out-of-sample valuation is profiled too
+	const auto split = smallPutPricer(cfg).priceInAndOutOfSample(36.0, 99);
+	REQUIRE(split.second.profile);
+	REQUIRE(split.second.profile->regressions == 0);
+	REQUIRE(split.second.profile->itmPaths[50] > 0);
+#endif
+
+	// singular and well-conditioned systems
+	REQUIRE(OLSRegressor::conditionNumber(std::vector<double>{4, 0, 0, 9}) == Approx(1.0));
+	REQUIRE(std::isinf(OLSRegressor::conditionNumber(std::vector<double>{1, 1, 1, 1})));
+}
+
+TEST_CASE("The Andersen-Broadie interval brackets a Bermudan tree price", "[pricer][upper]")
+{
+	// CRR tree for the 10-date Bermudan put, exercise only on those dates
+	const int D = 10, perDate = 200, steps = D * perDate;
+	const double S0 = 36.0, K = 40.0, r = 0.06, sigma = 0.20, T = 1.0;
+	const double h = T / steps, u = std::exp(sigma * std::sqrt(h)), q = (std::exp(r * h) - 1 / u) / (u - 1 / u);
+	std::vector<double> v(steps + 1);
+	for (int j = 0; j <= steps; ++j) v[j] = std::max(K - S0 * std::pow(u, 2 * j - steps), 0.0);
+	for (int n = steps - 1; n >= 0; --n) {
+		for (int j = 0; j <= n; ++j) {
+			v[j] = std::exp(-r * h) * (q * v[j + 1] + (1 - q) * v[j]);
+			if (n % perDate == 0 && n > 0) v[j] = std::max(v[j], K - S0 * std::pow(u, 2 * j - n));
+		}
+	}
+	const double tree = v[0];
+
+	LSMConfig cfg = smallConfig();
+	cfg.numPaths = 10000;
+	cfg.numExerciseDates = D;
+	auto pricer = smallPutPricer(cfg);
+	UpperBoundConfig ub;
+	ub.numOuterPaths = 200;
+	ub.numInnerPaths = 200;
+	ThreadPool one(1), three(3);
+	const auto res = UpperBoundEstimator(pricer, ub).estimate(S0, &one);
+	REQUIRE(res.dualityGap >= 0.0);
+	REQUIRE(res.gapStdError > 0.0);
+	REQUIRE(res.upperBound == res.lowerBound + res.dualityGap);
+	REQUIRE(res.confidenceLow <= tree);
+	REQUIRE(tree <= res.confidenceHigh);
+	REQUIRE(res.dualityGap < 0.1);
+	REQUIRE(res.innerPaths > 0);
+	REQUIRE(res.innerPaths % ub.numInnerPaths == 0);
+
+	// every path is addressed by index: the pool does not matter
+	const auto again = UpperBoundEstimator(pricer, ub).estimate(S0, &three);
+	REQUIRE(again.dualityGap == res.dualityGap);
+	REQUIRE(again.gapStdError == res.gapStdError);
+	REQUIRE(again.lowerBound == res.lowerBound);
+
+	ub.numInnerPaths = 0;
+	REQUIRE_THROWS_AS(UpperBoundEstimator(pricer, ub), std::invalid_argument);
+}
+
+TEST_CASE("An ExercisePolicy round-trips through disk and values fresh paths alone", "[policy]")
+{
+	LSMConfig cfg = smallConfig();
+	LSMPricer pricer(cfg, std::make_unique<GeometricBrownianMotion>(0.06, 0.2), std::make_unique<PutPayoff>(40.0),
+	                 BasisFamily(BasisFamilyType::Laguerre, 3));
+	SimulationResult inSample;
+	const ExercisePolicy policy = pricer.fit(40.0, &inSample);
+	const auto [fitted, outOfSample] = pricer.priceInAndOutOfSample(40.0, 99);
+	REQUIRE(inSample.optionValue == fitted.optionValue);
+	REQUIRE(policy.numExerciseDates() == cfg.numExerciseDates);
+	REQUIRE(policy.scale() == 1.0 / 40.0);
+	REQUIRE(policy.coefficients()[0].empty());
+	REQUIRE(policy.coefficients()[cfg.numExerciseDates - 1].size() == 4);
+	REQUIRE(std::isnan(policy.continuationValue(0, 40.0)));
+	REQUIRE(policy.continuationValue(25, 36.0) > 0.0);
+
+	// the forward pass is priceInAndOutOfSample's out-of-sample half
+	const auto applied = pricer.applyPolicy(policy, 40.0, 99);
+	REQUIRE(applied.optionValue == outOfSample.optionValue);
+	REQUIRE(applied.standardError == outOfSample.standardError);
+
+	const auto dir = std::filesystem::temp_directory_path();
+	for (const char* name : {"lsm_test_policy.bin", "lsm_test_policy.json"}) {
+		const std::string file = (dir / name).string();
+		policy.save(file);
+		const auto loaded = ExercisePolicy::load(file);
+		REQUIRE(loaded == policy);
+		REQUIRE(pricer.applyPolicy(loaded, 40.0, 99).optionValue == applied.optionValue);
+		std::filesystem::remove(file);
+	}
+	REQUIRE(ExercisePolicy::fromJson(policy.toJson()) == policy);
+	const auto binarySize = [&] {
+		const std::string file = (dir / "lsm_test_policy.bin").string();
+		policy.save(file);
+		const auto size = std::filesystem::file_size(file);
+		std::filesystem::remove(file);
+		return size;
+	}();
+	REQUIRE(binarySize < policy.toJson().size());
+
+	// rules only apply where they were fitted
+	LSMConfig other = cfg;
+	other.numExerciseDates = 25;
+	LSMPricer coarse(other, std::make_unique<GeometricBrownianMotion>(0.06, 0.2), std::make_unique<PutPayoff>(40.0),
+	                 BasisFamily(BasisFamilyType::Laguerre, 3));
+	LSMPricer hermite(cfg, std::make_unique<GeometricBrownianMotion>(0.06, 0.2), std::make_unique<PutPayoff>(40.0),
+	                  BasisFamily(BasisFamilyType::Hermite, 3));
+	LSMPricer strike(cfg, std::make_unique<GeometricBrownianMotion>(0.06, 0.2), std::make_unique<PutPayoff>(42.0),
+	                 BasisFamily(BasisFamilyType::Laguerre, 3));
+	REQUIRE_THROWS_AS(coarse.applyPolicy(policy, 40.0, 99), std::invalid_argument);
+	REQUIRE_THROWS_AS(hermite.applyPolicy(policy, 40.0, 99), std::invalid_argument);
+	REQUIRE_THROWS_AS(strike.applyPolicy(policy, 40.0, 99), std::invalid_argument);
+	REQUIRE_THROWS_AS(smallPutPricer(cfg).fit(40.0), std::logic_error);
+	REQUIRE_THROWS_AS(ExercisePolicy::fromJson("{\"version\":1,\"basis\":\"Laguerre\""), std::runtime_error);
+	REQUIRE_THROWS_AS(ExercisePolicy::load((dir / "lsm_test_no_such_policy.bin").string()), std::runtime_error);
+}
+
+TEST_CASE("CorrelatedGBM factors its correlation and simulates it exactly", "[multiasset]")
+{
+	const std::vector<double> rho = {1.0, 0.6, 0.3, 0.6, 1.0, -0.2, 0.3, -0.2, 1.0};
+	const CorrelatedGBM gbm(0.05, {0.2, 0.3, 0.25}, rho, {0.1, 0.0, 0.02});
+	const auto& L = gbm.choleskyFactor();
+	for (int a = 0; a < 3; ++a) {
+		for (int b = 0; b < 3; ++b) {
+			double s = 0.0;
+			for (int j = 0; j < 3; ++j) s += L[a * 3 + j] * L[b * 3 + j];
+			REQUIRE(s == Approx(rho[a * 3 + b]).margin(1e-14));
+		}
+	}
+
+	// one step of 20000 paths: log-returns carry rho, discounted spots are
+	// martingales, and a path does not depend on the block it is simulated in
+	const std::size_t n = 20000;
+	const std::vector<double> S0 = {100.0, 50.0, 80.0};
+	const double T = 0.5;
+	const CounterRNG rng(11);
+	std::vector<double> block(2 * 3 * n);
+	gbm.simulateBlock(S0, T, rng, 0, false, n, block);
+	std::vector<double> r(3 * n);
+	for (int a = 0; a < 3; ++a) {
+		REQUIRE(block[a * n] == S0[a]);
+		double mean = 0.0;
+		for (std::size_t i = 0; i < n; ++i) {
+			r[a * n + i] = std::log(block[(3 + a) * n + i] / S0[a]);
+			mean += block[(3 + a) * n + i];
+		}
+		mean /= n;
+		const double q = gbm.dividendYields()[a];
+		REQUIRE(mean * std::exp(-(0.05 - q) * T) == Approx(S0[a]).epsilon(0.01));
+	}
+	auto corr = [&](int a, int b) {
+		double ma = 0.0, mb = 0.0, sab = 0.0, saa = 0.0, sbb = 0.0;
+		for (std::size_t i = 0; i < n; ++i) {
+			ma += r[a * n + i];
+			mb += r[b * n + i];
+		}
+		ma /= n;
+		mb /= n;
+		for (std::size_t i = 0; i < n; ++i) {
+			sab += (r[a * n + i] - ma) * (r[b * n + i] - mb);
+			saa += (r[a * n + i] - ma) * (r[a * n + i] - ma);
+			sbb += (r[b * n + i] - mb) * (r[b * n + i] - mb);
+		}
+		return sab / std::sqrt(saa * sbb);
+	};
+	REQUIRE(corr(0, 1) == Approx(0.6).margin(0.02));
+	REQUIRE(corr(0, 2) == Approx(0.3).margin(0.02));
+	REQUIRE(corr(1, 2) == Approx(-0.2).margin(0.02));
+
+	std::vector<double> part(4 * 3 * 5);
+	gbm.simulateBlock(S0, T / 3, rng, 97, true, 5, part);
+	std::vector<double> whole(4 * 3 * 130);
+	gbm.simulateBlock(S0, T / 3, rng, 0, true, 130, whole);
+	for (int row = 0; row < 4 * 3; ++row)
+		for (int i = 0; i < 5; ++i) REQUIRE(part[row * 5 + i] == whole[row * 130 + 97 + i]);
+
+	REQUIRE_THROWS_AS(CorrelatedGBM(0.05, {0.2, 0.2}, {1.0, 1.2, 1.2, 1.0}), std::invalid_argument);
+	REQUIRE_THROWS_AS(CorrelatedGBM(0.05, {0.2, 0.2, 0.2}, CorrelatedGBM::uniformCorrelation(3, -0.6)),
+	                  std::invalid_argument);
+}
+
+TEST_CASE("MultivariateBasis builds tensor and total-degree products of a family", "[multiasset][basis]")
+{
+	const BasisFamily laguerre(BasisFamilyType::Laguerre, 3);
+	REQUIRE(MultivariateBasis(laguerre, 2, MultiIndexSet::TensorProduct).size() == 16);
+	REQUIRE(MultivariateBasis(laguerre, 2).size() == 10);
+	REQUIRE(MultivariateBasis(BasisFamily(BasisFamilyType::Laguerre, 2), 5).size() == 21);
+	REQUIRE(MultivariateBasis(laguerre, 5).size() == 56);
+
+	const MultivariateBasis basis(laguerre, 3);
+	const std::vector<double> x = {0.9, 1.1, 1.3};
+	std::vector<double> out(basis.size()), u(3 * laguerre.size());
+	basis.evaluate(x, out);
+	for (int a = 0; a < 3; ++a) laguerre.evaluate(x[a], std::span<double>(u).subspan(a * laguerre.size(), laguerre.size()));
+	REQUIRE(out[0] == 1.0);
+	for (int j = 0; j < basis.size(); ++j) {
+		double expected = 1.0;
+		int degree = 0;
+		for (int a = 0; a < 3; ++a) {
+			const int alpha = basis.indices()[j * 3 + a];
+			expected *= u[a * laguerre.size() + alpha];
+			degree += alpha;
+		}
+		REQUIRE(degree <= 3);
+		REQUIRE(out[j] == Approx(expected).epsilon(1e-14));
+	}
+
+	// total degree lists the tensor product's low-degree columns in its order
+	const std::vector<int> tensor = MultivariateBasis(laguerre, 3, MultiIndexSet::TensorProduct).indices();
+	std::vector<int> filtered;
+	for (std::size_t j = 0; j < tensor.size(); j += 3) {
+		if (tensor[j] + tensor[j + 1] + tensor[j + 2] <= 3) filtered.insert(filtered.end(), &tensor[j], &tensor[j] + 3);
+	}
+	REQUIRE(basis.indices() == filtered);
+
+	// many assets: built from the C(M + d, d) columns alone
+	const MultivariateBasis wide(BasisFamily(BasisFamilyType::Laguerre, 2), 20);
+	REQUIRE(wide.size() == 231);
+	REQUIRE(MultivariateBasis(laguerre, 16).size() == 969);
+	REQUIRE_THROWS_AS(MultivariateBasis(laguerre, 40), std::invalid_argument);
+}
+
+TEST_CASE("MultiAssetLSMPricer prices max-calls and baskets thread-independently", "[multiasset][pricer]")
+{
+	// Broadie & Glasserman's 2-asset max-call: 13.90 at S0 = 100
+	LSMConfig cfg;
+	cfg.numPaths = 20000;
+	cfg.numExerciseDates = 9;
+	cfg.maturity = 3.0;
+	cfg.riskFreeRate = 0.05;
+	cfg.rngSeed = 7;
+	auto maxCall = [&](const LSMConfig& c, int d) {
+		return MultiAssetLSMPricer(c, std::make_unique<CorrelatedGBM>(0.05, std::vector<double>(d, 0.2),
+		                                                              CorrelatedGBM::uniformCorrelation(d, 0.0),
+		                                                              std::vector<double>(d, 0.1)),
+		                           std::make_unique<MaxCallPayoff>(d, 100.0),
+		                           MultivariateBasis(BasisFamily(BasisFamilyType::Laguerre, 3), d));
+	};
+	const std::vector<double> S0 = {100.0, 100.0};
+	const auto serial = maxCall(cfg, 2).price(S0);
+	REQUIRE(std::abs(serial.optionValue - 13.90) < 4 * serial.standardError + 0.05);
+	REQUIRE(serial.earlyExercisePremium > 0.0);
+	for (int threads : {2, 3}) {
+		LSMConfig par = cfg;
+		par.numThreads = threads;
+		const auto res = maxCall(par, 2).price(S0);
+		REQUIRE(res.optionValue == serial.optionValue);
+		REQUIRE(res.standardError == serial.standardError);
+	}
+	LSMConfig floatPaths = cfg;
+	floatPaths.pathPrecision = PathPrecision::Float;
+	REQUIRE(maxCall(floatPaths, 2).price(S0).optionValue == Approx(serial.optionValue).margin(serial.standardError));
+
+	// a one-asset basket put is the American put of Longstaff & Schwartz
+	LSMConfig put = smallConfig();
+	put.numPaths = 20000;
+	put.useAntithetic = true;
+	MultiAssetLSMPricer basket(put, std::make_unique<CorrelatedGBM>(0.06, std::vector<double>{0.2},
+	                                                                std::vector<double>{1.0}),
+	                           std::make_unique<BasketPutPayoff>(std::vector<double>{1.0}, 40.0),
+	                           MultivariateBasis(BasisFamily(BasisFamilyType::Laguerre, 3), 1));
+	const auto res = basket.price(std::vector<double>{36.0});
+	REQUIRE(std::abs(res.optionValue - 4.478) < 4 * res.standardError + 0.02);
+
+	REQUIRE_THROWS_AS(maxCall(cfg, 2).price(std::vector<double>{100.0}), std::invalid_argument);
+	LSMConfig greeks = cfg;
+	greeks.computeGreeks = true;
+	REQUIRE_THROWS_AS(maxCall(greeks, 2), std::logic_error);
+	REQUIRE_THROWS_AS(MultiAssetLSMPricer(cfg, std::make_unique<CorrelatedGBM>(0.05, std::vector<double>(2, 0.2),
+	                                                                           CorrelatedGBM::uniformCorrelation(2, 0.0)),
+	                                      std::make_unique<MaxCallPayoff>(3, 100.0),
+	                                      MultivariateBasis(BasisFamily(BasisFamilyType::Laguerre, 3), 2)),
+	                  std::invalid_argument);
+	REQUIRE_THROWS_AS(MaxCallPayoff(2, 0.0), std::invalid_argument);
+	REQUIRE_THROWS_AS(BasketPutPayoff(std::vector<double>{0.5, 0.5}, -1.0), std::invalid_argument);
+	REQUIRE_THROWS_AS(BasketPutPayoff(std::vector<double>{0.5, std::nan("")}, 40.0), std::invalid_argument);
+}
+
+TEST_CASE("WorkStealingPool covers every index once, nested loops included", "[threads][scheduler]")
+{
+	WorkStealingPool pool(3);
+	std::vector<int> hits(1000, 0);
+	pool.parallelFor(hits.size(), [&](std::size_t lo, std::size_t hi) {
+		for (std::size_t i = lo; i < hi; ++i) ++hits[i];
+	});
+	REQUIRE(std::all_of(hits.begin(), hits.end(), [](int h) { return h == 1; }));
+
+	// parallelFor on a worker goes through the pool whatever numThreads says
+	std::vector<std::future<long>> sums;
+	for (int t = 0; t < 8; ++t) {
+		sums.push_back(pool.submit([t]() -> long {
+			if (WorkStealingPool::current() == nullptr) return -1;
+			std::vector<long> v(5000);
+			parallelFor(v.size(), 64, [&](std::size_t lo, std::size_t hi) {
+				for (std::size_t i = lo; i < hi; ++i) v[i] = static_cast<long>(i) * t;
+			});
+			long s = 0;
+			for (long x : v) s += x;
+			return s;
+		}));
+	}
+	for (int t = 0; t < 8; ++t) REQUIRE(sums[t].get() == 4999L * 5000L / 2 * t);
+	REQUIRE(WorkStealingPool::current() == nullptr);
+
+	REQUIRE_THROWS_AS(pool.parallelFor(10, [](std::size_t lo, std::size_t) {
+		if (lo == 7) throw std::runtime_error("piece 7");
+	}, 1), std::runtime_error);
+}
+
+TEST_CASE("PricingScheduler matches serial pricing in submission order", "[scheduler][pricer]")
+{
+	const std::shared_ptr<const StochasticProcess> processes[] = {
+		std::make_shared<const GeometricBrownianMotion>(0.06, 0.2),
+		std::make_shared<const GeometricBrownianMotion>(0.06, 0.4)};
+	const auto& process = processes[0];
+	std::vector<PricingTask> tasks;
+	std::vector<SimulationResult> serial;
+	for (int i = 0; i < 12; ++i) {
+		LSMConfig cfg = smallConfig();
+		cfg.numPaths = i % 4 == 0 ? 20000 : 1000 + 500 * i;     // a few large tasks among small ones
+		cfg.numExerciseDates = 10 + 5 * (i % 3);
+		cfg.rngSeed = 100 + i;
+		cfg.useAntithetic = i % 2 == 1;
+		const double sigma = i % 3 == 2 ? 0.4 : 0.2, K = 38.0 + i, S0 = 40.0;
+		LSMPricer pricer(cfg, std::make_unique<GeometricBrownianMotion>(0.06, sigma), std::make_unique<PutPayoff>(K),
+		                 BasisFamily(BasisFamilyType::Laguerre, 3));
+		serial.push_back(pricer.price(S0));
+		tasks.push_back({cfg, processes[i % 3 == 2], std::make_unique<PutPayoff>(K),
+		                 BasisFamily(BasisFamilyType::Laguerre, 3), S0});
+	}
+
+	PricingScheduler scheduler(3);
+	REQUIRE(scheduler.numThreads() == 3);
+	const auto results = scheduler.run(std::move(tasks));
+	REQUIRE(results.size() == serial.size());
+	for (std::size_t i = 0; i < results.size(); ++i) {
+		REQUIRE(results[i].optionValue == serial[i].optionValue);
+		REQUIRE(results[i].standardError == serial[i].standardError);
+		REQUIRE(results[i].europeanValue == serial[i].europeanValue);
+	}
+	REQUIRE(scheduler.run({}).empty());
+
+	std::vector<PricingTask> bad;
+	LSMConfig broken = smallConfig();
+	broken.numPaths = 0;
+	bad.push_back({smallConfig(), process, std::make_unique<PutPayoff>(40.0), BasisFamily(BasisFamilyType::Laguerre, 3), 40.0});
+	bad.push_back({broken, process, std::make_unique<PutPayoff>(40.0), BasisFamily(BasisFamilyType::Laguerre, 3), 40.0});
+	REQUIRE_THROWS_AS(scheduler.run(std::move(bad)), std::invalid_argument);
+}
+
+TEST_CASE("DeviceLSMPricer matches LSMPricer on the host target", "[device][pricer]")
+{
+	LSMConfig cfg = smallConfig();
+	cfg.numPaths = 20000;
+	cfg.numExerciseDates = 25;
+	cfg.useAntithetic = true;
+	const BasisFamily basis(BasisFamilyType::Laguerre, 3);
+
+	// a jump-diffusion sees LSMPricer's own paths, so only the summation
+	// order of the normal equations differs
+	const JumpDiffusionProcess jd(0.06, 0.2, 0.5, -0.1, 0.15);
+	const PutPayoff put(40.0);
+	const auto cpu = LSMPricer(cfg, std::make_unique<JumpDiffusionProcess>(0.06, 0.2, 0.5, -0.1, 0.15),
+	                           std::make_unique<PutPayoff>(40.0), basis).price(36.0);
+	const DeviceLSMPricer host(cfg, jd, put, basis, DeviceTarget::Host);
+	const auto dev = host.price(36.0);
+	REQUIRE(dev.optionValue == Approx(cpu.optionValue).epsilon(1e-6));
+	REQUIRE(dev.europeanValue == Approx(cpu.europeanValue).epsilon(1e-12));
+	REQUIRE(dev.standardError == Approx(cpu.standardError).epsilon(1e-3));
+	REQUIRE(dev.earlyExercisePremium == Approx(dev.optionValue - dev.europeanValue));
+
+	// thread count does not change the block-ordered sums
+	LSMConfig threaded = cfg;
+	threaded.numThreads = 4;
+	REQUIRE(DeviceLSMPricer(threaded, jd, put, basis, DeviceTarget::Host).price(36.0).optionValue == dev.optionValue);
+
+	// GBM paths are stepped forward rather than bridged: equal in law
+	const GeometricBrownianMotion gbm(0.06, 0.2);
+	const auto gbmCpu = LSMPricer(cfg, std::make_unique<GeometricBrownianMotion>(0.06, 0.2),
+	                              std::make_unique<PutPayoff>(40.0), basis).price(36.0);
+	const auto gbmDev = DeviceLSMPricer(cfg, gbm, put, basis, DeviceTarget::Host).price(36.0);
+	REQUIRE(std::abs(gbmDev.optionValue - gbmCpu.optionValue) <
+	        4.0 * std::hypot(gbmDev.standardError, gbmCpu.standardError));
+	REQUIRE(gbmDev.optionValue == Approx(4.478).margin(0.05));
+
+	const auto call = DeviceLSMPricer(cfg, gbm, CallPayoff(40.0), basis, DeviceTarget::Host).price(36.0);
+	REQUIRE(call.earlyExercisePremium == Approx(0.0).margin(3.0 * call.standardError));
+
+	LSMConfig unsupported = cfg;
+	unsupported.lowMemory = true;
+	REQUIRE_THROWS_AS(DeviceLSMPricer(unsupported, gbm, put, basis, DeviceTarget::Host), std::logic_error);
+	REQUIRE_THROWS_AS(DeviceLSMPricer(cfg, gbm, put, BasisFamily(BasisFamilyType::Monomial, 9), DeviceTarget::Host),
+	                  std::invalid_argument);
+	if (!DeviceLSMPricer::cudaAvailable()) {
+		REQUIRE(DeviceLSMPricer::defaultTarget() == DeviceTarget::Host);
+		REQUIRE_THROWS_AS(DeviceLSMPricer(cfg, gbm, put, basis, DeviceTarget::Cuda), std::logic_error);
+	}
+}
+
+TEST_CASE("priceExtrapolated prices nested grids from one path set", "[pricer][richardson]")
+{
+	LSMConfig cfg = smallConfig();
+	cfg.numPaths = 20000;
+	cfg.numExerciseDates = 10;
+	cfg.useAntithetic = true;
+	auto make = [](const LSMConfig& c) {
+		return LSMPricer(c, std::make_unique<GeometricBrownianMotion>(0.06, 0.2), std::make_unique<PutPayoff>(40.0),
+		                 BasisFamily(BasisFamilyType::Laguerre, 3));
+	};
+	const auto res = make(cfg).priceExtrapolated(36.0, 3);
+	REQUIRE(res.numExerciseDates == std::vector<int>{10, 20, 40});
+	REQUIRE(res.grids.size() == 3);
+
+	// the finest grid is the standalone 40-date pricing on the same paths
+	LSMConfig finest = cfg;
+	finest.numExerciseDates = 40;
+	const auto direct = make(finest).price(36.0);
+	REQUIRE(res.grids[2].optionValue == direct.optionValue);
+	REQUIRE(res.grids[2].standardError == direct.standardError);
+
+	// more exercise dates are worth more, and the limit lies beyond them,
+	// near the finite-difference American price 4.487
+	REQUIRE(res.grids[0].optionValue < res.grids[1].optionValue);
+	REQUIRE(res.grids[1].optionValue < res.grids[2].optionValue);
+	REQUIRE(res.americanValue > res.grids[2].optionValue);
+	REQUIRE(res.americanValue == Approx(4.487).margin(4.0 * res.totalError + 0.02));
+	REQUIRE(res.standardError > 0.0);
+	REQUIRE(res.totalError == Approx(std::hypot(res.standardError, res.discretisationError)));
+
+	// two grids: 2 V(20) - V(10), the paths' shared noise mostly cancelling
+	const auto two = make(cfg).priceExtrapolated(36.0, 2);
+	REQUIRE(two.americanValue == Approx(2.0 * two.grids[1].optionValue - two.grids[0].optionValue).epsilon(1e-12));
+	REQUIRE(two.standardError < 2.0 * two.grids[1].standardError);
+
+	REQUIRE_THROWS_AS(make(cfg).priceExtrapolated(36.0, 1), std::invalid_argument);
+	LSMConfig lowMemory = cfg;
+	lowMemory.lowMemory = true;
+	REQUIRE_THROWS_AS(make(lowMemory).priceExtrapolated(36.0), std::logic_error);
+}
+
+TEST_CASE("MLMCPricer telescopes date-grid levels reproducibly", "[pricer][mlmc]")
+{
+	LSMConfig cfg = smallConfig();
+	cfg.numPaths = 20000;
+	cfg.numExerciseDates = 8;
+	cfg.useAntithetic = true;
+	MLMCConfig mlmc;
+	mlmc.targetRMSE = 0.03;
+	mlmc.minLevels = 2;
+	mlmc.maxLevels = 4;
+	auto make = [&](const LSMConfig& c, const MLMCConfig& m) {
+		return MLMCPricer(c, std::make_unique<GeometricBrownianMotion>(0.06, 0.2), std::make_unique<PutPayoff>(40.0),
+		                  BasisFamily(BasisFamilyType::Laguerre, 3), m);
+	};
+	cfg.numThreads = 1;
+	const auto res = make(cfg, mlmc).price(36.0);
+	REQUIRE(res.levels.size() >= 2);
+	REQUIRE(res.levels.size() <= 4);
+	double sum = 0.0;
+	for (std::size_t l = 0; l < res.levels.size(); ++l) {
+		REQUIRE(res.levels[l].numExerciseDates == 8 << l);
+		REQUIRE(res.levels[l].samples >= mlmc.initialSamples);
+		sum += res.levels[l].mean;
+	}
+	REQUIRE(res.optionValue == Approx(sum).epsilon(1e-12));
+	REQUIRE(res.rmse == Approx(std::hypot(res.standardError, res.biasEstimate)));
+	REQUIRE(res.standardError <= mlmc.targetRMSE);
+	// near the finite-difference American price 4.487
+	REQUIRE(res.optionValue == Approx(4.487).margin(4.0 * res.rmse));
+
+	// the corrections are small and vary less than the coarse level
+	REQUIRE(std::abs(res.levels[1].mean) < 0.2);
+	REQUIRE(res.levels[1].variance < res.levels[0].variance);
+
+	// batches are fixed, so the thread count changes nothing
+	cfg.numThreads = 4;
+	const auto threaded = make(cfg, mlmc).price(36.0);
+	REQUIRE(threaded.optionValue == res.optionValue);
+	REQUIRE(threaded.standardError == res.standardError);
+	REQUIRE(threaded.levels.size() == res.levels.size());
+
+	MLMCConfig bad = mlmc;
+	bad.maxLevels = 1;
+	REQUIRE_THROWS_AS(make(cfg, bad), std::invalid_argument);
+	LSMConfig lowMemory = cfg;
+	lowMemory.lowMemory = true;
+	REQUIRE_THROWS_AS(make(lowMemory, mlmc), std::logic_error);
+
+	// deep in the money the put is worth its intrinsic value at t = 0, as
+	// LSMPricer says, never less
+	cfg.numThreads = 1;
+	const auto deep = make(cfg, mlmc).price(25.0);
+	REQUIRE(deep.optionValue == 15.0);
+	REQUIRE(deep.standardError == 0.0);
+	REQUIRE(deep.optionValue == LSMPricer(cfg, std::make_unique<GeometricBrownianMotion>(0.06, 0.2),
+	                                      std::make_unique<PutPayoff>(40.0),
+	                                      BasisFamily(BasisFamilyType::Laguerre, 3)).price(25.0).optionValue);
+}
+
+TEST_CASE("StaticLSMPricer agrees with LSMPricer on the same paths", "[pricer][static]")
+{
+	LSMConfig cfg = smallConfig();
+	cfg.numPaths = 5000;
+	cfg.numExerciseDates = 20;
+	auto same = [](const SimulationResult& a, const SimulationResult& b) {
+		REQUIRE(a.optionValue == b.optionValue);
+		REQUIRE(a.standardError == b.standardError);
+		REQUIRE(a.europeanValue == b.europeanValue);
+	};
+	// the vector exp of the Laguerre weight may flip a marginal exercise
+	// decision; the paths, and so the European value, are the same
+	auto close = [](const SimulationResult& a, const SimulationResult& b) {
+		REQUIRE(std::abs(a.optionValue - b.optionValue) <= 0.1 * b.standardError);
+		REQUIRE(a.standardError == Approx(b.standardError).epsilon(0.05));
+		REQUIRE(a.europeanValue == b.europeanValue);
+	};
+	const GeometricBrownianMotion gbm(0.06, 0.2);
+	const JumpDiffusionProcess jd(0.06, 0.2, 0.1);
+	for (bool antithetic : {false, true}) {
+		SimulationResult serial;
+		for (int threads : {1, 4}) {
+			cfg.useAntithetic = antithetic;
+			cfg.numThreads = threads;
+			const auto reference = LSMPricer(cfg, std::make_unique<GeometricBrownianMotion>(gbm),
+			                                 std::make_unique<PutPayoff>(40.0),
+			                                 BasisFamily(BasisFamilyType::Laguerre, 3)).price(36.0);
+			const auto fast = StaticLSMPricer<GeometricBrownianMotion, PutPayoff, BasisFamilyType::Laguerre, 3>(
+			    cfg, gbm, PutPayoff(40.0)).price(36.0);
+			close(fast, reference);
+			// still the same bits for any thread count
+			if (threads == 1) serial = fast;
+			else same(fast, serial);
+		}
+	}
+
+	// the call, float path storage and the factory
+	cfg.pathPrecision = PathPrecision::Float;
+	const auto call = LSMPricer(cfg, std::make_unique<GeometricBrownianMotion>(gbm), std::make_unique<CallPayoff>(40.0),
+	                            BasisFamily(BasisFamilyType::Laguerre, 3)).price(44.0);
+	close(StaticLSMPricer<GeometricBrownianMotion, CallPayoff, BasisFamilyType::Laguerre, 3>(cfg, gbm, CallPayoff(40.0))
+	         .price(44.0), call);
+	const auto fast = makeSpecialisedPricer(cfg, std::make_unique<GeometricBrownianMotion>(gbm),
+	                                        std::make_unique<CallPayoff>(40.0), BasisFamily(BasisFamilyType::Laguerre, 3));
+	close(fast(44.0), call);
+	REQUIRE(hasSpecialisedPricer(cfg, gbm, CallPayoff(40.0), BasisFamily(BasisFamilyType::Laguerre, 3)));
+
+	// a warm workspace gives the same result again
+	cfg.pathPrecision = PathPrecision::Double;
+	StaticLSMPricer<GeometricBrownianMotion, PutPayoff, BasisFamilyType::Laguerre, 3> warm(cfg, gbm, PutPayoff(40.0));
+	warm.setWorkspace(std::make_shared<PricingWorkspace>());
+	const auto first = warm.price(40.0);
+	same(warm.price(40.0), first);
+
+	// anything else falls back to LSMPricer
+	REQUIRE_FALSE(hasSpecialisedPricer(cfg, gbm, PutPayoff(40.0), BasisFamily(BasisFamilyType::Hermite, 3)));
+	REQUIRE_FALSE(hasSpecialisedPricer(cfg, jd, PutPayoff(40.0), BasisFamily(BasisFamilyType::Laguerre, 3)));
+	REQUIRE_FALSE(hasSpecialisedPricer(cfg, gbm, PutPayoff(40.0), BasisFamily(BasisFamilyType::Laguerre, 4)));
+	const auto jdFallback = makeSpecialisedPricer(cfg, std::make_unique<JumpDiffusionProcess>(jd),
+	                                              std::make_unique<CallPayoff>(40.0),
+	                                              BasisFamily(BasisFamilyType::Monomial, 2));
+	same(jdFallback(44.0), LSMPricer(cfg, std::make_unique<JumpDiffusionProcess>(jd), std::make_unique<CallPayoff>(40.0),
+	                                 BasisFamily(BasisFamilyType::Monomial, 2)).price(44.0));
+	LSMConfig greeks = cfg;
+	greeks.computeGreeks = true;
+	REQUIRE_FALSE(hasSpecialisedPricer(greeks, gbm, PutPayoff(40.0), BasisFamily(BasisFamilyType::Laguerre, 3)));
+	const auto fallback = makeSpecialisedPricer(cfg, std::make_unique<GeometricBrownianMotion>(gbm),
+	                                            std::make_unique<PutPayoff>(40.0),
+	                                            BasisFamily(BasisFamilyType::Hermite, 3));
+	same(fallback(36.0), LSMPricer(cfg, std::make_unique<GeometricBrownianMotion>(gbm), std::make_unique<PutPayoff>(40.0),
+	                               BasisFamily(BasisFamilyType::Hermite, 3)).price(36.0));
+	using Static = StaticLSMPricer<GeometricBrownianMotion, PutPayoff, BasisFamilyType::Laguerre, 3>;
+	REQUIRE_THROWS_AS(Static(greeks, gbm, PutPayoff(40.0)), std::logic_error);
+}
+
+TEST_CASE("PricingServer answers line requests in order from shared grids", "[server]")
+{
+	const std::string common = " K=40 r=0.06 sigma=0.2 T=1 paths=4000 dates=20 seed=7";
+	std::istringstream in("# warm-up\n"
+	                      "id=a S=36" + common + "\n"
+	                      "\n"
+	                      "id=b S=40" + common + "\n"
+	                      "id=c S=36" + common + " type=call\n"
+	                      "id=d S=0" + common + "\n"
+	                      "stats\n");
+	std::ostringstream out;
+	ServerConfig scfg;
+	scfg.numThreads = 2;
+	scfg.batchWindowMillis = 50.0;
+	PricingServer server(scfg);
+	const ServerStats stats = server.serve(in, out);
+
+	std::vector<std::string> lines;
+	std::istringstream reply(out.str());
+	for (std::string line; std::getline(reply, line);) lines.push_back(line);
+	REQUIRE(lines.size() == 5);
+
+	// each value round-trips to what a standalone pricer gives
+	LSMConfig cfg;
+	cfg.numPaths = 4000;
+	cfg.numExerciseDates = 20;
+	cfg.rngSeed = 7;
+	auto value = [](const std::string& line) {
+		const auto at = line.find(" value=") + 7;
+		return std::stod(line.substr(at, line.find(' ', at) - at));
+	};
+	auto reference = [&](double S0, bool call) {
+		std::unique_ptr<Payoff> payoff = call ? std::unique_ptr<Payoff>(std::make_unique<CallPayoff>(40.0))
+		                                      : std::make_unique<PutPayoff>(40.0);
+		return LSMPricer(cfg, std::make_unique<GeometricBrownianMotion>(0.06, 0.2), std::move(payoff),
+		                 BasisFamily(BasisFamilyType::Laguerre, 3)).price(S0).optionValue;
+	};
+	REQUIRE(lines[0].rfind("id=a value=", 0) == 0);
+	REQUIRE(value(lines[0]) == reference(36.0, false));
+	REQUIRE(lines[1].rfind("id=b value=", 0) == 0);
+	REQUIRE(value(lines[1]) == reference(40.0, false));
+	REQUIRE(lines[2].rfind("id=c value=", 0) == 0);
+	REQUIRE(value(lines[2]) == reference(36.0, true));
+	REQUIRE(lines[3].rfind("id=d error=", 0) == 0);
+	REQUIRE(lines[4].rfind("stats quotes=", 0) == 0);
+
+	// the put and the call read one unit-spot grid
+	REQUIRE(stats.quotes == 3);
+	REQUIRE(stats.errors == 1);
+	REQUIRE(stats.simulations == 1);
+	REQUIRE(stats.batches >= 1);
+	REQUIRE(stats.p99Micros >= stats.p50Micros);
+
+	REQUIRE_THROWS_AS(QuoteRequest::parse("id=x S=36 colour=blue"), std::invalid_argument);
+	REQUIRE_THROWS_AS(QuoteRequest::parse("id=x K=40"), std::invalid_argument);
+	REQUIRE_THROWS_AS(QuoteRequest::parse("id=x S=36 paths=many"), std::invalid_argument);
+	scfg.maxBatch = 0;
+	REQUIRE_THROWS_AS(PricingServer(scfg), std::invalid_argument);
+}